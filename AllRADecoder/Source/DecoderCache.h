@@ -0,0 +1,339 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+/**
+ Keeps designed decoders, so they don't have to be calculated again when a session is loaded.
+ A design is the decoder matrix together with the alphas of the energy and rE images and the
+ triangulation of the layout, and is looked up by a hash of everything it depends on: the
+ loudspeaker positions, imaginary flags, gains and channels, their order within the list (the
+ rows of the matrix follow it), the order, the weights and the image size.
+
+ The design of the current decoder is stored within the plug-in state, so sessions open
+ instantly, without calculating the convex hull of the layout either. Optionally, all designs
+ are also written to a cache directory shared by all instances, which only keeps the most
+ recently used ones.
+ */
+class DecoderCache
+{
+public:
+    struct Design
+    {
+        int numRows = 0, numColumns = 0;
+        std::vector<float> matrix; // row-major
+        std::vector<float> energyAlphas, rEAlphas;
+
+        juce::String layoutKey; // the triangles only depend on the loudspeakers
+        std::vector<Tri> triangles;
+    };
+
+    DecoderCache()
+    {
+        directory = juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                        .getChildFile ("IEM").getChildFile ("AllRADecoder").getChildFile ("DecoderCache");
+    }
+
+    static juce::String createKey (const std::vector<R3>& points, const int order, const int weights, const int imageWidth, const int imageHeight)
+    {
+        juce::MemoryOutputStream out;
+        out.writeInt (formatVersion);
+        out.writeInt (order);
+        out.writeInt (weights);
+        out.writeInt (imageWidth);
+        out.writeInt (imageHeight);
+        writePoints (out, points);
+
+        return juce::String::toHexString (static_cast<juce::int64> (calculateHash (out.getMemoryBlock())));
+    }
+
+    static juce::String createLayoutKey (const std::vector<R3>& points)
+    {
+        juce::MemoryOutputStream out;
+        out.writeInt (formatVersion);
+        writePoints (out, points);
+
+        return juce::String::toHexString (static_cast<juce::int64> (calculateHash (out.getMemoryBlock())));
+    }
+
+    void setUseCacheDirectory (const bool shouldUseCacheDirectory) { useDirectory = shouldUseCacheDirectory; }
+
+    /** Looks for a design in the plug-in state and in the cache directory. Don't call this from the audio thread. */
+    bool find (const juce::String& key, Design& design)
+    {
+        {
+            const juce::ScopedLock lock (stateLock);
+            if (key == stateKey && read (stateData, design))
+                return true;
+        }
+
+        if (! useDirectory)
+            return false;
+
+        const auto file = directory.getChildFile (key + fileExtension);
+        juce::MemoryBlock data;
+        if (! file.existsAsFile() || ! file.loadFileAsData (data) || ! read (data, design))
+            return false;
+
+        file.setLastModificationTime (juce::Time::getCurrentTime()); // keeps it from being pruned
+
+        const juce::ScopedLock lock (stateLock);
+        stateKey = key;
+        stateData = std::move (data);
+        return true;
+    }
+
+    /**
+     Looks for the triangulation of the layout in the design of the plug-in state, so a session
+     can be restored without calculating the convex hull. Don't call this from the audio thread.
+     */
+    bool findTriangulation (const std::vector<R3>& points, std::vector<Tri>& triangles)
+    {
+        Design design;
+        {
+            const juce::ScopedLock lock (stateLock);
+            if (! read (stateData, design))
+                return false;
+        }
+
+        if (design.triangles.empty() || design.layoutKey != createLayoutKey (points))
+            return false;
+
+        const int nPoints = static_cast<int> (points.size());
+        for (const auto& tri : design.triangles)
+            if (! juce::isPositiveAndBelow (tri.a, nPoints) || ! juce::isPositiveAndBelow (tri.b, nPoints) || ! juce::isPositiveAndBelow (tri.c, nPoints))
+                return false;
+
+        triangles = std::move (design.triangles);
+        return true;
+    }
+
+    /** Stores a design as the one of the plug-in state and in the cache directory. Don't call this from the audio thread. */
+    void store (const juce::String& key, const Design& design)
+    {
+        auto data = write (design);
+
+        if (useDirectory && directory.createDirectory().wasOk())
+        {
+            if (writeToFile (directory.getChildFile (key + fileExtension), data))
+                pruneDirectory();
+            else
+                DBG ("DecoderCache: could not write cache file for " << key);
+        }
+
+        const juce::ScopedLock lock (stateLock);
+        stateKey = key;
+        stateData = std::move (data);
+    }
+
+    /** Returns the design of the current decoder as child tree for the plug-in state. */
+    juce::ValueTree getState() const
+    {
+        juce::ValueTree state {juce::Identifier (stateType)};
+
+        const juce::ScopedLock lock (stateLock);
+        if (stateKey.isNotEmpty())
+        {
+            state.setProperty ("Key", stateKey, nullptr);
+            state.setProperty ("Data", stateData.toBase64Encoding(), nullptr);
+        }
+        return state;
+    }
+
+    void setState (const juce::ValueTree& state)
+    {
+        juce::MemoryBlock data;
+        const bool valid = state.hasType (juce::Identifier (stateType)) && data.fromBase64Encoding (state.getProperty ("Data").toString());
+
+        const juce::ScopedLock lock (stateLock);
+        stateKey = valid ? state.getProperty ("Key").toString() : juce::String();
+        stateData = std::move (data);
+    }
+
+    static constexpr const char* stateType = "DecoderCache";
+
+private:
+    static void writePoints (juce::OutputStream& out, const std::vector<R3>& points)
+    {
+        out.writeInt (static_cast<int> (points.size()));
+
+        for (const auto& point : points)
+        {
+            out.writeFloat (point.x);
+            out.writeFloat (point.y);
+            out.writeFloat (point.z);
+            out.writeBool (point.isImaginary);
+            out.writeFloat (point.gain);
+            out.writeInt (point.channel);
+            out.writeInt (point.lspNum);
+            out.writeInt (point.realLspNum);
+        }
+    }
+
+    static juce::MemoryBlock write (const Design& design)
+    {
+        juce::MemoryOutputStream block;
+        {
+            juce::GZIPCompressorOutputStream out (block);
+            out.writeInt (formatMagic);
+            out.writeInt (design.numRows);
+            out.writeInt (design.numColumns);
+            for (const float value : design.matrix)
+                out.writeFloat (value);
+
+            // the alphas end up in 8 bit pixels anyway
+            const int numPixels = static_cast<int> (design.energyAlphas.size());
+            std::vector<juce::uint8> alphas (2 * numPixels);
+            for (int i = 0; i < numPixels; ++i)
+            {
+                alphas[i] = static_cast<juce::uint8> (juce::roundToInt (juce::jlimit (0.0f, 1.0f, design.energyAlphas[i]) * 255.0f));
+                alphas[numPixels + i] = static_cast<juce::uint8> (juce::roundToInt (juce::jlimit (0.0f, 1.0f, design.rEAlphas[i]) * 255.0f));
+            }
+
+            out.writeInt (numPixels);
+            out.write (alphas.data(), alphas.size());
+
+            out.writeString (design.layoutKey);
+            out.writeInt (static_cast<int> (design.triangles.size()));
+            for (const auto& tri : design.triangles)
+            {
+                out.writeInt (tri.a);
+                out.writeInt (tri.b);
+                out.writeInt (tri.c);
+                out.writeFloat (tri.er);
+                out.writeFloat (tri.ec);
+                out.writeFloat (tri.ez);
+            }
+            out.flush();
+        }
+        return block.getMemoryBlock();
+    }
+
+    static bool read (const juce::MemoryBlock& data, Design& design)
+    {
+        if (data.isEmpty())
+            return false;
+
+        juce::MemoryInputStream source (data, false);
+        juce::GZIPDecompressorInputStream in (source);
+
+        if (in.readInt() != formatMagic)
+            return false;
+
+        design.numRows = in.readInt();
+        design.numColumns = in.readInt();
+        if (design.numRows < 1 || design.numRows > maxNumberOfRows || design.numColumns < 1 || design.numColumns > 64)
+            return false;
+
+        design.matrix.resize (design.numRows * design.numColumns);
+        for (auto& value : design.matrix)
+            value = in.readFloat();
+
+        const int numPixels = in.readInt();
+        if (numPixels < 0 || numPixels > maxNumberOfPixels)
+            return false;
+
+        std::vector<juce::uint8> alphas (2 * numPixels);
+        if (in.read (alphas.data(), static_cast<int> (alphas.size())) != static_cast<int> (alphas.size()))
+            return false;
+
+        design.energyAlphas.resize (numPixels);
+        design.rEAlphas.resize (numPixels);
+        for (int i = 0; i < numPixels; ++i)
+        {
+            design.energyAlphas[i] = alphas[i] / 255.0f;
+            design.rEAlphas[i] = alphas[numPixels + i] / 255.0f;
+        }
+
+        design.layoutKey = in.readString();
+        const int numTriangles = in.readInt();
+        if (numTriangles < 0 || numTriangles > maxNumberOfTriangles)
+            return false;
+
+        design.triangles.resize (numTriangles);
+        for (auto& tri : design.triangles)
+        {
+            const int a = in.readInt();
+            const int b = in.readInt();
+            const int c = in.readInt();
+            tri = Tri (a, b, c);
+            tri.er = in.readFloat();
+            tri.ec = in.readFloat();
+            tri.ez = in.readFloat();
+        }
+
+        return true;
+    }
+
+    static bool writeToFile (const juce::File& file, const juce::MemoryBlock& data)
+    {
+        juce::TemporaryFile temp (file);
+        if (! temp.getFile().replaceWithData (data.getData(), data.getSize()))
+            return false;
+
+        // other instances might read the same cache file, so it's replaced in one go
+        return temp.overwriteTargetFileWithTemporary();
+    }
+
+    void pruneDirectory()
+    {
+        auto files = directory.findChildFiles (juce::File::findFiles, false, "*" + juce::String (fileExtension));
+        if (files.size() <= maxNumberOfFiles)
+            return;
+
+        std::sort (files.begin(), files.end(), [] (const juce::File& a, const juce::File& b)
+                   { return a.getLastModificationTime() > b.getLastModificationTime(); });
+
+        for (int i = maxNumberOfFiles; i < files.size(); ++i)
+            files.getReference (i).deleteFile();
+    }
+
+    static juce::uint64 calculateHash (const juce::MemoryBlock& data)
+    {
+        juce::uint64 hash = 14695981039346656037ULL;
+        const auto* bytes = static_cast<const juce::uint8*> (data.getData());
+        for (size_t i = 0; i < data.getSize(); ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    //==============================================================================
+    static constexpr int formatVersion = 3; // increase it when the design calculation changes
+    static constexpr int formatMagic = 0x44524149; // "IARD"
+    static constexpr const char* fileExtension = ".decoder";
+    static constexpr int maxNumberOfFiles = 100;
+    static constexpr int maxNumberOfRows = 1024;
+    static constexpr int maxNumberOfPixels = 1 << 20;
+    static constexpr int maxNumberOfTriangles = 4096;
+
+    juce::File directory;
+    std::atomic<bool> useDirectory {true};
+
+    juce::CriticalSection stateLock;
+    juce::String stateKey;
+    juce::MemoryBlock stateData;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DecoderCache)
+};
@@ -0,0 +1,169 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+/**
+ Runs decoder calculations on a background thread, so they neither block the message thread nor
+ the loading of a session. Starting a new calculation cancels the running one. The calculation
+ can split its work with parallelFor(), which distributes it over a thread pool shared by all
+ instances, and report its progress with setProgress().
+ */
+class DecoderCalculationThread : private juce::Thread
+{
+public:
+    using Calculation = std::function<void (DecoderCalculationThread&)>;
+
+    DecoderCalculationThread() : juce::Thread ("DecoderCalculation")
+    {
+        startThread();
+    }
+
+    ~DecoderCalculationThread() override
+    {
+        stop();
+    }
+
+    /** Stops the thread, call this before anything the calculations use is destroyed. */
+    void stop()
+    {
+        cancel();
+        stopThread (5000);
+    }
+
+    /** Cancels the running calculation and starts the new one as soon as possible. */
+    void start (Calculation newCalculation)
+    {
+        {
+            const juce::ScopedLock lock (calculationLock);
+            cancelled = true;
+            pendingCalculation = std::move (newCalculation);
+            busy = true;
+        }
+        notify();
+    }
+
+    /** Cancels the running and the pending calculation. */
+    void cancel()
+    {
+        const juce::ScopedLock lock (calculationLock);
+        cancelled = true;
+        pendingCalculation = nullptr;
+    }
+
+    /** Returns true while a calculation is running or waiting to be started. */
+    bool isBusy() const { return busy.load(); }
+
+    /** Returns the progress of the running calculation between 0 and 1. */
+    float getProgress() const { return progress.load(); }
+
+    //==============================================================================
+    /** Calculations should check this regularly and return as soon as it's true. */
+    bool shouldCancel() const { return cancelled.load() || threadShouldExit(); }
+
+    void setProgress (const float newProgress) { progress = newProgress; }
+
+    /**
+     Calls function (i) for each i in [0, numItems), distributed over the shared thread pool and the
+     calling thread, and returns when all items are done. The progress is moved from progressStart
+     to progressEnd. Returns false if the calculation has been cancelled, leaving items undone.
+     */
+    bool parallelFor (const int numItems, const std::function<void (int)>& function,
+                      const float progressStart = 0.0f, const float progressEnd = 1.0f)
+    {
+        std::atomic<int> nextItem {0};
+        std::atomic<int> numItemsDone {0};
+
+        auto work = [&]
+        {
+            for (int i = nextItem++; i < numItems && ! shouldCancel(); i = nextItem++)
+            {
+                function (i);
+                setProgress (progressStart + (progressEnd - progressStart) * ++numItemsDone / numItems);
+            }
+        };
+
+        const int numHelpers = juce::jmin (pool->getNumThreads(), numItems - 1);
+        std::atomic<int> numHelpersRunning {numHelpers};
+        juce::WaitableEvent helpersFinished;
+
+        for (int h = 0; h < numHelpers; ++h)
+            pool->addJob ([&]
+                          {
+                              work();
+                              if (--numHelpersRunning == 0)
+                                  helpersFinished.signal();
+                          });
+
+        work();
+
+        // the helpers use our stack, so we have to wait for them even if they haven't started yet
+        if (numHelpers > 0)
+            helpersFinished.wait();
+
+        return ! shouldCancel();
+    }
+
+private:
+    struct SharedThreadPool : public juce::ThreadPool
+    {
+        SharedThreadPool() : juce::ThreadPool (juce::jmax (1, juce::SystemStats::getNumCpus() - 1)) {}
+    };
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            Calculation calculation;
+            {
+                const juce::ScopedLock lock (calculationLock);
+                calculation = std::move (pendingCalculation);
+                pendingCalculation = nullptr;
+                cancelled = false;
+
+                if (calculation == nullptr)
+                    busy = false;
+            }
+
+            if (calculation == nullptr)
+            {
+                wait (-1);
+                continue;
+            }
+
+            progress = 0.0f;
+            calculation (*this);
+        }
+
+        busy = false;
+    }
+
+    juce::CriticalSection calculationLock;
+    Calculation pendingCalculation;
+    std::atomic<bool> cancelled {false};
+    std::atomic<bool> busy {false};
+    std::atomic<float> progress {0.0f};
+
+    juce::SharedResourcePointer<SharedThreadPool> pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DecoderCalculationThread)
+};
@@ -273,6 +273,12 @@ void AllRADecoderAudioProcessorEditor::timerCallback()
         processor.updateChannelCount = false;
         updateChannelCount();
     }
+
+    const juce::String calculateButtonText = processor.isCalculatingDecoder()
+                                             ? "CANCEL (" + juce::String (juce::roundToInt (100.0f * processor.getDecoderCalculationProgress())) + " %)"
+                                             : "CALCULATE DECODER";
+    if (tbCalculateDecoder.getButtonText() != calculateButtonText)
+        tbCalculateDecoder.setButtonText (calculateButtonText);
 }
 
 
@@ -289,7 +295,10 @@ void AllRADecoderAudioProcessorEditor::buttonClicked (juce::Button* button)
     }
     else if (button == &tbCalculateDecoder)
     {
-        processor.calculateDecoder();
+        if (processor.isCalculatingDecoder())
+            processor.cancelDecoderCalculation();
+        else
+            processor.calculateDecoder();
     }
     else if (button == &tbJson)
     {
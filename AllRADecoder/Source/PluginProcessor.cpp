@@ -64,6 +64,7 @@ energyDistribution (juce::Image::PixelFormat::ARGB, 200, 100, true), rEVector (j
 
     properties.reset (new juce::PropertiesFile (options));
     lastDir = juce::File (properties->getValue("presetFolder"));
+    decoderCache.setUseCacheDirectory (properties->getBoolValue ("useDecoderCacheDirectory", true));
 
     undoManager.beginNewTransaction();
     loudspeakers.appendChild(createLoudspeakerFromSpherical (juce::Vector3D<float> (1.0f, 0.0f, 0.0f), 1), &undoManager);
@@ -97,6 +98,8 @@ energyDistribution (juce::Image::PixelFormat::ARGB, 200, 100, true), rEVector (j
 
 AllRADecoderAudioProcessor::~AllRADecoderAudioProcessor()
 {
+    calculationThread.stop();
+    cancelPendingUpdate();
 }
 
 
@@ -170,6 +173,7 @@ void AllRADecoderAudioProcessor::prepareToPlay (double sampleRate, int samplesPe
 {
     checkInputAndOutput(this, *inputOrderSetting, 64, true);
 
+    // a decoder still calculated in the background, e.g. after loading a session, takes over once it's done
     juce::dsp::ProcessSpec specs;
     specs.sampleRate = sampleRate;
     specs.maximumBlockSize = samplesPerBlock;
@@ -203,7 +207,7 @@ void AllRADecoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
         ambisonicNoiseBurst.processBuffer (buffer);
 
         const int nChIn = juce::jmin (decoder.getCurrentDecoder()->getNumInputChannels(), buffer.getNumChannels(), input.getNumberOfChannels());
-        const int nChOut = juce::jmin (decoder.getCurrentDecoder()->getNumOutputChannels(), buffer.getNumChannels());
+        const int nChOut = juce::jmin (decoder.getNumOutputChannels(), buffer.getNumChannels());
 
         for (int ch = juce::jmax (nChIn, nChOut); ch < buffer.getNumChannels(); ++ch) // clear all not needed channels
             buffer.clear (ch, 0, buffer.getNumSamples());
@@ -247,6 +251,10 @@ void AllRADecoderAudioProcessor::getStateInformation (juce::MemoryBlock& destDat
     auto oscConfig = state.getOrCreateChildWithName ("OSCConfig", nullptr);
     oscConfig.copyPropertiesFrom (oscParameterInterface.getConfig(), nullptr);
 
+    // the design of the current decoder, so it doesn't have to be calculated again when the session is loaded
+    state.removeChild (state.getChildWithName (DecoderCache::stateType), nullptr);
+    state.appendChild (decoderCache.getState(), nullptr);
+
     std::unique_ptr<juce::XmlElement> xml (state.createXml());
     copyXmlToBinary (*xml, destData);
 }
@@ -270,6 +278,10 @@ void AllRADecoderAudioProcessor::setStateInformation (const void* data, int size
             auto oscConfig = parameters.state.getChildWithName ("OSCConfig");
             if (oscConfig.isValid())
                 oscParameterInterface.setConfig (oscConfig);
+
+            auto cachedDecoder = parameters.state.getChildWithName (DecoderCache::stateType);
+            decoderCache.setState (cachedDecoder);
+            parameters.state.removeChild (cachedDecoder, nullptr);
         }
 
         juce::XmlElement* lsps (xmlState->getChildByName("Loudspeakers"));
@@ -292,7 +304,7 @@ void AllRADecoderAudioProcessor::setStateInformation (const void* data, int size
             }
             undoManager.clearUndoHistory();
             loudspeakers.addListener(this);
-            prepareLayout();
+            prepareLayout (true);
             updateTable = true;
             calculateDecoder();
         }
@@ -511,10 +523,10 @@ void AllRADecoderAudioProcessor::convertLoudspeakersToArray()
     }
 }
 
-void AllRADecoderAudioProcessor::prepareLayout()
+void AllRADecoderAudioProcessor::prepareLayout (const bool useStoredTriangulation)
 {
     isLayoutReady = false;
-    juce::Result res = checkLayout();
+    juce::Result res = checkLayout (useStoredTriangulation);
     if (res.failed())
     {
         DBG(res.getErrorMessage());
@@ -539,7 +551,7 @@ void AllRADecoderAudioProcessor::prepareLayout()
     }
 }
 
-juce::Result AllRADecoderAudioProcessor::checkLayout()
+juce::Result AllRADecoderAudioProcessor::checkLayout (const bool useStoredTriangulation)
 {
     points.clear();
     triangles.clear();
@@ -573,11 +585,18 @@ juce::Result AllRADecoderAudioProcessor::checkLayout()
         return juce::Result::fail("ERROR 2: There are less than 4 loudspeakers! Add some more!");
     }
 
-    // calculate convex hull
-    const int result = NewtonApple_hull_3D(points, triangles);
-    if (result != 1)
+    // calculate convex hull, unless the restored session contains it already, the hull
+    // calculation sorts the points, so the stored triangles refer to the sorted ones
+    if (useStoredTriangulation)
+        std::sort (points.begin(), points.end());
+
+    if (! (useStoredTriangulation && decoderCache.findTriangulation (points, triangles)))
     {
-        return juce::Result::fail("ERROR: An error occurred! The layout might be broken somehow. Try adding additional loudspeakers (e.g. imaginary ones) or make small changes to the coordinates.");
+        const int result = NewtonApple_hull_3D(points, triangles);
+        if (result != 1)
+        {
+            return juce::Result::fail("ERROR: An error occurred! The layout might be broken somehow. Try adding additional loudspeakers (e.g. imaginary ones) or make small changes to the coordinates.");
+        }
     }
 
     // normalise normal vectors
@@ -660,116 +679,197 @@ juce::Result AllRADecoderAudioProcessor::calculateDecoder()
     if (! isLayoutReady)
         return juce::Result::fail("Layout not ready!");
 
-    const int N = juce::roundToInt (decoderOrder->load()) + 1;
-    const auto ambisonicWeights = ReferenceCountedDecoder::Weights (juce::roundToInt (weights->load()));
+    // the calculation works on a copy of the layout, so it can be edited in the meantime
+    auto calculation = std::make_shared<DecoderCalculation>();
+    calculation->points = points;
+    calculation->triangles = triangles;
+    calculation->N = juce::roundToInt (decoderOrder->load()) + 1;
+    calculation->weights = ReferenceCountedDecoder::Weights (juce::roundToInt (weights->load()));
+    calculation->imageWidth = energyDistribution.getWidth();
+    calculation->imageHeight = energyDistribution.getHeight();
+
+    {
+        const juce::ScopedLock lock (finishedCalculationLock);
+        requestedCalculation = calculation;
+    }
+
+    calculationThread.start ([this, calculation] (DecoderCalculationThread& thread) { calculateDecoder (calculation, thread); });
+
+    return juce::Result::ok();
+}
+
+void AllRADecoderAudioProcessor::cancelDecoderCalculation()
+{
+    if (! calculationThread.isBusy())
+        return;
+
+    calculationThread.cancel();
+
+    juce::File exportFile;
+    {
+        const juce::ScopedLock lock (finishedCalculationLock);
+        requestedCalculation = nullptr;
+        std::swap (exportFile, pendingExportFile);
+    }
+
+    MailBox::Message newMessage;
+    newMessage.messageColour = juce::Colours::red;
+    newMessage.headline = "Calculation cancelled";
+    newMessage.text = "The decoder calculation was cancelled, the previous decoder is still in use.";
+    messageToEditor = newMessage;
+    updateMessage = true;
+
+    // a deferred export takes the previous decoder
+    if (exportFile != juce::File())
+        saveConfigurationToFile (exportFile);
+}
+
+void AllRADecoderAudioProcessor::calculateDecoder (std::shared_ptr<DecoderCalculation> calculationToRun, DecoderCalculationThread& thread)
+{
+    DecoderCalculation& calculation = *calculationToRun;
+    const auto& points = calculation.points;
+    const auto& triangles = calculation.triangles;
+
+    const int N = calculation.N;
+    const auto ambisonicWeights = calculation.weights;
     const int nCoeffs = juce::square(N+1);
     const int nLsps = (int) points.size();
-    const int nRealLsps = nLsps - imaginaryFlags.countNumberOfSetBits();
+    const int nRealLsps = (int) std::count_if (points.begin(), points.end(), [] (const R3& p) { return ! p.isImaginary; });
     DBG("Number of loudspeakers: " << nLsps << ". Number of real loudspeakers: " << nRealLsps);
-    juce::dsp::Matrix<float> decoderMatrix (nRealLsps, nCoeffs);
 
-    juce::Array<juce::dsp::Matrix<float>> inverseArray;
-    for (int t = 0; t < triangles.size(); ++t) //iterate over each triangle
+    // a decoder designed before for the same layout and settings, e.g. stored within the session
+    const juce::String cacheKey = DecoderCache::createKey (points, N, static_cast<int> (ambisonicWeights), calculation.imageWidth, calculation.imageHeight);
+    DecoderCache::Design design;
+    if (decoderCache.find (cacheKey, design) && design.numRows == nRealLsps && design.numColumns == nCoeffs
+        && static_cast<int> (design.energyAlphas.size()) == calculation.imageWidth * calculation.imageHeight)
+    {
+        DBG("Decoder restored from cache: " << cacheKey);
+        calculation.energyAlphas = std::move (design.energyAlphas);
+        calculation.rEAlphas = std::move (design.rEAlphas);
+        calculation.restoredFromCache = true;
+        handOverDecoder (calculationToRun, juce::dsp::Matrix<float> (nRealLsps, nCoeffs, design.matrix.data()));
+        return;
+    }
+
+    // imaginary loudspeakers are normalised, so their distance doesn't change the panning
+    std::vector<juce::Vector3D<float>> vertices;
+    vertices.reserve (nLsps);
+    for (const auto& point : points)
+    {
+        const juce::Vector3D<float> vertex (point.x, point.y, point.z);
+        vertices.push_back (point.isImaginary ? vertex.normalised() : vertex);
+    }
+
+    std::vector<SphericalTriangleIndex::Triangle> triangleVertices;
+    triangleVertices.reserve (triangles.size());
+    for (const auto& tri : triangles)
+        triangleVertices.push_back ({ tri.a, tri.b, tri.c });
+
+    SphericalTriangleIndex triangleIndex;
+    triangleIndex.build (vertices, triangleVertices);
+
+    // the real loudspeakers connected to each imaginary loudspeaker
+    std::vector<juce::Array<int>> connectedLspsOfImaginaryLsp (nLsps);
+    for (int imaginaryLspIdx = 0; imaginaryLspIdx < nLsps; ++imaginaryLspIdx)
     {
-        Tri tri = triangles[t];
-        juce::Array<int> triangleIndices (tri.a, tri.b, tri.c);
-        juce::dsp::Matrix<float> L (3, 3);
-        for (int i = 0; i < 3; ++i)
+        if (! points[imaginaryLspIdx].isImaginary)
+            continue;
+
+        juce::Array<int>& connectedLsps = connectedLspsOfImaginaryLsp[imaginaryLspIdx];
+        connectedLsps.add(imaginaryLspIdx);
+        for (int k = 0; k < triangles.size(); ++k) //iterate over each triangle
         {
-            L(0, i) = points[triangleIndices[i]].x;
-            L(1, i) = points[triangleIndices[i]].y;
-            L(2, i) = points[triangleIndices[i]].z;
-            if (points[triangleIndices[i]].isImaginary)
-            {
-                const float factor = 1.0f / std::sqrt (juce::square (points[triangleIndices[i]].x) + juce::square (points[triangleIndices[i]].y) + juce::square (points[triangleIndices[i]].z));
-                L(0, i) *= factor;
-                L(1, i) *= factor;
-                L(2, i) *= factor;
+            Tri probe = triangles[k];
+            juce::Array<int> probeTriangleIndices (probe.a, probe.b, probe.c);
+            if (probeTriangleIndices.contains(imaginaryLspIdx))
+            {  // found searched imaginaryLspIdx in that triangle
+                for (int j = 0; j < 3; ++j)
+                {
+                    if (! connectedLsps.contains(probeTriangleIndices[j]))
+                        connectedLsps.add(probeTriangleIndices[j]);
+                }
             }
         }
 
-        inverseArray.add(getInverse(L));
+        connectedLsps.remove(0); // remove imaginary loudspeaker again
     }
 
+    // each chunk of t-design points is panned into its own matrix, the chunks are summed up afterwards
+    constexpr int nTDesignPoints = 5200;
+    constexpr int nChunks = 16; // fixed, so the decoder doesn't depend on the number of CPUs
+    constexpr int nPointsPerChunk = nTDesignPoints / nChunks;
+    std::vector<juce::dsp::Matrix<float>> partialDecoderMatrices (nChunks, juce::dsp::Matrix<float> (nRealLsps, nCoeffs));
 
-    std::vector<float> sh;
-    sh.resize (nCoeffs);
-
-    for (int i = 0; i < 5200; ++i) //iterate over each tDesign point
+    auto panTDesignPoints = [&] (const int chunk)
     {
-        const juce::dsp::Matrix<float> source (3, 1, tDesign5200[i]);
-        SHEval(N, source(0,0), source(1,0), source(2,0), &sh[0], false);
+        juce::dsp::Matrix<float>& decoderMatrix = partialDecoderMatrices[chunk];
+        std::vector<float> sh;
+        sh.resize (nCoeffs);
 
-        const juce::dsp::Matrix<float> gains (3, 1);
-
-        int t = 0;
-        for (; t < triangles.size(); ++t) //iterate over each triangle
+        for (int i = chunk * nPointsPerChunk; i < (chunk + 1) * nPointsPerChunk; ++i) //iterate over each tDesign point
         {
-            Tri tri = triangles[t];
+            const juce::dsp::Matrix<float> source (3, 1, tDesign5200[i]);
+            SHEval(N, source(0,0), source(1,0), source(2,0), &sh[0], false);
+
+            float g[3];
+            const int t = triangleIndex.findTriangle ({ source(0,0), source(1,0), source(2,0) }, g);
+            jassert (t >= 0);
+            if (t < 0)
+                continue;
+
+            // we found the corresponding triangle!
+            const Tri& tri = triangles[t];
             juce::Array<int> triangleIndices (tri.a, tri.b, tri.c);
             juce::Array<bool> imagFlags (points[tri.a].isImaginary, points[tri.b].isImaginary, points[tri.c].isImaginary);
-            juce::dsp::Matrix<float> gains (3, 1);
-            gains = inverseArray.getUnchecked(t) * source;
+            juce::dsp::Matrix<float> gains (3, 1, g);
+
+            const float foo = 1.0f / std::sqrt (juce::square (gains(0,0)) + juce::square (gains(1,0)) + juce::square (gains(2,0)));
+            gains = gains * foo;
 
-            if (gains(0,0) >= -FLT_EPSILON && gains(1,0) >= -FLT_EPSILON && gains(2,0) >= -FLT_EPSILON)
+            if (imagFlags.contains(true))
             {
-                // we found the corresponding triangle!
-                const float foo = 1.0f / std::sqrt (juce::square (gains(0,0)) + juce::square (gains(1,0)) + juce::square (gains(2,0)));
-                gains = gains * foo;
+                const int imagGainIdx = imagFlags.indexOf(true); // which of the three corresponds to the imaginary loudspeaker
+                const int imaginaryLspIdx = triangleIndices[imagGainIdx];
 
-                if (imagFlags.contains(true))
-                {
-                    const int imagGainIdx = imagFlags.indexOf(true); // which of the three corresponds to the imaginary loudspeaker
-                    const int imaginaryLspIdx = triangleIndices[imagGainIdx];
-
-                    juce::Array<int> realGainIndex (0, 1, 2);
-                    realGainIndex.remove(imagGainIdx);
-
-                    juce::Array<int> connectedLsps;
-                    connectedLsps.add(imaginaryLspIdx);
-                    for (int k = 0; k < triangles.size(); ++k) //iterate over each triangle
-                    {
-                        Tri probe = triangles[k];
-                        juce::Array<int> probeTriangleIndices (probe.a, probe.b, probe.c);
-                        if (probeTriangleIndices.contains(imaginaryLspIdx))
-                        {  // found searched imaginaryLspIdx in that triangle
-                            for (int j = 0; j < 3; ++j)
-                            {
-                                if (! connectedLsps.contains(probeTriangleIndices[j]))
-                                    connectedLsps.add(probeTriangleIndices[j]);
-                            }
-                        }
-                    }
-
-                    connectedLsps.remove(0); // remove imaginary loudspeaker again
-                    juce::Array<float> gainVector;
-                    gainVector.resize(connectedLsps.size());
-
-                    const float kappa = getKappa(gains(imagGainIdx, 0), gains(realGainIndex[0], 0), gains(realGainIndex[1], 0), connectedLsps.size());
-
-                    gainVector.fill(gains(imagGainIdx, 0) * (points[imaginaryLspIdx].gain) * kappa);
-
-                    for (int j = 0; j < 2; ++j)
-                    {
-                        const int idx = connectedLsps.indexOf(triangleIndices[realGainIndex[j]]);
-                        gainVector.set(idx, gainVector[idx] + gains(realGainIndex[j], 0));
-                    }
-
-                    for (int n = 0; n < connectedLsps.size(); ++n)
-                        juce::FloatVectorOperations::addWithMultiply(&decoderMatrix(points[connectedLsps[n]].realLspNum, 0), &sh[0], gainVector[n], nCoeffs);
+                juce::Array<int> realGainIndex (0, 1, 2);
+                realGainIndex.remove(imagGainIdx);
 
-                }
-                else
+                const juce::Array<int>& connectedLsps = connectedLspsOfImaginaryLsp[imaginaryLspIdx];
+                juce::Array<float> gainVector;
+                gainVector.resize(connectedLsps.size());
+
+                const float kappa = getKappa(gains(imagGainIdx, 0), gains(realGainIndex[0], 0), gains(realGainIndex[1], 0), connectedLsps.size());
+
+                gainVector.fill(gains(imagGainIdx, 0) * (points[imaginaryLspIdx].gain) * kappa);
+
+                for (int j = 0; j < 2; ++j)
                 {
-                    juce::FloatVectorOperations::addWithMultiply (&decoderMatrix (points[tri.a].realLspNum, 0), &sh[0], gains(0, 0), nCoeffs);
-                    juce::FloatVectorOperations::addWithMultiply (&decoderMatrix (points[tri.b].realLspNum, 0), &sh[0], gains(1, 0), nCoeffs);
-                    juce::FloatVectorOperations::addWithMultiply (&decoderMatrix (points[tri.c].realLspNum, 0), &sh[0], gains(2, 0), nCoeffs);
+                    const int idx = connectedLsps.indexOf(triangleIndices[realGainIndex[j]]);
+                    gainVector.set(idx, gainVector[idx] + gains(realGainIndex[j], 0));
                 }
-                break;
+
+                for (int n = 0; n < connectedLsps.size(); ++n)
+                    juce::FloatVectorOperations::addWithMultiply(&decoderMatrix(points[connectedLsps[n]].realLspNum, 0), &sh[0], gainVector[n], nCoeffs);
+
+            }
+            else
+            {
+                juce::FloatVectorOperations::addWithMultiply (&decoderMatrix (points[tri.a].realLspNum, 0), &sh[0], gains(0, 0), nCoeffs);
+                juce::FloatVectorOperations::addWithMultiply (&decoderMatrix (points[tri.b].realLspNum, 0), &sh[0], gains(1, 0), nCoeffs);
+                juce::FloatVectorOperations::addWithMultiply (&decoderMatrix (points[tri.c].realLspNum, 0), &sh[0], gains(2, 0), nCoeffs);
             }
         }
-        jassert(t < triangles.size());
-    }
+    };
+
+    if (! thread.parallelFor (nChunks, panTDesignPoints, 0.0f, 0.2f))
+        return;
+
+    juce::dsp::Matrix<float> decoderMatrix (partialDecoderMatrices[0]);
+    for (int chunk = 1; chunk < nChunks; ++chunk)
+        decoderMatrix += partialDecoderMatrices[chunk];
+
+    std::vector<float> sh;
+    sh.resize (nCoeffs);
 
     // calculate max lsp gain
     float maxGain = 0.0f;
@@ -804,26 +904,30 @@ juce::Result AllRADecoderAudioProcessor::calculateDecoder()
             realLspsCoordinates.set (points[i].realLspNum, juce::Vector3D<float>(points[i].x, points[i].y, points[i].z).normalised()); // zero count
     }
 
-    const int w = energyDistribution.getWidth();
+    const int w = calculation.imageWidth;
     const float wHalf = w / 2;
-    const int h = energyDistribution.getHeight();
+    const int h = calculation.imageHeight;
     const float hHalf = h / 2;
-    float minLvl = 0.0f;
-    float maxLvl = 0.0f;
-    float sumLvl = 0.0f;
-    auto levelValues = juce::dsp::Matrix<float> (w, h);
-    for (int y = 0; y < h; ++y)
+    std::vector<float> levelValues (w * h);
+    calculation.rEAlphas.resize (w * h);
+
+    // each row of the images is calculated by one thread
+    auto calculateRow = [&] (const int y)
+    {
+        std::vector<float> shRow;
+        shRow.resize (nCoeffs);
+
         for (int x = 0; x < w; ++x)
         {
             juce::Vector3D<float> spher (1.0f, 0.0f, 0.0f);
             HammerAitov::XYToSpherical((x - wHalf) / wHalf, (hHalf - y) / hHalf, spher.y, spher.z);
             juce::Vector3D<float> cart = sphericalInRadiansToCartesian(spher);
-            SHEval(N, cart.x, cart.y, cart.z, &sh[0]); // encoding a source
+            SHEval(N, cart.x, cart.y, cart.z, &shRow[0]); // encoding a source
 
             if (ambisonicWeights == ReferenceCountedDecoder::Weights::maxrE)
-                multiplyMaxRE (N, sh.data());
+                multiplyMaxRE (N, shRow.data());
             else if (ambisonicWeights == ReferenceCountedDecoder::Weights::inPhase)
-                multiplyInPhase (N, sh.data());
+                multiplyInPhase (N, shRow.data());
 
 
             juce::Vector3D<float> rE (0.0f, 0.0f, 0.0f);
@@ -832,78 +936,142 @@ juce::Result AllRADecoderAudioProcessor::calculateDecoder()
             {
                 float sum = 0.0f;
                 for (int n = 0; n < nCoeffs; ++n)
-                    sum += (sh[n] * decoderMatrix(m, n));
+                    sum += (shRow[n] * decoderMatrix(m, n));
                 const float sumSquared = juce::square(sum);
                 rE += realLspsCoordinates[m] * sumSquared;
                 sumOfSquares += sumSquared;
             }
 
-            const float lvl = 0.5f * juce::Decibels::gainToDecibels (sumOfSquares);
-            levelValues(x, y) = lvl;
-            sumLvl += lvl;
-
-            if (lvl > maxLvl)
-                maxLvl = lvl;
-            if (lvl < minLvl)
-                minLvl = lvl;
+            levelValues[y * w + x] = 0.5f * juce::Decibels::gainToDecibels (sumOfSquares);
 
             rE /= sumOfSquares + FLT_EPSILON;
             const float width = 2.0f * std::acos (juce::jmin (1.0f, rE.length()));
-            const float reMap = juce::jlimit (0.0f, 1.0f, width / juce::MathConstants<float>::pi);
-
-            const juce::Colour rEPixelColour = juce::Colours::limegreen.withMultipliedAlpha(reMap);
-            rEVector.setPixelAt (x, y, rEPixelColour);
+            calculation.rEAlphas[y * w + x] = juce::jlimit (0.0f, 1.0f, width / juce::MathConstants<float>::pi);
         }
+    };
 
-    const float meanLvl = sumLvl / (w * h);
-    for (int y = 0; y < h; ++y)
-        for (int x = 0; x < w; ++x)
-        {
-            constexpr float plusMinusRange = 1.5f;
-            const float map = (juce::jlimit (-plusMinusRange, plusMinusRange, levelValues(x, y) - meanLvl) + plusMinusRange) / (2 * plusMinusRange);
+    if (! thread.parallelFor (h, calculateRow, 0.2f, 1.0f))
+        return;
 
-            const juce::Colour pixelColour = juce::Colours::red.withMultipliedAlpha (map);
-            energyDistribution.setPixelAt (x, y, pixelColour);
-        }
+    float minLvl = 0.0f;
+    float maxLvl = 0.0f;
+    float sumLvl = 0.0f;
+    for (const float lvl : levelValues)
+    {
+        sumLvl += lvl;
+
+        if (lvl > maxLvl)
+            maxLvl = lvl;
+        if (lvl < minLvl)
+            minLvl = lvl;
+    }
+
+    const float meanLvl = sumLvl / (w * h);
+    calculation.energyAlphas.resize (w * h);
+    for (int i = 0; i < w * h; ++i)
+    {
+        constexpr float plusMinusRange = 1.5f;
+        calculation.energyAlphas[i] = (juce::jlimit (-plusMinusRange, plusMinusRange, levelValues[i] - meanLvl) + plusMinusRange) / (2 * plusMinusRange);
+    }
 
     DBG("min: " << minLvl << " max: " << maxLvl);
 
-    updateLoudspeakerVisualization = true;
 
+    if (thread.shouldCancel())
+        return;
+
+    design.numRows = nRealLsps;
+    design.numColumns = nCoeffs;
+    design.matrix.assign (decoderMatrix.getRawDataPointer(), decoderMatrix.getRawDataPointer() + nRealLsps * nCoeffs);
+    design.energyAlphas = calculation.energyAlphas;
+    design.rEAlphas = calculation.rEAlphas;
+    design.layoutKey = DecoderCache::createLayoutKey (points);
+    design.triangles = triangles;
+    decoderCache.store (cacheKey, design);
+
+    handOverDecoder (calculationToRun, decoderMatrix);
+
+    DBG("finished");
+}
+
+void AllRADecoderAudioProcessor::handOverDecoder (std::shared_ptr<DecoderCalculation> calculationToHandOver, const juce::dsp::Matrix<float>& decoderMatrix)
+{
+    DecoderCalculation& calculation = *calculationToHandOver;
+    const auto& points = calculation.points;
+    const int N = calculation.N;
+    const int nLsps = (int) points.size();
 
     ReferenceCountedDecoder::Ptr newDecoder = new ReferenceCountedDecoder("Decoder", "A " + getOrderString(N) + " order Ambisonics decoder using the AllRAD approach.", (int) decoderMatrix.getSize()[0], (int) decoderMatrix.getSize()[1]);
     newDecoder->getMatrix() = decoderMatrix;
     ReferenceCountedDecoder::Settings newSettings;
     newSettings.expectedNormalization = ReferenceCountedDecoder::Normalization::n3d;
-    newSettings.weights = ambisonicWeights;
+    newSettings.weights = calculation.weights;
     newSettings.weightsAlreadyApplied = false;
 
     newDecoder->setSettings(newSettings);
 
     juce::Array<int>& routing = newDecoder->getRoutingArrayReference();
-    routing.resize(nRealLsps);
+    routing.resize((int) decoderMatrix.getSize()[0]);
     for (int i = 0; i < nLsps; ++i)
     {
         if (! points[i].isImaginary)
             routing.set(points[i].realLspNum, points[i].channel - 1); // zero count
     }
 
+    // the hand-over to the audio thread is lock-free, everything else is taken over on the message thread
     decoder.setDecoder(newDecoder);
-    decoderConfig = newDecoder;
+    calculation.newDecoder = newDecoder;
 
-    updateChannelCount = true;
+    {
+        const juce::ScopedLock lock (finishedCalculationLock);
+        finishedCalculation = calculationToHandOver;
+    }
+    triggerAsyncUpdate();
+}
 
-    DBG("finished");
+void AllRADecoderAudioProcessor::handleAsyncUpdate()
+{
+    std::shared_ptr<DecoderCalculation> calculation;
+    juce::File exportFile;
+    {
+        const juce::ScopedLock lock (finishedCalculationLock);
+        calculation = std::move (finishedCalculation);
+        finishedCalculation = nullptr;
+
+        if (calculation != nullptr && calculation == requestedCalculation)
+        {
+            requestedCalculation = nullptr;
+            std::swap (exportFile, pendingExportFile);
+        }
+    }
+
+    if (calculation == nullptr)
+        return;
+
+    const int w = calculation->imageWidth;
+    const int h = calculation->imageHeight;
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+        {
+            energyDistribution.setPixelAt (x, y, juce::Colours::red.withMultipliedAlpha (calculation->energyAlphas[y * w + x]));
+            rEVector.setPixelAt (x, y, juce::Colours::limegreen.withMultipliedAlpha (calculation->rEAlphas[y * w + x]));
+        }
+
+    updateLoudspeakerVisualization = true;
+
+    decoderConfig = calculation->newDecoder;
+
+    updateChannelCount = true;
 
     MailBox::Message newMessage;
     newMessage.messageColour = juce::Colours::green;
     newMessage.headline = "Decoder created";
-    newMessage.text = "The decoder was calculated successfully.";
+    newMessage.text = calculation->restoredFromCache ? "The decoder was restored from a previous calculation." : "The decoder was calculated successfully.";
     messageToEditor = newMessage;
     updateMessage = true;
 
-
-    return juce::Result::ok();
+    if (exportFile != juce::File())
+        saveConfigurationToFile (exportFile);
 }
 
 float AllRADecoderAudioProcessor::getKappa(float gIm, float gRe1, float gRe2, int N)
@@ -913,32 +1081,6 @@ float AllRADecoderAudioProcessor::getKappa(float gIm, float gRe1, float gRe2, in
     return - p + std::sqrt (juce::jmax (juce::square(p) - q, 0.0f));
 }
 
-juce::dsp::Matrix<float> AllRADecoderAudioProcessor::getInverse (juce::dsp::Matrix<float> A)
-{
-    const float det = A (0, 0) * (A (1, 1) * A (2, 2) - A (1, 2) * A (2, 1))
-    + A (0, 1) * (A (1, 2) * A (2, 0) - A (1, 0) * A (2, 2))
-    + A (0, 2) * (A (1, 0) * A (2, 1) - A (1, 1) * A (2, 0));
-
-    const float factor = 1.0 / det;
-
-    juce::dsp::Matrix<float> inverse(3, 3);
-
-    inverse(0, 0) = (A (1, 1) * A (2, 2) - A (1, 2) * A (2, 1)) * factor;
-    inverse(0, 1) = (-A (0, 1) * A (2, 2) + A (0, 2) * A (2, 1)) * factor;
-    inverse(0, 2) = (A (0, 1) * A (1, 2) - A (0, 2) * A (1, 1)) * factor;
-
-    inverse(1, 0) = (-A (1, 0) * A (2, 2) + A (1, 2) * A (2, 0)) * factor;
-    inverse(1, 1) = (A (0, 0) * A (2, 2) - A (0, 2) * A (2, 0)) * factor;
-    inverse(1, 2) = (-A (0, 0) * A (1, 2) + A (0, 2) * A (1, 0)) * factor;
-
-    inverse(2, 0) = ( A (1, 0) * A (2, 1) - A (1, 1) * A (2, 0)) * factor;
-    inverse(2, 1) = (-A (0, 0) * A (2, 1) + A (0, 1) * A (2, 0)) * factor;
-    inverse(2, 2) = ( A (0, 0) * A (1, 1) - A (0, 1) * A (1, 0)) * factor;
-
-
-    return inverse;
-}
-
 void AllRADecoderAudioProcessor::saveConfigurationToFile (juce::File destination)
 {
     if (*exportDecoder < 0.5f && *exportLayout < 0.5f)
@@ -953,6 +1095,24 @@ void AllRADecoderAudioProcessor::saveConfigurationToFile (juce::File destination
         return;
     }
 
+    // the decoder which is still being calculated is exported as soon as it's taken over
+    if (*exportDecoder >= 0.5f)
+    {
+        const juce::ScopedLock lock (finishedCalculationLock);
+        if (requestedCalculation != nullptr)
+        {
+            pendingExportFile = destination;
+
+            MailBox::Message newMessage;
+            newMessage.messageColour = juce::Colours::cornflowerblue;
+            newMessage.headline = "Export deferred";
+            newMessage.text = "The decoder is still being calculated, the configuration will be exported as soon as it's done.";
+            messageToEditor = newMessage;
+            updateMessage = true;
+            return;
+        }
+    }
+
     auto* jsonObj = new juce::DynamicObject();
     jsonObj->setProperty("Name", juce::var("All-Round Ambisonic decoder (AllRAD) and loudspeaker layout"));
     char versionString[10];
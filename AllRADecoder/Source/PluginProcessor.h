@@ -28,6 +28,7 @@
 
 #include "../../resources/customComponents/MailBox.h"
 #include "../../resources/NewtonApple/NewtonApple_hull3D.h"
+#include "../../resources/SphericalTriangleIndex.h"
 #include "tDesign5200.h"
 #include "../../resources/efficientSHvanilla.h"
 #include "../../resources/ReferenceCountedDecoder.h"
@@ -40,13 +41,16 @@
 #include "../../resources/HammerAitov.h"
 #include "NoiseBurst.h"
 #include "AmbisonicNoiseBurst.h"
+#include "DecoderCalculationThread.h"
+#include "DecoderCache.h"
 
 #define ProcessorClass AllRADecoderAudioProcessor
 
 //==============================================================================
 
 class AllRADecoderAudioProcessor  : public AudioProcessorBase<IOTypes::Ambisonics<7>, IOTypes::AudioChannels<64>>,
-                                        public juce::ValueTree::Listener
+                                        public juce::ValueTree::Listener,
+                                        private juce::AsyncUpdater
 {
 public:
     constexpr static int numberOfInputChannels = 64;
@@ -120,7 +124,11 @@ public:
     juce::BigInteger imaginaryFlags;
     juce::UndoManager undoManager;
 
+    /** Starts calculating a decoder for the current layout in the background, cancelling a running calculation. */
     juce::Result calculateDecoder();
+    void cancelDecoderCalculation();
+    bool isCalculatingDecoder() const { return calculationThread.isBusy(); }
+    float getDecoderCalculationProgress() const { return calculationThread.getProgress(); }
 
     void setLastDir (juce::File newLastDir);
     juce::File getLastDir() {return lastDir;};
@@ -160,14 +168,39 @@ private:
     std::unique_ptr<juce::PropertiesFile> properties;
 
     // ========== METHODS
-    void prepareLayout();
-    juce::Result checkLayout();
+    void prepareLayout (const bool useStoredTriangulation = false);
+    juce::Result checkLayout (const bool useStoredTriangulation);
     juce::Result verifyLoudspeakers();
     juce::Result calculateTris();
     void convertLoudspeakersToArray();
 
+    // copy of the layout and settings a decoder is calculated for, together with the results
+    struct DecoderCalculation
+    {
+        std::vector<R3> points;
+        std::vector<Tri> triangles;
+        int N;
+        ReferenceCountedDecoder::Weights weights;
+        int imageWidth, imageHeight;
+
+        ReferenceCountedDecoder::Ptr newDecoder;
+        std::vector<float> energyAlphas, rEAlphas; // [y * imageWidth + x]
+        bool restoredFromCache = false;
+    };
+
+    void calculateDecoder (std::shared_ptr<DecoderCalculation> calculationToRun, DecoderCalculationThread& thread);
+    void handOverDecoder (std::shared_ptr<DecoderCalculation> calculationToHandOver, const juce::dsp::Matrix<float>& decoderMatrix);
+    void handleAsyncUpdate() override; // takes over finished calculations
+
+    DecoderCalculationThread calculationThread;
+    juce::CriticalSection finishedCalculationLock;
+    std::shared_ptr<DecoderCalculation> finishedCalculation;
+    std::shared_ptr<DecoderCalculation> requestedCalculation; // the latest one, until it's taken over or cancelled
+    juce::File pendingExportFile; // exported as soon as the requested decoder is taken over
+
+    DecoderCache decoderCache;
+
     float getKappa (float gIm, float gRe1, float gRe2, int N);
-    juce::dsp::Matrix<float> getInverse (juce::dsp::Matrix<float> A);
 
     juce::ValueTree createLoudspeakerFromCartesian (juce::Vector3D<float> cartesianCoordinates, int channel, bool isImaginary = false, float gain = 1.0f);
     juce::ValueTree createLoudspeakerFromSpherical (juce::Vector3D<float> sphericalCoordinates, int channel, bool isImaginary = false, float gain = 1.0f);
@@ -0,0 +1,437 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <IRData.h>
+#include "../../resources/PartitionedConvolution.h"
+
+/**
+ SH-domain binaural filters, already resampled to the session's sample rate and transformed
+ into the partition spectra used by PartitionedConvolution. There's one filter per Ambisonic
+ channel (ACN), which holds the left ear's filter; the right ear's filters follow from the
+ left-right symmetry of the spherical harmonics (mid and side channels).
+ */
+class BinauralFilterSet : public juce::ReferenceCountedObject
+{
+public:
+    typedef juce::ReferenceCountedObjectPtr<BinauralFilterSet> Ptr;
+
+    BinauralFilterSet (const juce::String& nameToUse, const int orderToUse, const double sampleRateToUse,
+                       const int partitionSizeToUse, const int impulseResponseLength)
+        : name (nameToUse), order (orderToUse), sampleRate (sampleRateToUse), partitionSize (partitionSizeToUse),
+          irLength (impulseResponseLength),
+          numPartitions (PartitionedConvolution::getNumPartitions (impulseResponseLength, partitionSizeToUse))
+    {
+        spectra.resize (static_cast<size_t> (getNumChannels() * numPartitions * getNumBins()));
+    }
+
+    const juce::String& getName() const { return name; }
+    int getOrder() const { return order; }
+    int getNumChannels() const { return juce::square (order + 1); }
+    double getSampleRate() const { return sampleRate; }
+    int getPartitionSize() const { return partitionSize; }
+    int getImpulseResponseLength() const { return irLength; }
+    int getNumPartitions() const { return numPartitions; }
+    int getNumBins() const { return partitionSize + 1; }
+
+    std::complex<float>* getSpectra (const int channel)
+    {
+        return spectra.data() + channel * numPartitions * getNumBins();
+    }
+
+    //==============================================================================
+    bool writeToFile (const juce::File& file)
+    {
+        juce::TemporaryFile temp (file);
+
+        {
+            juce::FileOutputStream out (temp.getFile());
+            if (out.failedToOpen())
+                return false;
+
+            out.writeInt (fileMagic);
+            out.writeString (name);
+            out.writeInt (order);
+            out.writeDouble (sampleRate);
+            out.writeInt (partitionSize);
+            out.writeInt (irLength);
+            out.write (spectra.data(), spectra.size() * sizeof (std::complex<float>));
+            out.flush();
+
+            if (out.getStatus().failed())
+                return false;
+        }
+
+        // other instances might read the same cache file, so it's replaced in one go
+        return temp.overwriteTargetFileWithTemporary();
+    }
+
+    static Ptr readFromFile (const juce::File& file)
+    {
+        juce::FileInputStream in (file);
+        if (in.failedToOpen() || in.readInt() != fileMagic)
+            return nullptr;
+
+        const auto readName = in.readString();
+        const int readOrder = in.readInt();
+        const double readSampleRate = in.readDouble();
+        const int readPartitionSize = in.readInt();
+        const int readIrLength = in.readInt();
+
+        if (readOrder < 0 || readOrder > 7 || ! juce::isPowerOfTwo (readPartitionSize) || readIrLength <= 0)
+            return nullptr;
+
+        Ptr set = new BinauralFilterSet (readName, readOrder, readSampleRate, readPartitionSize, readIrLength);
+        const size_t numBytes = set->spectra.size() * sizeof (std::complex<float>);
+        if (static_cast<size_t> (in.read (set->spectra.data(), static_cast<int> (numBytes))) != numBytes)
+            return nullptr;
+
+        return set;
+    }
+
+private:
+    static constexpr int fileMagic = 0x53464249; // "IBFS"
+
+    const juce::String name;
+    const int order;
+    const double sampleRate;
+    const int partitionSize;
+    const int irLength;
+    const int numPartitions;
+
+    std::vector<std::complex<float>> spectra; // [channel][partition][bin]
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BinauralFilterSet)
+};
+
+
+//==============================================================================
+/**
+ Prepares BinauralFilterSets on a background thread, which is shared by all plug-in instances
+ (use it with juce::SharedResourcePointer). The sources are the built-in filters or audio files
+ (wav, aiff, flac) with (N+1)^2 channels holding the SH-domain filters of the left ear, just like
+ the built-in ones.
+
+ Each prepared set is written to an on-disk cache keyed by a hash of the source data, the sample
+ rate, the order and the FFT size, and kept in memory as long as an instance uses it, so
+ instances using the same filters don't repeat the work.
+ */
+class BinauralFilterSetCache : private juce::Thread
+{
+public:
+    /**
+     A request for a filter set. Its result can be polled from the audio thread with isReady()
+     and getFilterSet(). The cache holds a reference to each request until nobody else uses it,
+     so dropping a request never deletes it (or its filters) on the audio thread.
+     */
+    class Request : public juce::ReferenceCountedObject
+    {
+    public:
+        typedef juce::ReferenceCountedObjectPtr<Request> Ptr;
+
+        Request (const juce::File& sourceToUse, const int orderToUse, const double sampleRateToUse, const int partitionSizeToUse)
+            : source (sourceToUse), order (orderToUse), sampleRate (sampleRateToUse), partitionSize (partitionSizeToUse)
+        {
+        }
+
+        bool matches (const juce::File& otherSource, const int otherOrder, const double otherSampleRate, const int otherPartitionSize) const
+        {
+            return source == otherSource && order == otherOrder && sampleRate == otherSampleRate && partitionSize == otherPartitionSize;
+        }
+
+        bool isReady() const { return ready.load (std::memory_order_acquire); }
+
+        /** Returns the filter set, or nullptr if it isn't ready yet or preparing it failed. */
+        BinauralFilterSet* getFilterSet() const { return isReady() ? filterSet.get() : nullptr; }
+
+        /** Returns an error message if preparing the filter set failed. Only valid once the request is ready. */
+        const juce::String& getErrorMessage() const { return errorMessage; }
+
+        bool waitUntilReady (const int timeOutMilliseconds) const
+        {
+            return isReady() || (finished.wait (timeOutMilliseconds) && isReady());
+        }
+
+        const juce::File source; // juce::File() for the built-in filters
+        const int order;
+        const double sampleRate;
+        const int partitionSize;
+
+    private:
+        friend class BinauralFilterSetCache;
+
+        void setResult (BinauralFilterSet::Ptr set, const juce::String& error)
+        {
+            filterSet = set;
+            errorMessage = error;
+            ready.store (true, std::memory_order_release);
+            finished.signal();
+        }
+
+        BinauralFilterSet::Ptr filterSet;
+        juce::String errorMessage;
+        std::atomic<bool> ready {false};
+        juce::WaitableEvent finished {true};
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Request)
+    };
+
+    //==============================================================================
+    BinauralFilterSetCache() : juce::Thread ("BinauralFilterSetCache")
+    {
+        formatManager.registerBasicFormats();
+        cacheDirectory = juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                            .getChildFile ("IEM").getChildFile ("BinauralDecoder").getChildFile ("FilterCache");
+        startThread();
+    }
+
+    ~BinauralFilterSetCache() override
+    {
+        stopThread (10000);
+    }
+
+    /**
+     Requests a filter set of the given order, sample rate and partition size. Pass juce::File()
+     for the built-in filters. Sets with a lower order than requested are used as they are.
+     */
+    Request::Ptr requestFilterSet (const juce::File& source, const int order, const double sampleRate, const int partitionSize)
+    {
+        Request::Ptr request = new Request (source, order, sampleRate, partitionSize);
+        {
+            const juce::ScopedLock lock (requestsLock);
+            requests.add (request);
+        }
+        notify();
+        return request;
+    }
+
+private:
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            Request::Ptr request;
+            {
+                const juce::ScopedLock lock (requestsLock);
+
+                // release requests and sets nobody is interested in anymore
+                for (int i = requests.size(); --i >= 0;)
+                    if (requests.getObjectPointerUnchecked (i)->getReferenceCount() == 1)
+                        requests.remove (i);
+
+                for (int i = filterSets.size(); --i >= 0;)
+                    if (filterSets.getObjectPointerUnchecked (i)->getReferenceCount() == 1)
+                    {
+                        filterSets.remove (i);
+                        filterSetKeys.remove (i);
+                    }
+
+                for (auto* r : requests)
+                    if (! r->isReady())
+                    {
+                        request = r;
+                        break;
+                    }
+            }
+
+            if (request != nullptr)
+                process (*request);
+            else
+                wait (1000);
+        }
+    }
+
+    void process (Request& request)
+    {
+        juce::MemoryBlock sourceData;
+        juce::String name;
+
+        if (request.source == juce::File())
+        {
+            name = "IEM built-in";
+            int size;
+            const void* data = getBuiltInData (request.order, size);
+            sourceData.append (data, static_cast<size_t> (size));
+        }
+        else
+        {
+            name = request.source.getFileNameWithoutExtension();
+            if (! request.source.existsAsFile() || ! request.source.loadFileAsData (sourceData))
+            {
+                request.setResult (nullptr, "File '" + request.source.getFullPathName() + "' could not be read.");
+                return;
+            }
+        }
+
+        const juce::String key = juce::String::toHexString (static_cast<juce::int64> (calculateHash (sourceData)))
+                                    + "_" + juce::String (juce::roundToInt (request.sampleRate))
+                                    + "_" + juce::String (request.order)
+                                    + "_" + juce::String (2 * request.partitionSize);
+
+        // already prepared for another instance?
+        {
+            const juce::ScopedLock lock (requestsLock);
+            const int idx = filterSetKeys.indexOf (key);
+            if (idx >= 0)
+            {
+                request.setResult (filterSets[idx], {});
+                return;
+            }
+        }
+
+        const auto cacheFile = cacheDirectory.getChildFile (key + ".filters");
+        BinauralFilterSet::Ptr set = BinauralFilterSet::readFromFile (cacheFile);
+
+        juce::String error;
+        if (set == nullptr)
+        {
+            set = prepareFilterSet (sourceData, name, request, error);
+
+            if (set != nullptr && cacheDirectory.createDirectory().wasOk() && ! set->writeToFile (cacheFile))
+                DBG ("BinauralFilterSetCache: could not write cache file " << cacheFile.getFullPathName());
+        }
+
+        if (set != nullptr)
+        {
+            const juce::ScopedLock lock (requestsLock);
+            filterSets.add (set);
+            filterSetKeys.add (key);
+        }
+
+        request.setResult (set, error);
+    }
+
+    BinauralFilterSet::Ptr prepareFilterSet (const juce::MemoryBlock& sourceData, const juce::String& name,
+                                             const Request& request, juce::String& error)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (std::make_unique<juce::MemoryInputStream> (sourceData, false)));
+        if (reader == nullptr)
+        {
+            error = "The file format of '" + name + "' is not supported.";
+            return nullptr;
+        }
+
+        const int numChannels = static_cast<int> (reader->numChannels);
+        const int fileOrder = juce::roundToInt (std::sqrt (numChannels)) - 1;
+        if (fileOrder < 1 || juce::square (fileOrder + 1) != numChannels)
+        {
+            error = "'" + name + "' has " + juce::String (numChannels) + " channels, SH-domain filters need (N+1)^2 channels with N >= 1.";
+            return nullptr;
+        }
+
+        const int length = static_cast<int> (reader->lengthInSamples);
+        if (length <= 0 || length > maxImpulseResponseLength)
+        {
+            error = "The filters of '" + name + "' have to be shorter than " + juce::String (maxImpulseResponseLength) + " samples.";
+            return nullptr;
+        }
+
+        const int order = juce::jmin (request.order, fileOrder);
+        const int nCh = juce::square (order + 1);
+
+        juce::AudioBuffer<float> irs (numChannels, length);
+        reader->read (&irs, 0, length, 0, true, false);
+
+        if (request.source == juce::File())
+            irs.applyGain (0.3f);
+
+        int irLength = length;
+        juce::AudioBuffer<float> resampledIRs;
+        const juce::AudioBuffer<float>* filters = &irs;
+
+        if (reader->sampleRate != request.sampleRate) // do resampling!
+        {
+            const double factorReading = reader->sampleRate / request.sampleRate;
+            irLength = juce::roundToInt (length / factorReading + 0.49);
+
+            juce::MemoryAudioSource memorySource (irs, false);
+            juce::ResamplingAudioSource resamplingSource (&memorySource, false, numChannels);
+
+            resamplingSource.setResamplingRatio (factorReading);
+            resamplingSource.prepareToPlay (irLength, request.sampleRate);
+
+            resampledIRs.setSize (numChannels, irLength);
+            juce::AudioSourceChannelInfo info;
+            info.startSample = 0;
+            info.numSamples = irLength;
+            info.buffer = &resampledIRs;
+
+            resamplingSource.getNextAudioBlock (info);
+
+            // compensate for more (correlated) samples contributing to output signal
+            resampledIRs.applyGain (static_cast<float> (reader->sampleRate / request.sampleRate));
+            filters = &resampledIRs;
+        }
+
+        BinauralFilterSet::Ptr set = new BinauralFilterSet (name, order, request.sampleRate, request.partitionSize, irLength);
+
+        juce::dsp::FFT fft (static_cast<int> (std::log2 (2 * request.partitionSize)));
+        std::vector<std::complex<float>> scratch;
+        for (int ch = 0; ch < nCh; ++ch)
+            PartitionedConvolution::calculatePartitionSpectra (fft, scratch, request.partitionSize, filters->getReadPointer (ch),
+                                                               irLength, set->getNumPartitions(), set->getSpectra (ch));
+
+        return set;
+    }
+
+    static const void* getBuiltInData (const int order, int& size)
+    {
+        switch (juce::jlimit (1, 7, order))
+        {
+            case 1: size = IRData::irsOrd1_wavSize; return IRData::irsOrd1_wav;
+            case 2: size = IRData::irsOrd2_wavSize; return IRData::irsOrd2_wav;
+            case 3: size = IRData::irsOrd3_wavSize; return IRData::irsOrd3_wav;
+            case 4: size = IRData::irsOrd4_wavSize; return IRData::irsOrd4_wav;
+            case 5: size = IRData::irsOrd5_wavSize; return IRData::irsOrd5_wav;
+            case 6: size = IRData::irsOrd6_wavSize; return IRData::irsOrd6_wav;
+            default: size = IRData::irsOrd7_wavSize; return IRData::irsOrd7_wav;
+        }
+    }
+
+    /** 64 bit FNV-1a hash of the source data. */
+    static juce::uint64 calculateHash (const juce::MemoryBlock& data)
+    {
+        juce::uint64 hash = 14695981039346656037ULL;
+        const auto* bytes = static_cast<const juce::uint8*> (data.getData());
+        for (size_t i = 0; i < data.getSize(); ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    //==============================================================================
+    static constexpr int maxImpulseResponseLength = 65536;
+
+    juce::AudioFormatManager formatManager;
+    juce::File cacheDirectory;
+
+    juce::CriticalSection requestsLock;
+    juce::ReferenceCountedArray<Request> requests;
+    juce::ReferenceCountedArray<BinauralFilterSet> filterSets;
+    juce::StringArray filterSetKeys;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BinauralFilterSetCache)
+};
@@ -30,7 +30,7 @@ BinauralDecoderAudioProcessorEditor::BinauralDecoderAudioProcessorEditor (Binaur
 {
     // ============== BEGIN: essentials ======================
     // set GUI size and lookAndFeel
-    setSize(450, 140); // use this to create a fixed-size GUI
+    setSize(450, 320); // use this to create a fixed-size GUI
     //setResizeLimits(500, 300, 800, 500); // use this to create a resizable GUI
     setLookAndFeel (&globalLaF);
 
@@ -54,6 +54,77 @@ BinauralDecoderAudioProcessorEditor::BinauralDecoderAudioProcessorEditor (Binaur
     cbEq.addItemList(processor.headphoneEQs, 2);
     cbEqAttachment.reset (new ComboBoxAttachment (valueTreeState, "applyHeadphoneEq", cbEq));
 
+    addAndMakeVisible (lbLowLatency);
+    lbLowLatency.setText ("Low Latency Mode");
+
+    addAndMakeVisible (cbLowLatency);
+    cbLowLatency.addItem ("OFF", 1);
+    cbLowLatency.addItem ("ON", 2);
+    cbLowLatencyAttachment.reset (new ComboBoxAttachment (valueTreeState, "lowLatencyMode", cbLowLatency));
+
+    addAndMakeVisible (lbFilterSet);
+    lbFilterSet.setText (filterSetStatus);
+
+    addAndMakeVisible (btLoadFilterSet);
+    btLoadFilterSet.setButtonText ("Load filters");
+    btLoadFilterSet.onClick = [&] () { loadFilterSetFile(); };
+    btLoadFilterSet.setColour (juce::TextButton::buttonColourId, juce::Colours::orange);
+
+    addAndMakeVisible (btBuiltInFilterSet);
+    btBuiltInFilterSet.setButtonText ("Built-in");
+    btBuiltInFilterSet.onClick = [&] () { processor.loadFilterSet (juce::File()); };
+
+    // head tracking
+    addAndMakeVisible (&slYaw);
+    slYawAttachment.reset (new SliderAttachment (valueTreeState, "yaw", slYaw));
+    slYaw.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
+    slYaw.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 50, 15);
+    slYaw.setReverse (true);
+    slYaw.setColour (juce::Slider::rotarySliderOutlineColourId, globalLaF.ClWidgetColours[0]);
+    slYaw.setRotaryParameters (juce::MathConstants<float>::pi, 3 * juce::MathConstants<float>::pi, false);
+    slYaw.setTooltip ("Yaw angle of the listener's head: rotation around z-axis");
+    slYaw.setTextValueSuffix (juce::CharPointer_UTF8 (R"(°)"));
+
+    addAndMakeVisible (&slPitch);
+    slPitchAttachment.reset (new SliderAttachment (valueTreeState, "pitch", slPitch));
+    slPitch.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
+    slPitch.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 50, 15);
+    slPitch.setReverse (true);
+    slPitch.setColour (juce::Slider::rotarySliderOutlineColourId, globalLaF.ClWidgetColours[1]);
+    slPitch.setRotaryParameters (0.5 * juce::MathConstants<float>::pi, 2.5 * juce::MathConstants<float>::pi, false);
+    slPitch.setTooltip ("Pitch angle of the listener's head: rotation around y-axis");
+    slPitch.setTextValueSuffix (juce::CharPointer_UTF8 (R"(°)"));
+
+    addAndMakeVisible (&slRoll);
+    slRollAttachment.reset (new SliderAttachment (valueTreeState, "roll", slRoll));
+    slRoll.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
+    slRoll.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 50, 15);
+    slRoll.setColour (juce::Slider::rotarySliderOutlineColourId, globalLaF.ClWidgetColours[2]);
+    slRoll.setReverse (false);
+    slRoll.setRotaryParameters (juce::MathConstants<float>::pi, 3 * juce::MathConstants<float>::pi, false);
+    slRoll.setTooltip ("Roll angle of the listener's head: rotation around x-axis");
+    slRoll.setTextValueSuffix (juce::CharPointer_UTF8 (R"(°)"));
+
+    addAndMakeVisible (&lbYaw);
+    lbYaw.setText ("Yaw");
+
+    addAndMakeVisible (&lbPitch);
+    lbPitch.setText ("Pitch");
+
+    addAndMakeVisible (&lbRoll);
+    lbRoll.setText ("Roll");
+
+    addAndMakeVisible (lbMidiScheme);
+    lbMidiScheme.setText ("MIDI Scheme");
+
+    addAndMakeVisible (cbMidiScheme);
+    cbMidiScheme.setJustificationType (juce::Justification::centred);
+    cbMidiScheme.addSectionHeading ("Select Device's MIDI Scheme");
+    cbMidiScheme.addItemList (processor.getMidiSchemes(), 1);
+    cbMidiScheme.setSelectedId (static_cast<int> (processor.getCurrentMidiScheme()) + 1, juce::dontSendNotification);
+    cbMidiScheme.setTooltip ("The head tracker's data is received via the plug-in's MIDI input.");
+    cbMidiScheme.onChange = [&] () { processor.setMidiScheme (BinauralDecoderAudioProcessor::MidiScheme (cbMidiScheme.getSelectedId() - 1)); };
+
 
 
     // start timer after everything is set up properly
@@ -94,6 +165,41 @@ void BinauralDecoderAudioProcessorEditor::resized()
     auto sliderRow = area.removeFromTop(20);
     lbEq.setBounds(sliderRow.removeFromLeft(150));
     cbEq.setBounds(sliderRow.removeFromLeft(120));
+
+    area.removeFromTop (10);
+    sliderRow = area.removeFromTop (20);
+    lbLowLatency.setBounds (sliderRow.removeFromLeft (150));
+    cbLowLatency.setBounds (sliderRow.removeFromLeft (120));
+
+    area.removeFromTop (10);
+    sliderRow = area.removeFromTop (20);
+    btLoadFilterSet.setBounds (sliderRow.removeFromLeft (90));
+    sliderRow.removeFromLeft (5);
+    btBuiltInFilterSet.setBounds (sliderRow.removeFromLeft (55));
+    sliderRow.removeFromLeft (5);
+    lbFilterSet.setBounds (sliderRow);
+
+    // head tracking
+    area.removeFromTop (15);
+    const int rotSliderWidth = 40;
+    const int rotSliderHeight = 55;
+    const int labelHeight = 15;
+
+    auto headTrackingArea = area.removeFromTop (rotSliderHeight + labelHeight);
+    auto sliderArea = headTrackingArea.removeFromLeft (3 * (rotSliderWidth + 5));
+    sliderRow = sliderArea.removeFromTop (rotSliderHeight);
+    slYaw.setBounds (sliderRow.removeFromLeft (rotSliderWidth + 5));
+    slPitch.setBounds (sliderRow.removeFromLeft (rotSliderWidth + 5));
+    slRoll.setBounds (sliderRow.removeFromLeft (rotSliderWidth + 5));
+    lbYaw.setBounds (sliderArea.removeFromLeft (rotSliderWidth + 5));
+    lbPitch.setBounds (sliderArea.removeFromLeft (rotSliderWidth + 5));
+    lbRoll.setBounds (sliderArea.removeFromLeft (rotSliderWidth + 5));
+
+    headTrackingArea.removeFromLeft (20);
+    headTrackingArea.removeFromTop (15);
+    lbMidiScheme.setBounds (headTrackingArea.removeFromTop (labelHeight).removeFromLeft (140));
+    headTrackingArea.removeFromTop (3);
+    cbMidiScheme.setBounds (headTrackingArea.removeFromTop (20).removeFromLeft (140));
 }
 
 void BinauralDecoderAudioProcessorEditor::timerCallback()
@@ -103,4 +209,27 @@ void BinauralDecoderAudioProcessorEditor::timerCallback()
     // ==========================================
 
     // insert stuff you want to do be done at every timer callback
+    const auto newFilterSetStatus = processor.getFilterSetStatus();
+    if (newFilterSetStatus != filterSetStatus)
+    {
+        filterSetStatus = newFilterSetStatus;
+        lbFilterSet.setText (filterSetStatus);
+    }
+
+    const int midiSchemeId = static_cast<int> (processor.getCurrentMidiScheme()) + 1;
+    if (cbMidiScheme.getSelectedId() != midiSchemeId)
+        cbMidiScheme.setSelectedId (midiSchemeId, juce::dontSendNotification);
+}
+
+void BinauralDecoderAudioProcessorEditor::loadFilterSetFile()
+{
+    juce::FileChooser myChooser ("Please select the SH-domain binaural filters you want to load...",
+                                 processor.getLastDir().exists() ? processor.getLastDir() : juce::File::getSpecialLocation (juce::File::userHomeDirectory),
+                                 "*.wav;*.aif;*.aiff;*.flac");
+    if (myChooser.browseForFileToOpen())
+    {
+        juce::File filterSetFile (myChooser.getResult());
+        processor.setLastDir (filterSetFile.getParentDirectory());
+        processor.loadFilterSet (filterSetFile);
+    }
 }
@@ -54,6 +54,8 @@ public:
 
     void timerCallback() override;
 
+    void loadFilterSetFile();
+
 private:
     // ====================== begin essentials ==================
     // lookAndFeel class with the IEM plug-in suite design
@@ -84,6 +86,22 @@ private:
     juce::ComboBox cbEq;
     std::unique_ptr<ComboBoxAttachment> cbEqAttachment;
 
+    SimpleLabel lbLowLatency;
+    juce::ComboBox cbLowLatency;
+    std::unique_ptr<ComboBoxAttachment> cbLowLatencyAttachment;
+
+    SimpleLabel lbFilterSet;
+    juce::String filterSetStatus;
+    juce::TextButton btLoadFilterSet, btBuiltInFilterSet;
+
+    // head tracking
+    ReverseSlider slYaw, slPitch, slRoll;
+    std::unique_ptr<SliderAttachment> slYawAttachment, slPitchAttachment, slRollAttachment;
+    SimpleLabel lbYaw, lbPitch, lbRoll;
+
+    SimpleLabel lbMidiScheme;
+    juce::ComboBox cbMidiScheme;
+
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BinauralDecoderAudioProcessorEditor)
 };
@@ -22,7 +22,6 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
-#include <IRData.h>
 #include <EQData.h>
 
 
@@ -47,38 +46,56 @@ createParameterLayout())
     inputOrderSetting = parameters.getRawParameterValue("inputOrderSetting");
     useSN3D = parameters.getRawParameterValue ("useSN3D");
     applyHeadphoneEq = parameters.getRawParameterValue("applyHeadphoneEq");
+    lowLatencyMode = parameters.getRawParameterValue ("lowLatencyMode");
+    yaw = parameters.getRawParameterValue ("yaw");
+    pitch = parameters.getRawParameterValue ("pitch");
+    roll = parameters.getRawParameterValue ("roll");
+    qw = parameters.getRawParameterValue ("qw");
+    qx = parameters.getRawParameterValue ("qx");
+    qy = parameters.getRawParameterValue ("qy");
+    qz = parameters.getRawParameterValue ("qz");
+    invertYaw = parameters.getRawParameterValue ("invertYaw");
+    invertPitch = parameters.getRawParameterValue ("invertPitch");
+    invertRoll = parameters.getRawParameterValue ("invertRoll");
+    invertQuaternion = parameters.getRawParameterValue ("invertQuaternion");
+    rotationSequence = parameters.getRawParameterValue ("rotationSequence");
 
     // add listeners to parameter changes
     parameters.addParameterListener ("inputOrderSetting", this);
     parameters.addParameterListener ("applyHeadphoneEq", this);
-
-
-    // load IRs
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-    juce::WavAudioFormat wavFormat;
-
-    juce::MemoryInputStream* mis[7];
-    mis[0] = new juce::MemoryInputStream (IRData::irsOrd1_wav, IRData::irsOrd1_wavSize, false);
-    mis[1] = new juce::MemoryInputStream (IRData::irsOrd2_wav, IRData::irsOrd2_wavSize, false);
-    mis[2] = new juce::MemoryInputStream (IRData::irsOrd3_wav, IRData::irsOrd3_wavSize, false);
-    mis[3] = new juce::MemoryInputStream (IRData::irsOrd4_wav, IRData::irsOrd4_wavSize, false);
-    mis[4] = new juce::MemoryInputStream (IRData::irsOrd5_wav, IRData::irsOrd5_wavSize, false);
-    mis[5] = new juce::MemoryInputStream (IRData::irsOrd6_wav, IRData::irsOrd6_wavSize, false);
-    mis[6] = new juce::MemoryInputStream (IRData::irsOrd7_wav, IRData::irsOrd7_wavSize, false);
-
-    for (int i = 0; i < 7; ++i)
-    {
-        irs[i].setSize(juce::square(i + 2), irLength);
-        std::unique_ptr<juce::AudioFormatReader> reader (wavFormat.createReaderFor (mis[i], true));
-        reader->read(&irs[i], 0, irLength, 0, true, false);
-        irs[i].applyGain (0.3f);
-    }
+    parameters.addParameterListener ("lowLatencyMode", this);
+
+    parameters.addParameterListener ("yaw", this);
+    parameters.addParameterListener ("pitch", this);
+    parameters.addParameterListener ("roll", this);
+    parameters.addParameterListener ("qw", this);
+    parameters.addParameterListener ("qx", this);
+    parameters.addParameterListener ("qy", this);
+    parameters.addParameterListener ("qz", this);
+    parameters.addParameterListener ("invertYaw", this);
+    parameters.addParameterListener ("invertPitch", this);
+    parameters.addParameterListener ("invertRoll", this);
+    parameters.addParameterListener ("invertQuaternion", this);
+    parameters.addParameterListener ("rotationSequence", this);
+
+
+    // global settings for all plug-in instances
+    juce::PropertiesFile::Options options;
+    options.applicationName     = "BinauralDecoder";
+    options.filenameSuffix      = "settings";
+    options.folderName          = "IEM";
+    options.osxLibrarySubFolder = "Preferences";
+
+    properties.reset (new juce::PropertiesFile (options));
+    lastDir = juce::File (properties->getValue ("filterSetFolder"));
+
+    startBackgroundReconfiguration();
 }
 
 BinauralDecoderAudioProcessor::~BinauralDecoderAudioProcessor()
 {
-
+    stopBackgroundReconfiguration();
+    cancelPendingUpdate();
 }
 
 
@@ -109,7 +126,13 @@ void BinauralDecoderAudioProcessor::changeProgramName (int index, const juce::St
 //==============================================================================
 void BinauralDecoderAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+    isPreparing = true; // we can wait for the filters here
     checkInputAndOutput(this, *inputOrderSetting, 0, true);
+    isPreparing = false;
+    handleUpdateNowIfNeeded(); // the host gets the latency before playback starts
+
+    rotationBuffer.setSize (rotationBuffer.getNumChannels(), samplesPerBlock);
+    rotationParamsHaveChanged = true;
 
     juce::dsp::ProcessSpec convSpec;
     convSpec.sampleRate = sampleRate;
@@ -127,7 +150,13 @@ void BinauralDecoderAudioProcessor::releaseResources()
 
 void BinauralDecoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    checkInputAndOutput(this, *inputOrderSetting, 0, false);
+    if (waitingForFilterSet && activeFilterSetRequest->isReady())
+    {
+        waitingForFilterSet = false;
+        requestReconfiguration();
+    }
+
+    checkInputAndOutput(this, *inputOrderSetting, 0);
     juce::ScopedNoDenormals noDenormals;
 
     if (buffer.getNumChannels() < 2)
@@ -138,90 +167,55 @@ void BinauralDecoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
 
     const int nCh = juce::jmin (buffer.getNumChannels(), input.getNumberOfChannels());
     const int L = buffer.getNumSamples();
-    const int ergL = overlapBuffer.getNumSamples();
-    const int overlap = irLengthMinusOne;
-    const int copyL = juce::jmin (L, overlap); // copy max L samples of the overlap data
 
     if (*useSN3D >= 0.5f)
         for (int ch = 1; ch < nCh; ++ch)
             buffer.applyGain(ch, 0, buffer.getNumSamples(), sn3d2n3d[ch]);
 
-    // clear accumulation buffers
-    juce::FloatVectorOperations::clear (reinterpret_cast<float*> (accumMid.data()), fftLength + 2);
-    juce::FloatVectorOperations::clear (reinterpret_cast<float*> (accumSide.data()), fftLength + 2);
+    midiParser.processMidiMessages (midiMessages, currentMidiScheme);
 
-    const int nZeros = fftLength - L;
-
-    //compute mid signal in frequency domain
-    for (int midix = 0; midix < nMidCh; ++midix)
+    // head tracking: the SH channels are rotated into the rotationBuffer, which is then convolved
+    bool newRotationMatrix = false;
+    if (rotationParamsHaveChanged.get())
     {
-        const int ch = mix2cix[midix];
-
-        juce::FloatVectorOperations::copy (reinterpret_cast<float*> (fftBuffer.data()), buffer.getReadPointer (ch), L);
-        juce::FloatVectorOperations::clear (reinterpret_cast<float*> (fftBuffer.data()) + L, nZeros);
-
-        fft->performRealOnlyForwardTransform (reinterpret_cast<float*> (fftBuffer.data()));
-
-        const auto tfMid = reinterpret_cast<const std::complex<float>*> (irsFrequencyDomain.getReadPointer (ch));
-        for (int i = 0; i < fftLength / 2 + 1; ++i)
-            accumMid[i] += fftBuffer[i] * tfMid[i];
+        newRotationMatrix = true;
+        calcRotationMatrix (rotationOrder);
     }
 
-    //compute side signal in frequency domain
-    for (int sidix = 0; sidix < nSideCh; ++sidix)
-    {
-        const int ch = six2cix[sidix];
-
-        juce::FloatVectorOperations::copy (reinterpret_cast<float*> (fftBuffer.data()), buffer.getReadPointer (ch), L);
-        juce::FloatVectorOperations::clear (reinterpret_cast<float*> (fftBuffer.data()) + L, nZeros);
+    // the rotationBuffer is only resized off the audio thread, so blocks exceeding it are rotated and convolved in parts
+    const bool rotate = (newRotationMatrix || ! rotationIsIdentity) && rotationBuffer.getNumSamples() > 0;
+    const int maxPartLength = rotate ? rotationBuffer.getNumSamples() : L;
+    const int nBufferCh = juce::jmin (buffer.getNumChannels(), numberOfInputChannels);
 
-        fft->performRealOnlyForwardTransform (reinterpret_cast<float*> (fftBuffer.data()));
+    for (int start = 0; start < L; start += maxPartLength)
+    {
+        const int partLength = juce::jmin (maxPartLength, L - start);
 
-        const auto tfSide = reinterpret_cast<const std::complex<float>*> (irsFrequencyDomain.getReadPointer (ch));
-        for (int i = 0; i < fftLength / 2 + 1; ++i)
-            accumSide[i] += fftBuffer[i] * tfSide[i];
-    }
+        const float* shChannels[numberOfInputChannels];
+        for (int ch = 0; ch < nBufferCh; ++ch)
+            shChannels[ch] = buffer.getReadPointer (ch, start);
 
+        if (rotate)
+        {
+            rotation.process (shChannels, rotationBuffer.getArrayOfWritePointers(), rotationOrder, partLength);
+            for (int ch = 0; ch < rotationBuffer.getNumChannels(); ++ch)
+                shChannels[ch] = rotationBuffer.getReadPointer (ch);
+        }
 
-    fft->performRealOnlyInverseTransform (reinterpret_cast<float*> (accumMid.data()));
-    fft->performRealOnlyInverseTransform (reinterpret_cast<float*> (accumSide.data()));
+        // mid channels are convolved into channel 0, side channels into channel 1
+        for (int midix = 0; midix < nMidCh; ++midix)
+            convolutionInputs[midix] = shChannels[mix2cix[midix]];
+        for (int sidix = 0; sidix < nSideCh; ++sidix)
+            convolutionInputs[nMidCh + sidix] = shChannels[six2cix[sidix]];
 
+        float* convolutionOutputs[2] = {buffer.getWritePointer (0, start), buffer.getWritePointer (1, start)};
+        convolution->process (convolutionInputs.data(), convolutionOutputs, partLength);
+    }
 
     ///* MS -> LR  */
-    juce::FloatVectorOperations::copy (buffer.getWritePointer (0), reinterpret_cast<float*> (accumMid.data()), L);
-    juce::FloatVectorOperations::copy (buffer.getWritePointer (1), reinterpret_cast<float*> (accumMid.data()), L);
-    juce::FloatVectorOperations::add (buffer.getWritePointer(0), reinterpret_cast<float*> (accumSide.data()), L);
-    juce::FloatVectorOperations::subtract(buffer.getWritePointer(1), reinterpret_cast<float*> (accumSide.data()), L);
-
-    juce::FloatVectorOperations::add (buffer.getWritePointer(0), overlapBuffer.getWritePointer(0), copyL);
-    juce::FloatVectorOperations::add (buffer.getWritePointer(1), overlapBuffer.getWritePointer(1), copyL);
-
-    if (copyL < overlap) // there is some overlap left, want some?
-    {
-        const int howManyAreLeft = overlap - L;
-
-        //shift the overlap buffer to the left
-        juce::FloatVectorOperations::copy (overlapBuffer.getWritePointer (0), overlapBuffer.getReadPointer (0, L), howManyAreLeft);
-        juce::FloatVectorOperations::copy (overlapBuffer.getWritePointer (1), overlapBuffer.getReadPointer (1, L), howManyAreLeft);
-
-        //clear the tail
-        juce::FloatVectorOperations::clear (overlapBuffer.getWritePointer (0, howManyAreLeft), ergL - howManyAreLeft);
-        juce::FloatVectorOperations::clear (overlapBuffer.getWritePointer (1, howManyAreLeft), ergL - howManyAreLeft);
-
-        /* MS -> LR  */
-        juce::FloatVectorOperations::add (overlapBuffer.getWritePointer (0), reinterpret_cast<float*> (accumMid.data()) + L, irLengthMinusOne);
-        juce::FloatVectorOperations::add (overlapBuffer.getWritePointer (1), reinterpret_cast<float*> (accumMid.data()) + L, irLengthMinusOne);
-        juce::FloatVectorOperations::add (overlapBuffer.getWritePointer (0), reinterpret_cast<float*> (accumSide.data()) + L, irLengthMinusOne);
-        juce::FloatVectorOperations::subtract (overlapBuffer.getWritePointer (1), reinterpret_cast<float*> (accumSide.data()) + L, irLengthMinusOne);
-    }
-    else
-    {
-        /* MS -> LR  */
-        juce::FloatVectorOperations::copy (overlapBuffer.getWritePointer (0), reinterpret_cast<float*> (accumMid.data()) + L, irLengthMinusOne);
-        juce::FloatVectorOperations::copy (overlapBuffer.getWritePointer (1), reinterpret_cast<float*> (accumMid.data()) + L, irLengthMinusOne);
-        juce::FloatVectorOperations::add (overlapBuffer.getWritePointer (0), reinterpret_cast<float*> (accumSide.data()) + L, irLengthMinusOne);
-        juce::FloatVectorOperations::subtract (overlapBuffer.getWritePointer (1), reinterpret_cast<float*> (accumSide.data()) + L, irLengthMinusOne);
-    }
+    juce::FloatVectorOperations::add (buffer.getWritePointer (0), buffer.getReadPointer (1), L);
+    juce::FloatVectorOperations::multiply (buffer.getWritePointer (1), -2.0f, L);
+    juce::FloatVectorOperations::add (buffer.getWritePointer (1), buffer.getReadPointer (0), L);
 
     if (*applyHeadphoneEq >= 0.5f)
     {
@@ -233,6 +227,8 @@ void BinauralDecoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
 
     for (int ch = 2; ch < buffer.getNumChannels(); ++ch)
         buffer.clear(ch, 0, buffer.getNumSamples());
+
+    midiMessages.clear();
 }
 
 //==============================================================================
@@ -251,6 +247,9 @@ void BinauralDecoderAudioProcessor::getStateInformation (juce::MemoryBlock& dest
 {
     auto state = parameters.copyState();
 
+    state.setProperty ("filterSetFile", juce::var (getFilterSetFile().getFullPathName()), nullptr);
+    state.setProperty ("MidiDeviceScheme", juce::var (static_cast<int> (currentMidiScheme)), nullptr);
+
     auto oscConfig = state.getOrCreateChildWithName ("OSCConfig", nullptr);
     oscConfig.copyPropertiesFrom (oscParameterInterface.getConfig(), nullptr);
 
@@ -266,6 +265,13 @@ void BinauralDecoderAudioProcessor::setStateInformation (const void* data, int s
         if (xmlState->hasTagName (parameters.state.getType()))
         {
             parameters.replaceState (juce::ValueTree::fromXml (*xmlState));
+
+            const juce::String filterSetPath = parameters.state.getProperty ("filterSetFile", juce::String());
+            loadFilterSet (filterSetPath.isEmpty() ? juce::File() : juce::File (filterSetPath));
+
+            if (parameters.state.hasProperty ("MidiDeviceScheme"))
+                setMidiScheme (MidiScheme (static_cast<int> (parameters.state.getProperty ("MidiDeviceScheme", juce::var (0)))));
+
             if (parameters.state.hasProperty ("OSCPort")) // legacy
             {
                 oscParameterInterface.getOSCReceiver().connect (parameters.state.getProperty ("OSCPort", juce::var (-1)));
@@ -276,13 +282,43 @@ void BinauralDecoderAudioProcessor::setStateInformation (const void* data, int s
             if (oscConfig.isValid())
                 oscParameterInterface.setConfig (oscConfig);
         }
+
+    usingYpr = true;
 }
 
 //==============================================================================
 void BinauralDecoderAudioProcessor::parameterChanged (const juce::String &parameterID, float newValue)
 {
-    if (parameterID == "inputOrderSetting")
+    if (! updatingParams.get())
+    {
+        if (parameterID == "qw" || parameterID == "qx" || parameterID == "qy" || parameterID == "qz")
+        {
+            usingYpr = false;
+            updateEuler();
+            rotationParamsHaveChanged = true;
+        }
+        else if (parameterID == "yaw" || parameterID == "pitch" || parameterID == "roll")
+        {
+            usingYpr = true;
+            updateQuaternions();
+            rotationParamsHaveChanged = true;
+        }
+    }
+
+    if (parameterID == "invertYaw" || parameterID == "invertPitch" || parameterID == "invertRoll" || parameterID == "invertQuaternion"
+        || parameterID == "rotationSequence")
+    {
+        if (usingYpr.get())
+            updateQuaternions();
+        else
+            updateEuler();
+
+        rotationParamsHaveChanged = true;
+    }
+    else if (parameterID == "inputOrderSetting")
         userChangedIOSettings = true;
+    else if (parameterID == "lowLatencyMode")
+        requestReconfiguration();
     else if (parameterID == "applyHeadphoneEq")
     {
         const int sel (juce::roundToInt (newValue));
@@ -303,16 +339,15 @@ void BinauralDecoderAudioProcessor::parameterChanged (const juce::String &parame
     }
 }
 
-void BinauralDecoderAudioProcessor::updateBuffers()
+std::unique_ptr<IOConfiguration> BinauralDecoderAudioProcessor::prepareConfiguration (const IOTypes::Ambisonics<>& newInput, const IOTypes::AudioChannels<2>& newOutput)
 {
-    DBG("IOHelper:  input size: " << input.getSize());
-    DBG("IOHelper: output size: " << output.getSize());
+    juce::ignoreUnused (newOutput);
+    DBG("IOHelper:  input size: " << newInput.getSize());
 
     const double sampleRate = getSampleRate();
-    const int blockSize = getBlockSize();
 
-    int order = juce::jmax (input.getOrder(), 1);
-    const int nCh = input.getNumberOfChannels(); // why not juce::jmin(buffer.....)? Is updateBuffers called before the first processBlock?
+    int order = juce::jmax (newInput.getOrder(), 1);
+    const int nCh = newInput.getNumberOfChannels();
     DBG("order: " << order);
     DBG("nCh: " << nCh);
 
@@ -321,77 +356,291 @@ void BinauralDecoderAudioProcessor::updateBuffers()
         order = tmpOrder;
     }
 
+    auto setup = std::make_unique<ConvolutionSetup>();
+
     //get number of mid- and side-channels
-    nSideCh = order * (order + 1) / 2;
-    nMidCh = juce::square (order + 1) - nSideCh;   //nMidCh = nCh - nSideCh; //nCh should be equalt to (order+1)^2
+    setup->nSideCh = order * (order + 1) / 2;
+    setup->nMidCh = juce::square (order + 1) - setup->nSideCh;   //nMidCh = nCh - nSideCh; //nCh should be equalt to (order+1)^2
+    const int nConvolutionInputs = setup->nMidCh + setup->nSideCh;
+
+    setup->rotationOrder = juce::jmax (order, 0);
+    setup->rotationBuffer.setSize (nCh, getBlockSize());
 
     if (order < 1)
         order = 1; // just use first order filters
 
-    juce::AudioBuffer<float> resampledIRs;
-    bool useResampled = false;
-    irLength = 236;
-
-    if (sampleRate != irsSampleRate && order != 0) // do resampling!
+    // the filters are resampled and transformed in the background
+    juce::File source;
     {
-        useResampled = true;
-        double factorReading = irsSampleRate / sampleRate;
-        irLength = juce::roundToInt (irLength / factorReading + 0.49);
+        const juce::ScopedLock lock (filterSetLock);
+        source = filterSetFile;
 
-        juce::MemoryAudioSource memorySource (irs[order - 1], false);
-        juce::ResamplingAudioSource resamplingSource (&memorySource, false, nCh);
+        if (filterSetRequest == nullptr || ! filterSetRequest->matches (source, order, sampleRate, partitionSize))
+            filterSetRequest = filterSetCache->requestFilterSet (source, order, sampleRate, partitionSize);
 
-        resamplingSource.setResamplingRatio (factorReading);
-        resamplingSource.prepareToPlay (irLength, sampleRate);
+        setup->filterSetRequest = filterSetRequest;
+    }
 
-        resampledIRs.setSize(nCh, irLength);
-        juce::AudioSourceChannelInfo info;
-        info.startSample = 0;
-        info.numSamples = irLength;
-        info.buffer = &resampledIRs;
+    // prepareToPlay waits briefly, e.g. for the built-in filters, slower ones are swapped in once they're ready
+    auto& request = *setup->filterSetRequest;
+    if (isPreparing && ! request.waitUntilReady (100))
+        DBG ("Filter set isn't ready yet, starting without it.");
 
-        resamplingSource.getNextAudioBlock (info);
+    auto* filterSet = request.getFilterSet();
+    setup->waitingForFilterSet = ! request.isReady();
 
-        // compensate for more (correlated) samples contributing to output signal
-        resampledIRs.applyGain (irsSampleRate / sampleRate);
-    }
+    // the partition size doesn't depend on the host's block size, so the CPU load per sample stays the same
+    const bool zeroLatency = *lowLatencyMode >= 0.5f;
+    setup->convolution = std::make_unique<PartitionedConvolution>();
+    setup->convolution->prepare (partitionSize, nConvolutionInputs, 2, filterSet != nullptr ? filterSet->getImpulseResponseLength() : 1, zeroLatency);
+    setup->convolutionInputs.resize (nConvolutionInputs);
 
-    irLengthMinusOne = irLength - 1;
+    if (filterSet != nullptr)
+    {
+        // filter sets with a lower order than the input leave the higher channels unused
+        for (int midix = 0; midix < setup->nMidCh; ++midix)
+            if (mix2cix[midix] < filterSet->getNumChannels())
+                setup->convolution->setImpulseResponseSpectra (midix, 0, filterSet->getSpectra (mix2cix[midix]), filterSet->getNumPartitions());
+
+        for (int sidix = 0; sidix < setup->nSideCh; ++sidix)
+            if (six2cix[sidix] < filterSet->getNumChannels())
+                setup->convolution->setImpulseResponseSpectra (setup->nMidCh + sidix, 1, filterSet->getSpectra (six2cix[sidix]), filterSet->getNumPartitions());
+    }
+    else if (request.isReady() && source != juce::File())
+    {
+        // loading the file failed, fall back to the built-in filters
+        const juce::ScopedLock lock (filterSetLock);
+        filterSetError = request.getErrorMessage();
+        filterSetFile = juce::File();
+        requestReconfiguration();
+    }
 
-    const int prevFftLength = fftLength;
+    return setup;
+}
 
-    const int ergL = blockSize + irLength - 1; //max number of nonzero output samples
-    fftLength = juce::nextPowerOfTwo (ergL);          //fftLength >= ergL
+void BinauralDecoderAudioProcessor::applyConfiguration (IOConfiguration& newConfiguration)
+{
+    auto& setup = static_cast<ConvolutionSetup&> (newConfiguration);
+
+    // swapping doesn't (de)allocate, the old convolution and buffers are released with the configuration
+    std::swap (convolution, setup.convolution);
+    std::swap (convolutionInputs, setup.convolutionInputs);
+    std::swap (rotationBuffer, setup.rotationBuffer);
+    std::swap (activeFilterSetRequest, setup.filterSetRequest);
+
+    nMidCh = setup.nMidCh;
+    nSideCh = setup.nSideCh;
+    rotationOrder = setup.rotationOrder;
+    rotationParamsHaveChanged = true; // the matrices of higher orders might not have been calculated yet
+    waitingForFilterSet = setup.waitingForFilterSet;
+
+    // this might be the audio thread, the host is told about the latency from the message thread
+    convolutionLatency = convolution->getLatencyInSamples();
+    triggerAsyncUpdate();
+}
 
-    overlapBuffer.setSize(2, irLengthMinusOne);
-    overlapBuffer.clear();
+void BinauralDecoderAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples (convolutionLatency.load());
+}
 
-    if (prevFftLength != fftLength)
+void BinauralDecoderAudioProcessor::loadFilterSet (const juce::File& fileToLoad)
+{
     {
-        const int fftOrder = std::log2 (fftLength);
+        const juce::ScopedLock lock (filterSetLock);
+        filterSetFile = fileToLoad;
+        filterSetError.clear();
+    }
+    requestReconfiguration();
+}
 
-        fft = std::make_unique<juce::dsp::FFT> (fftOrder);
+juce::File BinauralDecoderAudioProcessor::getFilterSetFile()
+{
+    const juce::ScopedLock lock (filterSetLock);
+    return filterSetFile;
+}
+
+juce::String BinauralDecoderAudioProcessor::getFilterSetStatus()
+{
+    const juce::ScopedLock lock (filterSetLock);
+
+    if (filterSetError.isNotEmpty())
+        return filterSetError;
+
+    if (filterSetRequest != nullptr && filterSetRequest->source == filterSetFile)
+        if (auto* filterSet = filterSetRequest->getFilterSet())
+            return filterSet->getName();
+
+    return "Preparing filters...";
+}
+
+void BinauralDecoderAudioProcessor::setLastDir (juce::File newLastDir)
+{
+    lastDir = newLastDir;
+    const juce::var v (lastDir.getFullPathName());
+    properties->setValue ("filterSetFolder", v);
+}
 
-        fftBuffer.resize (fftLength);
 
-        accumMid.resize (fftLength);
-        accumSide.resize (fftLength);
+
+//==============================================================================
+void BinauralDecoderAudioProcessor::calcRotationMatrix (const int order)
+{
+    const auto yawRadians = Conversions<float>::degreesToRadians (*yaw) * (*invertYaw > 0.5 ? -1 : 1);
+    const auto pitchRadians = Conversions<float>::degreesToRadians (*pitch) * (*invertPitch > 0.5 ? -1 : 1);
+    const auto rollRadians = Conversions<float>::degreesToRadians (*roll) * (*invertRoll > 0.5 ? -1 : 1);
+
+    rotation.calcRotationMatrix (AmbisonicRotation::getCartesianRotationMatrix (yawRadians, pitchRadians, rollRadians, *rotationSequence >= 0.5f), order);
+    rotationIsIdentity = yawRadians == 0.0f && pitchRadians == 0.0f && rollRadians == 0.0f;
+
+    rotationParamsHaveChanged = false;
+}
+
+inline void BinauralDecoderAudioProcessor::updateQuaternions()
+{
+    const float wa = cos (Conversions<float>::degreesToRadians (*yaw) * 0.5f);
+    const float za = sin (Conversions<float>::degreesToRadians (*yaw) * (*invertYaw >= 0.5 ? -0.5f : 0.5f));
+    const float wb = cos (Conversions<float>::degreesToRadians (*pitch) * 0.5f);
+    const float yb = sin (Conversions<float>::degreesToRadians (*pitch) * (*invertPitch >= 0.5 ? -0.5f : 0.5f));
+    const float wc = cos (Conversions<float>::degreesToRadians (*roll) * 0.5f);
+    const float xc = sin (Conversions<float>::degreesToRadians (*roll) * (*invertRoll >= 0.5 ? -0.5f : 0.5f));
+
+    float qw, qx, qy, qz;
+
+    if (*rotationSequence >= 0.5f) // roll -> pitch -> yaw (extrinsic rotations)
+    {
+        qw = wa * wc * wb + za * xc * yb;
+        qx = wa * xc * wb - za * wc * yb;
+        qy = wa * wc * yb + za * xc * wb;
+        qz = za * wc * wb - wa * xc * yb;
+    }
+    else // yaw -> pitch -> roll (extrinsic rotations)
+    {
+        qw = wc * wb * wa - xc * yb * za;
+        qx = wc * yb * za + xc * wb * wa;
+        qy = wc * yb * wa - xc * wb * za;
+        qz = wc * wb * za + xc * yb * wa;
+    }
+
+    if (*invertQuaternion >= 0.5f)
+    {
+        qx = -qx;
+        qy = -qy;
+        qz = -qz;
     }
 
-    irsFrequencyDomain.setSize (nCh, 2 * (fftLength / 2 + 1));
-    irsFrequencyDomain.clear();
 
-    for (int i = 0; i < nCh; ++i)
+    updatingParams = true;
+    parameters.getParameter ("qw")->setValueNotifyingHost (parameters.getParameterRange ("qw").convertTo0to1 (qw));
+    parameters.getParameter ("qx")->setValueNotifyingHost (parameters.getParameterRange ("qx").convertTo0to1 (qx));
+    parameters.getParameter ("qy")->setValueNotifyingHost (parameters.getParameterRange ("qy").convertTo0to1 (qy));
+    parameters.getParameter ("qz")->setValueNotifyingHost (parameters.getParameterRange ("qz").convertTo0to1 (qz));
+    updatingParams = false;
+}
+
+inline void BinauralDecoderAudioProcessor::updateEuler()
+{
+    float ypr[3];
+    auto quaternionDirection = iem::Quaternion<float> (*qw, *qx, *qy, *qz);
+    quaternionDirection.normalize();
+
+    if (*invertQuaternion >= 0.5f)
+        quaternionDirection = quaternionDirection.getConjugate();
+
+    const float p0 = quaternionDirection.w;
+    const float p1 = quaternionDirection.z;
+    const float p2 = quaternionDirection.y;
+    const float p3 = quaternionDirection.x;
+
+    float e;
+
+    if (*rotationSequence >= 0.5f) // roll -> pitch -> yaw (extrinsic rotations)
+        e = -1.0f;
+    else // yaw -> pitch -> roll (extrinsic rotations)
+        e = 1.0f;
+
+    // pitch (y-axis rotation)
+    float t0 = 2.0f * (p0 * p2 + e * p1 * p3);
+    t0 = juce::jlimit (-1.0f, 1.0f, t0);
+    ypr[1] = asin (t0);
+
+    if (ypr[1] == juce::MathConstants<float>::pi || ypr[1] == - juce::MathConstants<float>::pi)
     {
-        float* inOut = reinterpret_cast<float*> (fftBuffer.data());
-        const float* src = useResampled ? resampledIRs.getReadPointer(i) : irs[order - 1].getReadPointer(i);
-        juce::FloatVectorOperations::copy (inOut, src, irLength);
-        juce::FloatVectorOperations::clear (inOut + irLength, fftLength - irLength); // zero padding
-        fft->performRealOnlyForwardTransform (inOut);
-        juce::FloatVectorOperations::copy (irsFrequencyDomain.getWritePointer (i), inOut, 2 * (fftLength / 2 + 1));
+        ypr[2] = 0.0f;
+        ypr[0] = atan2 (p1, p0);
     }
+    else
+    {
+        // yaw (z-axis rotation)
+        t0 = 2.0f * (p0 * p1 - e * p2 * p3);
+        float t1 = 1.0f - 2.0f * (p1 * p1 + p2 * p2);
+        ypr[0] = atan2 (t0, t1);
+
+        // roll (x-axis rotation)
+        t0 = 2.0f * (p0 * p3 - e * p1 * p2);
+        t1 = 1.0f - 2.0f * (p2 * p2 + p3 * p3);
+        ypr[2] = atan2 (t0, t1);
+    }
+
+    if (*invertYaw >= 0.5)
+        ypr[0] *= -1.0f;
+    if (*invertPitch >= 0.5)
+        ypr[1] *= -1.0f;
+    if (*invertRoll >= 0.5)
+        ypr[2] *= -1.0f;
+
+    //updating not active params
+    updatingParams = true;
+    parameters.getParameter ("yaw")->setValueNotifyingHost (parameters.getParameterRange ("yaw").convertTo0to1 (Conversions<float>::radiansToDegrees (ypr[0])));
+    parameters.getParameter ("pitch")->setValueNotifyingHost (parameters.getParameterRange ("pitch").convertTo0to1 (Conversions<float>::radiansToDegrees (ypr[1])));
+    parameters.getParameter ("roll")->setValueNotifyingHost (parameters.getParameterRange ("roll").convertTo0to1 (Conversions<float>::radiansToDegrees (ypr[2])));
+    updatingParams = false;
+}
+
+void BinauralDecoderAudioProcessor::setMidiScheme (MidiScheme newMidiScheme)
+{
+    currentMidiScheme = newMidiScheme;
+
+    // MrHeadTracker sends its angles in roll -> pitch -> yaw order
+    if (newMidiScheme == MidiScheme::mrHeadTrackerYprDir || newMidiScheme == MidiScheme::mrHeadTrackerYprInv)
+        parameters.getParameter ("rotationSequence")->setValueNotifyingHost (1.0f);
 }
 
+//==============================================================================
+const bool BinauralDecoderAudioProcessor::interceptOSCMessage (juce::OSCMessage &message)
+{
+    if (message.getAddressPattern().toString().equalsIgnoreCase ("/" + juce::String (JucePlugin_Name) + "/quaternions") && message.size() == 4)
+    {
+        float qs[4];
+        for (int i = 0; i < 4; ++i)
+            if (message[i].isFloat32())
+                qs[i] = message[i].getFloat32();
+            else if (message[i].isInt32())
+                qs[i] = message[i].getInt32();
+
+        oscParameterInterface.setValue ("qw", qs[0]);
+        oscParameterInterface.setValue ("qx", qs[1]);
+        oscParameterInterface.setValue ("qy", qs[2]);
+        oscParameterInterface.setValue ("qz", qs[3]);
+        return true;
+    }
+    else if (message.getAddressPattern().toString().equalsIgnoreCase ("/" + juce::String (JucePlugin_Name) + "/ypr") && message.size() == 3)
+    {
+        float ypr[3];
+        for (int i = 0; i < 3; ++i)
+            if (message[i].isFloat32())
+                ypr[i] = message[i].getFloat32();
+            else if (message[i].isInt32())
+                ypr[i] = message[i].getInt32();
+
+        oscParameterInterface.setValue ("yaw", ypr[0]);
+        oscParameterInterface.setValue ("pitch", ypr[1]);
+        oscParameterInterface.setValue ("roll", ypr[2]);
+        return true;
+    }
+
+    return false;
+}
 
 //==============================================================================
 std::vector<std::unique_ptr<juce::RangedAudioParameter>> BinauralDecoderAudioProcessor::createParameterLayout()
@@ -427,6 +676,61 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>> BinauralDecoderAudioPro
                                                            else return juce::String (this->headphoneEQs[juce::roundToInt (value) - 1]);
                                                        }, nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("lowLatencyMode", "Low Latency Mode", "",
+                                                       juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f), 1.0f,
+                                                       [](float value) {
+                                                           if (value >= 0.5f) return "ON";
+                                                           else return "OFF";
+                                                       }, nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("yaw", "Yaw Angle", juce::CharPointer_UTF8 (R"(°)"),
+                                                       juce::NormalisableRange<float> (-180.0f, 180.0f, 0.01f), 0.0,
+                                                       [](float value) { return juce::String(value, 2); }, nullptr, true));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("pitch", "Pitch Angle", juce::CharPointer_UTF8 (R"(°)"),
+                                                       juce::NormalisableRange<float> (-180.0f, 180.0f, 0.01f), 0.0,
+                                                       [](float value) { return juce::String(value, 2); }, nullptr, true));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("roll", "Roll Angle", juce::CharPointer_UTF8 (R"(°)"),
+                                                       juce::NormalisableRange<float> (-180.0f, 180.0f, 0.01f), 0.0,
+                                                       [](float value) { return juce::String(value, 2); }, nullptr, true));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("qw", "Quaternion W", "",
+                                                       juce::NormalisableRange<float> (-1.0f, 1.0f, 0.001f), 1.0,
+                                                       [](float value) { return juce::String(value, 2); }, nullptr, true));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("qx", "Quaternion X", "",
+                                                       juce::NormalisableRange<float> (-1.0f, 1.0f, 0.001f), 0.0,
+                                                       [](float value) { return juce::String(value, 2); }, nullptr, true));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("qy", "Quaternion Y", "",
+                                                       juce::NormalisableRange<float> (-1.0f, 1.0f, 0.001f), 0.0,
+                                                       [](float value) { return juce::String(value, 2); }, nullptr, true));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("qz", "Quaternion Z", "",
+                                                       juce::NormalisableRange<float> (-1.0f, 1.0f, 0.001f), 0.0,
+                                                       [](float value) { return juce::String(value, 2); }, nullptr, true));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("invertYaw", "Invert Yaw", "",
+                                                       juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f), 0.0,
+                                                       [](float value) { return value >= 0.5f ? "ON" : "OFF"; }, nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("invertPitch", "Invert Pitch", "",
+                                                       juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f), 0.0,
+                                                       [](float value) { return value >= 0.5f ? "ON" : "OFF"; }, nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("invertRoll", "Invert Roll", "",
+                                                       juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f), 0.0,
+                                                       [](float value) { return value >= 0.5f ? "ON" : "OFF"; }, nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("invertQuaternion", "Invert Quaternion", "",
+                                                       juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f), 0.0,
+                                                       [](float value) { return value >= 0.5f ? "ON" : "OFF"; }, nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("rotationSequence", "Sequence of Rotations", "",
+                                                       juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f), 1.0,
+                                                       [](float value) { return value >= 0.5f ? "Roll->Pitch->Yaw" : "Yaw->Pitch->Roll"; }, nullptr));
+
     return params;
 }
 
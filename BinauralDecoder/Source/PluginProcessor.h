@@ -24,10 +24,17 @@
 
 #include <JuceHeader.h>
 #include "../../resources/AudioProcessorBase.h"
+#include "../../resources/PartitionedConvolution.h"
+#include "BinauralFilterSets.h"
+#include "../../resources/Conversions.h"
+#include "../../resources/Quaternion.h"
+#include "../../resources/AmbisonicRotation.h"
+#include "../../resources/MrHeadTrackerMidiParser.h"
 
 #define ProcessorClass BinauralDecoderAudioProcessor
 
-class BinauralDecoderAudioProcessor  :  public AudioProcessorBase<IOTypes::Ambisonics<>, IOTypes::AudioChannels<2>>
+class BinauralDecoderAudioProcessor  :  public AudioProcessorBase<IOTypes::Ambisonics<>, IOTypes::AudioChannels<2>>,
+                                        private juce::AsyncUpdater
 {
 public:
     constexpr static int numberOfInputChannels = 64;
@@ -61,39 +68,119 @@ public:
 
     //==============================================================================
     void parameterChanged (const juce::String &parameterID, float newValue) override;
-    void updateBuffers() override; // use this to implement a buffer update method
+    std::unique_ptr<IOConfiguration> prepareConfiguration (const IOTypes::Ambisonics<>& newInput, const IOTypes::AudioChannels<2>& newOutput) override;
+    void applyConfiguration (IOConfiguration& newConfiguration) override;
+    void handleAsyncUpdate() override; // reports the latency of a new convolution
 
 
     //======= Parameters ===========================================================
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> createParameterLayout();
+
+    //======= OSC ==================================================================
+    inline const bool interceptOSCMessage (juce::OSCMessage &message) override;
+
+    //======= Head Tracking ========================================================
+    using MidiScheme = MrHeadTrackerMidiParser::MidiScheme;
+
+    const juce::StringArray midiSchemeNames
+    {
+        "none",
+        "MrHT YPR Direct",
+        "MrHT YPR Inverse",
+        "MrHT Quaternions"
+    };
+
+    const juce::StringArray getMidiSchemes() { return midiSchemeNames; };
+    MidiScheme getCurrentMidiScheme() { return currentMidiScheme; };
+    void setMidiScheme (MidiScheme newMidiScheme);
     //==============================================================================
 
 
     static const juce::StringArray headphoneEQs;
 
+    //==============================================================================
+    /** Loads SH-domain binaural filters from an audio file, pass juce::File() to use the built-in ones. */
+    void loadFilterSet (const juce::File& fileToLoad);
+    juce::File getFilterSetFile();
+    /** Returns the name of the used filter set, or what's going on with it. */
+    juce::String getFilterSetStatus();
+
+    juce::File getLastDir() { return lastDir; }
+    void setLastDir (juce::File newLastDir);
+
 private:
     // list of used audio parameters
     std::atomic<float>* inputOrderSetting;
     std::atomic<float>* useSN3D;
     std::atomic<float>* applyHeadphoneEq;
+    std::atomic<float>* lowLatencyMode;
+
+    std::atomic<float>* yaw;
+    std::atomic<float>* pitch;
+    std::atomic<float>* roll;
+    std::atomic<float>* qw;
+    std::atomic<float>* qx;
+    std::atomic<float>* qy;
+    std::atomic<float>* qz;
+    std::atomic<float>* invertYaw;
+    std::atomic<float>* invertPitch;
+    std::atomic<float>* invertRoll;
+    std::atomic<float>* invertQuaternion;
+    std::atomic<float>* rotationSequence;
 
     juce::dsp::Convolution EQ;
 
-    int fftLength = -1;
-    int irLength = 236;
-    int irLengthMinusOne = irLength-1;
-
-    std::vector<std::complex<float>> fftBuffer;
-    std::vector<std::complex<float>> accumMid;
-    std::vector<std::complex<float>> accumSide;
-
-    std::unique_ptr<juce::dsp::FFT> fft;
-
-    juce::AudioBuffer<float> overlapBuffer;
-    juce::AudioBuffer<float> irs[7];
+    // ============ head tracking ======================
+    inline void updateQuaternions();
+    inline void updateEuler();
+    void calcRotationMatrix (const int order);
+
+    juce::Atomic<bool> usingYpr = true;
+    juce::Atomic<bool> updatingParams {false};
+    juce::Atomic<bool> rotationParamsHaveChanged {true};
+
+    // the SH channels are rotated into this buffer right before they are convolved
+    AmbisonicRotation rotation;
+    juce::AudioBuffer<float> rotationBuffer;
+    int rotationOrder = 0;
+    bool rotationIsIdentity = true;
+
+    MrHeadTrackerMidiParser midiParser {parameters};
+    MidiScheme currentMidiScheme = MidiScheme::none;
+
+    // ============ convolution ======================
+    static constexpr int partitionSize = 128;
+
+    std::unique_ptr<PartitionedConvolution> convolution;
+    std::vector<const float*> convolutionInputs;
+    std::atomic<int> convolutionLatency {0};
+
+    // filter sets are prepared in the background, shared by all instances
+    juce::SharedResourcePointer<BinauralFilterSetCache> filterSetCache;
+    juce::CriticalSection filterSetLock;
+    juce::File filterSetFile; // juce::File() for the built-in filters
+    juce::String filterSetError;
+    BinauralFilterSetCache::Request::Ptr filterSetRequest; // latest request, guarded by the filterSetLock
+    BinauralFilterSetCache::Request::Ptr activeFilterSetRequest; // request of the convolution in use
+    bool waitingForFilterSet = false;
+    std::atomic<bool> isPreparing {false};
+
+    // everything depending on the input order and the filter set, prepared in the background
+    struct ConvolutionSetup : public IOConfiguration
+    {
+        std::unique_ptr<PartitionedConvolution> convolution;
+        std::vector<const float*> convolutionInputs;
+        juce::AudioBuffer<float> rotationBuffer;
+        int rotationOrder;
+        int nMidCh;
+        int nSideCh;
+        BinauralFilterSetCache::Request::Ptr filterSetRequest;
+        bool waitingForFilterSet;
+    };
+
+    juce::File lastDir;
+    std::unique_ptr<juce::PropertiesFile> properties;
 
-    juce::AudioBuffer<float> irsFrequencyDomain;
-    double irsSampleRate = 44100.0;
     //mapping between mid-channel index and channel index
     const int mix2cix[36] = { 0, 2, 3, 6, 7, 8, 12, 13, 14, 15, 20, 21, 22, 23, 24, 30, 31, 32, 33, 34, 35, 42, 43, 44, 45, 46, 47, 48, 56, 57, 58, 59, 60, 61, 62, 63 };
     //mapping between side-channel index and channel index
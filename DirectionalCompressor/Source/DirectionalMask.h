@@ -0,0 +1,202 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "../../resources/efficientSHvanilla.h"
+#include "../../resources/tDesignN7.h"
+#include "../../resources/ambisonicTools.h"
+#include "../../resources/Conversions.h"
+#include "../../resources/ReleasePool.h"
+
+/**
+ The mask of the DirectionalCompressor for one direction and width. The mask weights the
+ t-design directions with the gains g, so it projects the Ambisonic signal x onto
+ P x = Y^T diag (g) Y x, with the SH matrix Y of the t-design. Only few directions lie within
+ a narrow mask, so P has a low rank and can also be applied by encoding the active
+ directions, weighting and decoding them.
+ */
+class DirectionalMask : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<DirectionalMask>;
+
+    DirectionalMask (const juce::dsp::Matrix<float>& Y, const float azimuthInDegrees, const float elevationInDegrees, const float widthInDegrees)
+        : projector (64, 64)
+    {
+        // convert azimuth and elevation to cartesian coordinates
+        auto pos = Conversions<float>::sphericalToCartesian (Conversions<float>::degreesToRadians (azimuthInDegrees),
+                                                              Conversions<float>::degreesToRadians (elevationInDegrees));
+        pos = pos.normalised();
+
+        float dist[tDesignN];
+        for (int point = 0; point < tDesignN; ++point)
+        {
+            dist[point] = pos.x * tDesignX[point] + pos.y * tDesignY[point] + pos.z * tDesignZ[point];
+            dist[point] /= std::sqrt (juce::square (tDesignX[point]) + juce::square (tDesignY[point]) + juce::square (tDesignZ[point]));
+            dist[point] = std::acos (juce::jlimit (-1.0f, 1.0f, dist[point]));
+        }
+
+        float widthHalf = Conversions<float>::degreesToRadians (widthInDegrees) * 0.25f; // it's actually width fourth (symmetric mask)
+        widthHalf = juce::jmax (widthHalf, juce::FloatVectorOperations::findMinimum (dist, tDesignN));
+
+        // the gain fades from one at widthHalf to zero at 3 * widthHalf
+        const float scale = 0.25f * juce::MathConstants<float>::pi / widthHalf;
+        for (int p = 0; p < tDesignN; ++p)
+            gains[p] = dist[p] >= 3 * widthHalf ? 0.0f : std::cos ((juce::jmax (dist[p], widthHalf) - widthHalf) * scale);
+
+        // P is symmetric, and only the active directions contribute
+        projector.clear();
+        for (int p = 0; p < tDesignN; ++p)
+        {
+            if (gains[p] == 0.0f)
+                continue;
+
+            const float* y = Y.getRawDataPointer() + p * 64;
+            for (int r = 0; r < 64; ++r)
+            {
+                const float gy = gains[p] * y[r];
+                float* row = projector.getRawDataPointer() + r * 64;
+                for (int c = r; c < 64; ++c)
+                    row[c] += gy * y[c];
+            }
+        }
+
+        for (int r = 1; r < 64; ++r)
+            for (int c = 0; c < r; ++c)
+                projector (r, c) = projector (c, r);
+    }
+
+    /** Returns the gain of a t-design direction. */
+    float getGain (const int point) const noexcept { return gains[point]; }
+
+    /** Returns the 64x64 projector P, for lower orders use its upper left part. */
+    const juce::dsp::Matrix<float>& getProjector() const noexcept { return projector; }
+
+private:
+    float gains[tDesignN];
+    juce::dsp::Matrix<float> projector;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DirectionalMask)
+};
+
+
+//==============================================================================
+/**
+ Calculates DirectionalMasks on a background thread, so automating the direction or width of
+ the mask doesn't load the audio thread. New masks are handed over lock-free, and the masks
+ dropped by the audio thread are released on the message thread by a ReleasePool.
+ */
+class DirectionalMaskCalculator : private juce::Thread
+{
+public:
+    DirectionalMaskCalculator() : juce::Thread ("DirectionalMaskCalculator"), Y (tDesignN, 64)
+    {
+        for (int p = 0; p < tDesignN; ++p)
+            SHEval (7, tDesignX[p], tDesignY[p], tDesignZ[p], Y.getRawDataPointer() + p * 64, false);
+
+        Y *= std::sqrt (4 * juce::MathConstants<float>::pi / tDesignN) / decodeCorrection (7); // reverting 7th order correction
+
+        startThread();
+    }
+
+    ~DirectionalMaskCalculator() override
+    {
+        stopThread (1000);
+
+        if (auto* mask = pendingMask.exchange (nullptr))
+            mask->decReferenceCountWithoutDeleting();
+    }
+
+    /**
+     Requests a new mask, which will be calculated on the background thread. It only sets atomics,
+     so it can be called from any thread, including the audio thread.
+     */
+    void requestMask (const float azimuthInDegrees, const float elevationInDegrees, const float widthInDegrees)
+    {
+        azimuth = azimuthInDegrees;
+        elevation = elevationInDegrees;
+        width = widthInDegrees;
+        maskRequested = true;
+    }
+
+    /** Calculates a new mask right away and hands it over. Don't call this method from the audio thread. */
+    void calculateMask (const float azimuthInDegrees, const float elevationInDegrees, const float widthInDegrees)
+    {
+        handOver (new DirectionalMask (Y, azimuthInDegrees, elevationInDegrees, widthInDegrees));
+    }
+
+    /**
+     Returns the latest mask if a new one is available, or nullptr otherwise. Call this from the
+     audio thread only, dropping the mask later on won't delete it.
+     */
+    DirectionalMask::Ptr getNewMask()
+    {
+        auto* newMask = pendingMask.exchange (nullptr, std::memory_order_acq_rel);
+        if (newMask == nullptr)
+            return nullptr;
+
+        DirectionalMask::Ptr mask (newMask);
+
+        // release the reference of the hand-over, the release pool holds one as well
+        newMask->decReferenceCountWithoutDeleting();
+        return mask;
+    }
+
+    /** Returns the SH matrix of the t-design, with the SH coefficients of each direction in one row of 64 values. */
+    const juce::dsp::Matrix<float>& getSHMatrix() const noexcept { return Y; }
+
+private:
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            if (maskRequested.exchange (false))
+                calculateMask (azimuth.load(), elevation.load(), width.load());
+            else
+                wait (20); // notify() would lock a mutex, so the requests are polled
+        }
+    }
+
+    void handOver (DirectionalMask::Ptr mask)
+    {
+        releasePool->add (mask.get());
+
+        mask->incReferenceCount();
+        if (auto* notConsumedMask = pendingMask.exchange (mask.get(), std::memory_order_acq_rel))
+            notConsumedMask->decReferenceCountWithoutDeleting();
+    }
+
+    juce::dsp::Matrix<float> Y;
+
+    std::atomic<float> azimuth {0.0f};
+    std::atomic<float> elevation {0.0f};
+    std::atomic<float> width {0.0f};
+    std::atomic<bool> maskRequested {false};
+
+    // hand-over to the audio thread, holds one reference of the mask
+    std::atomic<DirectionalMask*> pendingMask {nullptr};
+
+    juce::SharedResourcePointer<ReleasePool<DirectionalMask>> releasePool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DirectionalMaskCalculator)
+};
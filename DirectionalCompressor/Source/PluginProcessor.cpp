@@ -37,11 +37,8 @@ DirectionalCompressorAudioProcessor::DirectionalCompressorAudioProcessor()
                   ,
 #endif
 createParameterLayout()),
-//W (tDesignN),
-Y (tDesignN, 64),
-YH (64, tDesignN),
-tempMat (64, tDesignN),
-P1 (64, 64)
+maskCoefficients (64, juce::jmax (64, tDesignN)),
+maskDeltas (64, juce::jmax (64, tDesignN))
 {
     parameters.addParameterListener ("azimuth", this);
     parameters.addParameterListener ("elevation", this);
@@ -81,16 +78,6 @@ P1 (64, 64)
     c2MaxGR = 0.0f;
     c1GR = 0.0f;
     c2GR = 0.0f;
-
-    // calc Y
-    for (int p = 0; p < tDesignN; ++p)
-        SHEval (7, tDesignX[p], tDesignY[p], tDesignZ[p], Y.getRawDataPointer() + p * 64, false);
-
-    Y *= std::sqrt (4 * juce::MathConstants<float>::pi / tDesignN) / decodeCorrection (7); // reverting 7th order correction
-
-    for (int r = 0; r < 64; ++r)
-        for (int c = 0; c < tDesignN; ++c)
-            YH(r, c) = Y(c, r);
 }
 
 
@@ -128,7 +115,7 @@ void DirectionalCompressorAudioProcessor::parameterChanged (const juce::String &
     if (parameterID == "azimuth" || parameterID == "elevation" || parameterID == "width")
     {
         updatedPositionData = true;
-        paramChanged = true;
+        maskCalculator.requestMask (*azimuth, *elevation, *width);
     }
     else if (parameterID == "orderSetting")
     {
@@ -152,8 +139,12 @@ void DirectionalCompressorAudioProcessor::prepareToPlay (double sampleRate, int
     omniW.setSize(1, samplesPerBlock);
     c1Gains.resize(samplesPerBlock);
     c2Gains.resize(samplesPerBlock);
+    tDesignSignals.setSize (tDesignN, samplesPerBlock);
 
-    calcParams();
+    fadeLengthInSamples = juce::roundToInt (0.05 * sampleRate);
+    currentMask = nullptr;
+    previousMask = nullptr;
+    maskCalculator.calculateMask (*azimuth, *elevation, *width);
 }
 
 void DirectionalCompressorAudioProcessor::releaseResources()
@@ -166,7 +157,6 @@ void DirectionalCompressorAudioProcessor::releaseResources()
 void DirectionalCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer, juce::MidiBuffer& midiMessages)
 {
     checkInputAndOutput(this, *orderSetting, *orderSetting);
-    if (paramChanged) calcParams();
 
     const int totalNumInputChannels  = getTotalNumInputChannels();
     const int totalNumOutputChannels = getTotalNumOutputChannels();
@@ -217,16 +207,8 @@ void DirectionalCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer&
     // --------- make copys of buffer
     omniW.copyFrom(0, 0, buffer, 0, 0, bufferSize);
 
-    maskBuffer.clear();
-    maskBuffer.setSample(0, 0, 0.0f);
-    for (int chIn = 0; chIn < numCh; ++chIn)
-    {
-        const float* readPtr = buffer.getReadPointer(chIn);
-        for (int chOut = 0; chOut < numCh; ++chOut)
-        {
-            maskBuffer.addFrom(chOut, 0, readPtr, bufferSize, P1(chOut, chIn));
-        }
-    }
+    calcMaskSignal (buffer, numCh, bufferSize);
+
     /* This makes the buffer containing the negative mask */
     for (int chIn = 0; chIn < numCh; ++chIn)
         juce::FloatVectorOperations::subtract(buffer.getWritePointer(chIn), maskBuffer.getReadPointer(chIn), bufferSize);
@@ -237,30 +219,23 @@ void DirectionalCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer&
 
 
 
-    // =============== COMPRESSOR 1 ====================
+    // =============== COMPRESSOR 1 & 2 ====================
     {
-        // set compressor driving signal
-        const float* drivingSignalPtr = [this] () -> const float* {
-            if (*c1DrivingSignal >= 0.5f && *c1DrivingSignal < 1.5f) return drivingPointers[0];
-            else if (*c1DrivingSignal >= 1.5f) return drivingPointers[1];
+        // set compressor driving signals
+        auto getDrivingSignal = [this] (const float drivingSignal) -> const float* {
+            if (drivingSignal >= 0.5f && drivingSignal < 1.5f) return drivingPointers[0];
+            else if (drivingSignal >= 1.5f) return drivingPointers[1];
             else return drivingPointers[2];
-        }();
+        };
+
+        // both compressors are calculated at once, with their ballistics in parallel SIMD lanes
+        iem::Compressor* compressors[2] = { &compressor1, &compressor2 };
+        const float* drivingSignals[2] = { getDrivingSignal (*c1DrivingSignal), getDrivingSignal (*c2DrivingSignal) };
+        float* gains[2] = { c1Gains.getRawDataPointer(), c2Gains.getRawDataPointer() };
+        iem::Compressor::getGainsFromSidechainSignals (compressors, drivingSignals, gains, 2, bufferSize);
 
-        compressor1.getGainFromSidechainSignal(drivingSignalPtr, c1Gains.getRawDataPointer(), bufferSize);
         c1MaxRMS = compressor1.getMaxLevelInDecibels();
         c1MaxGR = juce::Decibels::gainToDecibels (juce::FloatVectorOperations::findMinimum(c1Gains.getRawDataPointer(), bufferSize)) - *c1Makeup;
-    }
-
-    // =============== COMPRESSOR 2 ====================
-    {
-        // set compressor driving signal
-        const float* drivingSignalPtr = [this] () -> const float* {
-            if (*c2DrivingSignal >= 0.5f && *c2DrivingSignal < 1.5f) return drivingPointers[0];
-            else if (*c2DrivingSignal >= 1.5f) return drivingPointers[1];
-            else return drivingPointers[2];
-        }();
-
-        compressor2.getGainFromSidechainSignal(drivingSignalPtr, c2Gains.getRawDataPointer(), bufferSize);
         c2MaxRMS = compressor2.getMaxLevelInDecibels();
         c2MaxGR = juce::Decibels::gainToDecibels (juce::FloatVectorOperations::findMinimum (c2Gains.getRawDataPointer(), bufferSize)) - *c2Makeup;
     }
@@ -348,46 +323,111 @@ void DirectionalCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer&
             buffer.applyGain(i, 0, bufferSize, n3d2sn3d[i]);
 }
 
-void DirectionalCompressorAudioProcessor::calcParams()
+void DirectionalCompressorAudioProcessor::calcMaskSignal (const juce::AudioBuffer<float>& buffer, const int numCh, const int numSamples)
 {
-    paramChanged = false;
+    if (auto newMask = maskCalculator.getNewMask())
+    {
+        if (currentMask != nullptr && fadeLengthInSamples > 0)
+        {
+            previousMask = currentMask;
+            fadePosition = 0;
+        }
+        else
+            previousMask = nullptr;
 
-    // convert azimuth and elevation to cartesian coordinates
-    auto pos = Conversions<float>::sphericalToCartesian (Conversions<float>::degreesToRadians (*azimuth), Conversions<float>::degreesToRadians (*elevation));
-    pos = pos.normalised();
+        currentMask = newMask;
+    }
 
+    if (currentMask == nullptr)
+    {
+        maskBuffer.clear();
+        return;
+    }
 
-    for (int point=0; point<tDesignN; ++point)
+    // the mask is linear in its gains, so cross-fading two masks is the same as ramping the gains
+    const bool fading = previousMask != nullptr;
+    float fadeStart = 1.0f;
+    float fadeEnd = 1.0f;
+    if (fading)
     {
-        dist[point] = pos.x * tDesignX[point] + pos.y * tDesignY[point] + pos.z * tDesignZ[point];
-        dist[point] /= std::sqrt (juce::square (tDesignX[point]) + juce::square (tDesignY[point]) + juce::square (tDesignZ[point]));
-        dist[point] = std::acos (dist[point]);
+        fadeStart = static_cast<float> (fadePosition) / fadeLengthInSamples;
+        fadePosition += numSamples;
+        fadeEnd = juce::jmin (1.0f, static_cast<float> (fadePosition) / fadeLengthInSamples);
     }
 
-    float widthHalf = Conversions<float>::degreesToRadians (*width) * 0.25f; // it's actually width fourth (symmetric mask)
-    widthHalf = juce::jmax (widthHalf, juce::FloatVectorOperations::findMinimum (dist, tDesignN));
+    int activePoints[tDesignN];
+    int nActive = 0;
+    for (int p = 0; p < tDesignN; ++p)
+        if (currentMask->getGain (p) != 0.0f || (fading && previousMask->getGain (p) != 0.0f))
+            activePoints[nActive++] = p;
 
-    juce::FloatVectorOperations::clip (dist, dist, widthHalf, 3 * widthHalf, tDesignN);
-    juce::FloatVectorOperations::add (dist, - widthHalf, tDesignN);
-    juce::FloatVectorOperations::multiply (dist, 0.25f * juce::MathConstants<float>::pi / widthHalf, tDesignN);
+    const float* const* input = buffer.getArrayOfReadPointers();
+    float* const* dest = maskBuffer.getArrayOfWritePointers();
 
+    const float* coefficients[64];
+    const float* deltas[64];
 
-    for (int p = 0; p < tDesignN; ++p)
+    if (2 * nActive < numCh)
     {
-        const float g = std::cos (dist[p]);
-        for (int r = 0; r < 64; ++r)
-            tempMat (r, p) = g * Y(p, r);
+        // low rank: encode the active t-design directions, weight and decode them
+        const auto& Y = maskCalculator.getSHMatrix();
+        const float* encoder[tDesignN];
+        for (int k = 0; k < nActive; ++k)
+            encoder[k] = Y.getRawDataPointer() + activePoints[k] * 64;
+
+        float* const* directions = tDesignSignals.getArrayOfWritePointers();
+        MatrixMultiplicationKernel::process (input, numCh, encoder, directions, nActive, numSamples);
+
+        for (int r = 0; r < numCh; ++r)
+        {
+            float* c = maskCoefficients.getRawDataPointer() + r * maskCoefficients.getNumColumns();
+            float* d = maskDeltas.getRawDataPointer() + r * maskDeltas.getNumColumns();
+            for (int k = 0; k < nActive; ++k)
+            {
+                const int p = activePoints[k];
+                const float gain = currentMask->getGain (p);
+                const float previousGain = fading ? previousMask->getGain (p) : gain;
+                const float startGain = previousGain + fadeStart * (gain - previousGain);
+                c[k] = Y (p, r) * startGain;
+                d[k] = Y (p, r) * (previousGain + fadeEnd * (gain - previousGain) - startGain);
+            }
+            coefficients[r] = c;
+            deltas[r] = d;
+        }
+
+        MatrixMultiplicationKernel::processWithRamp (directions, nActive, coefficients, directions, fading ? nActive : 0,
+                                                     deltas, dest, numCh, numSamples);
     }
+    else if (! fading)
+    {
+        for (int r = 0; r < numCh; ++r)
+            coefficients[r] = currentMask->getProjector().getRawDataPointer() + r * 64;
 
-    for (int r = 0; r < 64; ++r)
-        for (int c = r; c < 64; ++c)
+        MatrixMultiplicationKernel::process (input, numCh, coefficients, dest, numCh, numSamples);
+    }
+    else
+    {
+        const auto& P = currentMask->getProjector();
+        const auto& previousP = previousMask->getProjector();
+        for (int r = 0; r < numCh; ++r)
         {
-            float sum = 0.0f;
-            for (int i = 0; i < tDesignN; ++i)
-                sum += tempMat(r, i) * YH(c, i);
-            P1(r, c) = sum;
-            P1(c, r) = sum;
+            float* c = maskCoefficients.getRawDataPointer() + r * maskCoefficients.getNumColumns();
+            float* d = maskDeltas.getRawDataPointer() + r * maskDeltas.getNumColumns();
+            for (int i = 0; i < numCh; ++i)
+            {
+                const float difference = P (r, i) - previousP (r, i);
+                c[i] = previousP (r, i) + fadeStart * difference;
+                d[i] = (fadeEnd - fadeStart) * difference;
+            }
+            coefficients[r] = c;
+            deltas[r] = d;
         }
+
+        MatrixMultiplicationKernel::processWithRamp (input, numCh, coefficients, input, numCh, deltas, dest, numCh, numSamples);
+    }
+
+    if (fading && fadePosition >= fadeLengthInSamples)
+        previousMask = nullptr;
 }
 
 //==============================================================================
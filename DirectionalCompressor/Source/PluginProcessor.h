@@ -24,12 +24,10 @@
 #pragma once
 
 #include "../JuceLibraryCode/JuceHeader.h"
-#include "../../resources/efficientSHvanilla.h"
-#include "../../resources/tDesignN7.h"
-#include "../../resources/ambisonicTools.h"
 #include "../../resources/AudioProcessorBase.h"
 #include "../../resources/Compressor.h"
-#include "../../resources/Conversions.h"
+#include "../../resources/MatrixMultiplicationKernel.h"
+#include "DirectionalMask.h"
 
 #define ProcessorClass DirectionalCompressorAudioProcessor
 
@@ -78,7 +76,6 @@ public:
     float c2MaxRMS;
     float c2MaxGR;
 
-    void calcParams();
     juce::Atomic<bool> updatedPositionData;
 
 
@@ -86,17 +83,25 @@ private:
     //==============================================================================
     void updateBuffers() override;
 
+    /** Takes over new masks and writes the masked signal of the first numCh channels of buffer into maskBuffer. */
+    void calcMaskSignal (const juce::AudioBuffer<float>& buffer, const int numCh, const int numSamples);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DirectionalCompressorAudioProcessor)
 
     juce::AudioBuffer<float> omniW;
     juce::AudioBuffer<float> maskBuffer;
 
-    juce::dsp::Matrix<float> Y;
-    juce::dsp::Matrix<float> YH;
-    juce::dsp::Matrix<float> tempMat;
-    juce::dsp::Matrix<float> P1;
+    juce::AudioBuffer<float> tDesignSignals;
+
+    DirectionalMaskCalculator maskCalculator;
 
-    float dist[tDesignN];
+    // only accessed by the audio thread
+    DirectionalMask::Ptr currentMask;
+    DirectionalMask::Ptr previousMask; // faded out
+    int fadePosition = 0;
+    int fadeLengthInSamples = 0;
+    juce::dsp::Matrix<float> maskCoefficients;
+    juce::dsp::Matrix<float> maskDeltas;
 
     const float *drivingPointers[3];
 
@@ -106,8 +111,6 @@ private:
     float c1GR;
     float c2GR;
 
-    std::atomic<bool> paramChanged { true };
-
     iem::Compressor compressor1, compressor2;
     // == PARAMETERS ==
     // settings and mask
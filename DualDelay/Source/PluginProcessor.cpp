@@ -126,8 +126,6 @@ void DualDelayAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     readOffsetRight = 0;
 
     delay.resize(samplesPerBlock);
-    interpCoeffIdx.resize(samplesPerBlock);
-    idx.resize(samplesPerBlock);
 
     //AudioIN.setSize(AudioIN.getNumChannels(), samplesPerBlock);
     //delayOutLeft.setSize(delayOutLeft.getNumChannels(), samplesPerBlock);
@@ -140,8 +138,8 @@ void DualDelayAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     delayInLeft.clear();
     delayInRight.clear();
 
-    _delayL = *delayTimeL * sampleRate / 1000.0 * 128;
-    _delayR = *delayTimeR * sampleRate / 1000.0 * 128;
+    _delayL = *delayTimeL * sampleRate / 1000.0;
+    _delayR = *delayTimeR * sampleRate / 1000.0;
 }
 
 void DualDelayAudioProcessor::releaseResources() { }
@@ -159,7 +157,7 @@ void DualDelayAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer, juc
     const int delayBufferLength = getSampleRate(); // not necessarily samplerate
     const double fs = getSampleRate();
 
-    const float msToFractSmpls = getSampleRate() / 1000.0 * 128.0;
+    const float msToSmpls = getSampleRate() / 1000.0;
     const int spb = buffer.getNumSamples();
 
     //clear not used channels
@@ -269,162 +267,14 @@ void DualDelayAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer, juc
 
 
     // =============== UPDATE DELAY PARAMETERS =====
-    float delayL = *delayTimeL * msToFractSmpls;
-    float delayR = *delayTimeR * msToFractSmpls;
-
-    int firstIdx, copyL;
+    float delayL = *delayTimeL * msToSmpls;
+    float delayR = *delayTimeR * msToSmpls;
 
     // ============= WRITE INTO DELAYLINE ========================
-    // ===== LEFT CHANNEL
-
-
-    float delayStep = (delayL - _delayL)/spb;
-    //calculate firstIdx and copyL
-    for (int i=0; i<spb; ++i) {
-        delay.set(i, i*128 + _delayL + i*delayStep + *lfoDepthL * msToFractSmpls * LFOLeft.processSample(1.0f));
-    }
-    firstIdx = (((int) *std::min_element(delay.getRawDataPointer(),delay.getRawDataPointer()+spb)) >> interpShift) - interpOffset;
-    int lastIdx =  (((int) *std::max_element(delay.getRawDataPointer(),delay.getRawDataPointer()+spb)) >> interpShift) - interpOffset;
-    copyL = abs(firstIdx - lastIdx) + interpLength;
-
-
-
-    delayTempBuffer.clear(0, copyL);
-    //delayTempBuffer.clear();
-    const float** readPtrArr = delayInLeft.getArrayOfReadPointers();
-
-    for (int i=0; i<spb; ++i) {
-
-        float integer;
-        float fraction = modff(delay[i], &integer);
-        int delayInt = (int) integer;
-
-        int interpCoeffIdx = delayInt&interpMask;
-        delayInt = delayInt>>interpShift;
-        int idx = delayInt-interpOffset - firstIdx;
-
-#if JUCE_USE_SSE_INTRINSICS
-        __m128 interp = getInterpolatedLagrangeWeights(interpCoeffIdx, fraction);
-
-        for (int ch = 0; ch < nCh; ++ch)
-        {
-            float* dest = delayTempBuffer.getWritePointer(ch, idx);
-
-            __m128 destSamples = _mm_loadu_ps(dest);
-            __m128 srcSample = _mm_set1_ps(readPtrArr[ch][i]);
-            destSamples = _mm_add_ps(destSamples, _mm_mul_ps(interp, srcSample));
-            _mm_storeu_ps(dest, destSamples);
-        }
-#else /* !JUCE_USE_SSE_INTRINSICS */
-        float interp[4];
-        getInterpolatedLagrangeWeights(interpCoeffIdx, fraction, interp);
-
-        for (int ch = 0; ch < nCh; ++ch)
-        {
-            float* dest = delayTempBuffer.getWritePointer(ch, idx);
-            float src = readPtrArr[ch][i];
-            dest[0] += interp[0] * src;
-            dest[1] += interp[1] * src;
-            dest[2] += interp[2] * src;
-            dest[3] += interp[3] * src;
-        }
-#endif /* JUCE_USE_SSE_INTRINSICS */
-    }
-    writeOffsetLeft = readOffsetLeft + firstIdx;
-    if (writeOffsetLeft >= delayBufferLength)
-        writeOffsetLeft -= delayBufferLength;
-
-    if (writeOffsetLeft + copyL >= delayBufferLength) { // overflow
-        int firstNumCopy = delayBufferLength - writeOffsetLeft;
-        int secondNumCopy = copyL-firstNumCopy;
-
-        for (int channel = 0; channel < nCh; ++channel)
-        {
-            delayBufferLeft.addFrom(channel, writeOffsetLeft, delayTempBuffer, channel, 0, firstNumCopy);
-            delayBufferLeft.addFrom(channel, 0, delayTempBuffer, channel, firstNumCopy, secondNumCopy);
-        }
-    }
-    else { // no overflow
-        for (int channel = 0; channel < nCh; ++channel)
-        {
-            delayBufferLeft.addFrom(channel, writeOffsetLeft, delayTempBuffer, channel, 0 , copyL);
-        }
-    }
-
-    // ===== Right CHANNEL
-
-
-    delayStep = (delayR - _delayR)/spb;
-    //calculate firstIdx and copyL
-    for (int i=0; i<spb; ++i) {
-        delay.set(i, i*128 + _delayR + i*delayStep + *lfoDepthR * msToFractSmpls * LFORight.processSample(1.0f));
-    }
-    firstIdx = (((int) *std::min_element(delay.getRawDataPointer(),delay.getRawDataPointer()+spb)) >> interpShift) - interpOffset;
-    lastIdx =  (((int) *std::max_element(delay.getRawDataPointer(),delay.getRawDataPointer()+spb)) >> interpShift) - interpOffset;
-    copyL = abs(firstIdx - lastIdx) + interpLength;
-
-
-
-    delayTempBuffer.clear(0, copyL);
-
-    const float** readPtrArrR = delayInRight.getArrayOfReadPointers();
-
-    for (int i=0; i<spb; ++i) {
-        float integer;
-        float fraction = modff(delay[i], &integer);
-        int delayInt = (int) integer;
-
-        int interpCoeffIdx = delayInt&interpMask;
-        delayInt = delayInt>>interpShift;
-        int idx = delayInt-interpOffset - firstIdx;
-
-#if JUCE_USE_SSE_INTRINSICS
-        __m128 interp = getInterpolatedLagrangeWeights(interpCoeffIdx, fraction);
-
-        for (int ch = 0; ch < nCh; ++ch)
-        {
-            float* dest = delayTempBuffer.getWritePointer(ch, idx);
-
-            __m128 destSamples = _mm_loadu_ps(dest);
-            __m128 srcSample = _mm_set1_ps(readPtrArrR[ch][i]);
-            destSamples = _mm_add_ps(destSamples, _mm_mul_ps(interp, srcSample));
-            _mm_storeu_ps(dest, destSamples);
-        }
-#else /* !JUCE_USE_SSE_INTRINSICS */
-        float interp[4];
-        getInterpolatedLagrangeWeights(interpCoeffIdx, fraction, interp);
-
-        for (int ch = 0; ch < nCh; ++ch)
-        {
-            float* dest = delayTempBuffer.getWritePointer(ch, idx);
-            float src = readPtrArrR[ch][i];
-            dest[0] += interp[0] * src;
-            dest[1] += interp[1] * src;
-            dest[2] += interp[2] * src;
-            dest[3] += interp[3] * src;
-        }
-#endif /* JUCE_USE_SSE_INTRINSICS */
-    }
-    writeOffsetRight = readOffsetRight + firstIdx;
-    if (writeOffsetRight >= delayBufferLength)
-        writeOffsetRight -= delayBufferLength;
-
-    if (writeOffsetRight + copyL >= delayBufferLength) { // overflow
-        int firstNumCopy = delayBufferLength - writeOffsetRight;
-        int secondNumCopy = copyL-firstNumCopy;
-
-        for (int channel = 0; channel < nCh; ++channel)
-        {
-            delayBufferRight.addFrom(channel, writeOffsetRight, delayTempBuffer, channel, 0, firstNumCopy);
-            delayBufferRight.addFrom(channel, 0, delayTempBuffer, channel, firstNumCopy, secondNumCopy);
-        }
-    }
-    else { // no overflow
-        for (int channel = 0; channel < nCh; ++channel)
-        {
-            delayBufferRight.addFrom(channel, writeOffsetRight, delayTempBuffer, channel, 0 , copyL);
-        }
-    }
+    writeIntoDelayLine (delayInLeft, delayBufferLeft, LFOLeft, _delayL, delayL, *lfoDepthL * msToSmpls,
+                        readOffsetLeft, writeOffsetLeft, delayBufferLength, nCh, spb);
+    writeIntoDelayLine (delayInRight, delayBufferRight, LFORight, _delayR, delayR, *lfoDepthR * msToSmpls,
+                        readOffsetRight, writeOffsetRight, delayBufferLength, nCh, spb);
 
     // =============== UPDATE DELAY PARAMETERS =====
     _delayL = delayL;
@@ -481,6 +331,52 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
     return new DualDelayAudioProcessor();
 }
 
+void DualDelayAudioProcessor::writeIntoDelayLine (const juce::AudioBuffer<float>& delayIn, juce::AudioBuffer<float>& delayBuffer,
+                                                  juce::dsp::Oscillator<float>& lfo, const float startDelay, const float endDelay,
+                                                  const float lfoDepthInSamples, const int readOffset, int& writeOffset,
+                                                  const int delayBufferLength, const int nCh, const int spb)
+{
+    auto readPtrArr = delayIn.getArrayOfReadPointers();
+    auto writePtrArr = delayTempBuffer.getArrayOfWritePointers();
+    const float delayStep = (endDelay - startDelay) / spb;
+
+    // the delay engine puts a sample with zero delay on its second tap, so we subtract that offset
+    juce::Range<int> range;
+    if (lfoDepthInSamples == 0.0f)
+        range = FractionalDelay::process (readPtrArr, writePtrArr, nCh, spb,
+                                          startDelay - FractionalDelay::kernelOffset, delayStep);
+    else
+    {
+        float* delayPtr = delay.getRawDataPointer();
+        for (int i = 0; i < spb; ++i)
+            delayPtr[i] = startDelay + i * delayStep + lfoDepthInSamples * lfo.processSample (1.0f) - FractionalDelay::kernelOffset;
+
+        range = FractionalDelay::process (readPtrArr, writePtrArr, nCh, spb, delayPtr);
+    }
+
+    const int copyL = range.getLength();
+    writeOffset = readOffset + range.getStart();
+    if (writeOffset >= delayBufferLength)
+        writeOffset -= delayBufferLength;
+
+    if (writeOffset + copyL >= delayBufferLength) { // overflow
+        int firstNumCopy = delayBufferLength - writeOffset;
+        int secondNumCopy = copyL-firstNumCopy;
+
+        for (int channel = 0; channel < nCh; ++channel)
+        {
+            delayBuffer.addFrom(channel, writeOffset, delayTempBuffer, channel, 0, firstNumCopy);
+            delayBuffer.addFrom(channel, 0, delayTempBuffer, channel, firstNumCopy, secondNumCopy);
+        }
+    }
+    else { // no overflow
+        for (int channel = 0; channel < nCh; ++channel)
+        {
+            delayBuffer.addFrom(channel, writeOffset, delayTempBuffer, channel, 0 , copyL);
+        }
+    }
+}
+
 void DualDelayAudioProcessor::calcParams(float phi)
 {
     // use mathematical negative angles!
@@ -584,12 +480,12 @@ void DualDelayAudioProcessor::updateBuffers()
 
     const int maxLfoDepth = static_cast<int> (ceil (parameters.getParameterRange ("lfoDepthL").getRange().getEnd() * sampleRate / 500.0f));
 
-    delayBufferLeft.setSize (nChannels, samplesPerBlock+interpOffset-1+maxLfoDepth+sampleRate);
-    delayBufferRight.setSize (nChannels, samplesPerBlock+interpOffset-1+maxLfoDepth+sampleRate);
+    delayBufferLeft.setSize (nChannels, samplesPerBlock+maxLfoDepth+sampleRate);
+    delayBufferRight.setSize (nChannels, samplesPerBlock+maxLfoDepth+sampleRate);
     delayBufferLeft.clear();
     delayBufferRight.clear();
 
-    delayTempBuffer.setSize(nChannels, samplesPerBlock+interpOffset-1+maxLfoDepth+sampleRate*0.5);
+    delayTempBuffer.setSize(nChannels, samplesPerBlock+maxLfoDepth+sampleRate*0.5);
 
     delayOutLeft.setSize(nChannels, samplesPerBlock);
     delayOutRight.setSize(nChannels, samplesPerBlock);
@@ -24,7 +24,7 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "../../resources/ambisonicTools.h"
-#include "../../resources/interpLagrangeWeights.h"
+#include "../../resources/FractionalDelay.h"
 #include "../../resources/AudioProcessorBase.h"
 
 #define ProcessorClass DualDelayAudioProcessor
@@ -109,8 +109,6 @@ private:
 
 
     juce::Array<float> delay;
-    juce::Array<int> interpCoeffIdx;
-    juce::Array<int> idx;
 
 
     juce::dsp::Oscillator<float> LFOLeft, LFORight;
@@ -126,6 +124,10 @@ private:
 
     void calcParams(float phi);
     void rotateBuffer(juce::AudioBuffer<float>* bufferToRotate, const int nChannels, const int samples);
+    void writeIntoDelayLine (const juce::AudioBuffer<float>& delayIn, juce::AudioBuffer<float>& delayBuffer,
+                             juce::dsp::Oscillator<float>& lfo, const float startDelay, const float endDelay,
+                             const float lfoDepthInSamples, const int readOffset, int& writeOffset,
+                             const int delayBufferLength, const int nCh, const int spb);
     float feedback = 0.8f;
 
     juce::OwnedArray<juce::IIRFilter> lowPassFiltersLeft;
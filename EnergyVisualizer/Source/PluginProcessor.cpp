@@ -55,6 +55,7 @@ createParameterLayout()), decoderMatrix (nSamplePoints, 64)
     decoderMatrix *= 1.0f / decodeCorrection(7); // revert 7th order correction
 
     rms.resize (nSamplePoints);
+    powers.resize (nSamplePoints);
     std::fill (rms.begin(), rms.end(), 0.0f);
 
     weights.resize (64);
@@ -96,9 +97,11 @@ void EnergyVisualizerAudioProcessor::prepareToPlay (double sampleRate, int sampl
 {
     checkInputAndOutput (this, *orderSetting, 0, true);
 
-    timeConstant = exp (-1.0 / (sampleRate * 0.1 / samplesPerBlock)); // 100ms RMS averaging
+    spatialAnalysis.prepare (sampleRate);
+    spatialAnalysis.setTimeConstant (0.1f); // 100ms RMS averaging
+    updateInterval = juce::roundToInt (sampleRate * 0.02); // the visualizer refreshes every 20ms
 
-    sampledSignal.resize (samplesPerBlock);
+    samplesUntilUpdate = 0;
     std::fill (rms.begin(), rms.end(), 0.0f);
 }
 
@@ -118,6 +121,9 @@ void EnergyVisualizerAudioProcessor::processBlock (juce::AudioSampleBuffer& buff
     if (! doProcessing.get() && ! oscParameterInterface.getOSCSender().isConnected())
         return;
 
+    if (buffer.getNumSamples() == 0)
+        return;
+
     //const int nCh = buffer.getNumChannels();
     const int L = buffer.getNumSamples();
     const int workingOrder = juce::jmin (isqrt (buffer.getNumChannels()) - 1, input.getOrder());
@@ -125,30 +131,42 @@ void EnergyVisualizerAudioProcessor::processBlock (juce::AudioSampleBuffer& buff
     const int nCh = squares[workingOrder+1];
 
 
+    // the covariance is smoothed instead of the energies of the sample points, so the work per sample doesn't depend on their number
+    spatialAnalysis.process (buffer.getArrayOfReadPointers(), nCh, L);
+
+    samplesUntilUpdate -= L;
+    if (samplesUntilUpdate <= 0)
+    {
+        samplesUntilUpdate = updateInterval;
+        updateRms (workingOrder);
+    }
+}
+
+void EnergyVisualizerAudioProcessor::updateRms (const int workingOrder)
+{
+    const int nCh = squares[workingOrder+1];
+
     copyMaxRE (workingOrder, weights.data());
     juce::FloatVectorOperations::multiply (weights.data(), maxRECorrection[workingOrder] * decodeCorrection (workingOrder), nCh);
 
     if (*useSN3D < 0.5f)
         juce::FloatVectorOperations::multiply (weights.data(), n3d2sn3d, nCh);
 
-    const float oneMinusTimeConstant = 1.0f - timeConstant;
     for (int i = 0; i < nSamplePoints; ++i)
-    {
-        juce::FloatVectorOperations::copyWithMultiply (sampledSignal.data(), buffer.getReadPointer (0), decoderMatrix(i, 0) * weights[0], buffer.getNumSamples());
-        for (int ch = 1; ch < nCh; ++ch)
-            juce::FloatVectorOperations::addWithMultiply (sampledSignal.data(), buffer.getReadPointer (ch), decoderMatrix(i, ch) * weights[ch], L);
+        juce::FloatVectorOperations::multiply (beamformers.getCoefficients (i), decoderMatrix.getRawDataPointer() + i * 64, weights.data(), nCh);
 
-        // calculate rms
-        float sum = 0.0f;
-        for (int i = 0; i < L; ++i)
-        {
-            const auto sample = sampledSignal[i];
-            sum += sample * sample;
-        }
+    // the editor reads rms without synchronisation, so it only gets the final values
+    spatialAnalysis.getSteeredResponsePower (beamformers, powers.data());
+    for (int i = 0; i < nSamplePoints; ++i)
+        rms[i] = std::sqrt (powers[i]);
 
-        rms[i] = timeConstant * rms[i] + oneMinusTimeConstant * std::sqrt (sum / L);
+    if (workingOrder > 0)
+    {
+        const auto soundField = spatialAnalysis.getSoundFieldParameters (*useSN3D >= 0.5f);
+        directionOfArrivalAzimuth = juce::radiansToDegrees (std::atan2 (soundField.direction.y, soundField.direction.x));
+        directionOfArrivalElevation = juce::radiansToDegrees (std::asin (juce::jlimit (-1.0f, 1.0f, soundField.direction.z)));
+        diffuseness = soundField.diffuseness;
     }
-
 }
 
 //==============================================================================
@@ -258,6 +276,15 @@ void EnergyVisualizerAudioProcessor::sendAdditionalOSCMessages (juce::OSCSender&
     for (int i = 0; i < nSamplePoints; ++i)
         message.addFloat32 (rms[i]);
     oscSender.send (message);
+
+    juce::OSCMessage doaMessage (address.toString() + "/DOA");
+    doaMessage.addFloat32 (directionOfArrivalAzimuth.get());
+    doaMessage.addFloat32 (directionOfArrivalElevation.get());
+    oscSender.send (doaMessage);
+
+    juce::OSCMessage diffusenessMessage (address.toString() + "/Diffuseness");
+    diffusenessMessage.addFloat32 (diffuseness.get());
+    oscSender.send (diffusenessMessage);
 }
 
 //==============================================================================
@@ -29,6 +29,7 @@
 #include "../../resources/ambisonicTools.h"
 #include "../../resources/AudioProcessorBase.h"
 #include "../../resources/MaxRE.h"
+#include "../../resources/SpatialAnalysis.h"
 
 #define ProcessorClass EnergyVisualizerAudioProcessor
 
@@ -87,13 +88,23 @@ private:
     std::atomic<float>* peakLevel;
     std::atomic<float>* dynamicRange;
 
-    float timeConstant;
-
     juce::Atomic<bool> doProcessing = true;
 
     juce::dsp::Matrix<float> decoderMatrix;
     std::vector<float> weights;
-    std::vector<float> sampledSignal;
+    std::vector<float> powers;
+
+    // the energies of the sample points are derived from the smoothed covariance of the input
+    SpatialAnalysis spatialAnalysis;
+    SpatialAnalysis::Beamformers beamformers {nSamplePoints};
+    int samplesUntilUpdate = 0;
+    int updateInterval = 0;
+
+    juce::Atomic<float> directionOfArrivalAzimuth = 0.0f;
+    juce::Atomic<float> directionOfArrivalElevation = 0.0f;
+    juce::Atomic<float> diffuseness = 1.0f;
+
+    void updateRms (const int workingOrder);
 
     void timerCallback() override;
     void sendAdditionalOSCMessages (juce::OSCSender& oscSender, const juce::OSCAddressPattern& address) override;
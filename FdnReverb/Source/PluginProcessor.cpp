@@ -63,8 +63,6 @@ createParameterLayout())
     wet = parameters.getRawParameterValue("dryWet");
 
     fdn.setFdnSize(FeedbackDelayNetwork::big);
-	fdnFade.setFdnSize(FeedbackDelayNetwork::big);
-	fdnFade.setDryWet(1.0f);
 }
 
 FdnReverbAudioProcessor::~FdnReverbAudioProcessor()
@@ -101,13 +99,11 @@ void FdnReverbAudioProcessor::parameterChanged (const juce::String & parameterID
 	if (parameterID == "delayLength")
 	{
 		fdn.setDelayLength(*delayLength);
-		fdnFade.setDelayLength(*delayLength);
-
 	}
 	else if (parameterID == "revTime")
         fdn.setT60InSeconds (*revTime);
 	else if (parameterID == "fadeInTime")
-		fdnFade.setT60InSeconds(*fadeInTime);
+		fdn.setFadeInTime (*fadeInTime);
     else if (parameterID == "dryWet")
         fdn.setDryWet (*wet);
     else if (parameterID == "fdnSize")
@@ -119,15 +115,6 @@ void FdnReverbAudioProcessor::parameterChanged (const juce::String & parameterID
             size = FeedbackDelayNetwork::FdnSize::small;
 
         fdn.setFdnSize (size);
-        fdnFade.setFdnSize (size);
-
-        juce::dsp::ProcessSpec spec;
-        spec.sampleRate = getSampleRate();
-        spec.maximumBlockSize = getBlockSize();
-        spec.numChannels = 64;
-        fdn.prepare (spec);
-        fdnFade.prepare(spec);
-
     }
     else
         {
@@ -149,22 +136,18 @@ void FdnReverbAudioProcessor::updateFilterParameters()
     highShelf.linearGain = juce::Decibels::decibelsToGain (highGain->load());
 
     fdn.setFilterParameter (lowShelf, highShelf);
-	fdnFade.setFilterParameter(lowShelf, highShelf);
 }
 //==============================================================================
 void FdnReverbAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     updateFilterParameters();
-
-	copyBuffer.setSize(64, samplesPerBlock);
-	copyBuffer.clear();
+    fdn.setFadeInTime (*fadeInTime);
 
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = samplesPerBlock;
     spec.numChannels = 64;
     fdn.prepare (spec);
-	fdnFade.prepare(spec);
 
 	maxPossibleChannels = getTotalNumInputChannels();
 }
@@ -180,7 +163,6 @@ void FdnReverbAudioProcessor::releaseResources()
 void FdnReverbAudioProcessor::reset()
 {
     fdn.reset();
-	fdnFade.reset();
 }
 
 //------------------------------------------------------------------------------
@@ -189,28 +171,10 @@ void FdnReverbAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
 	const int nChannels = buffer.getNumChannels();
 	const int nSamples = buffer.getNumSamples();
 
-	// make copy of input data
-	if (*fadeInTime != 0.0f)
-	{
-		for (int i = 0; i < nChannels; i++)
-		{
-			copyBuffer.copyFrom(i, 0, buffer, i, 0, nSamples);
-		}
-
-		juce::dsp::AudioBlock<float> blockFade(copyBuffer.getArrayOfWritePointers(), nChannels, nSamples);
-		fdnFade.process(juce::dsp::ProcessContextReplacing<float>(blockFade));
-	}
+	// the fade-in is done within the network
 	juce::dsp::AudioBlock<float> block (buffer);
     fdn.process (juce::dsp::ProcessContextReplacing<float> (block));
 
-	if (*fadeInTime != 0.0f)
-	{
-		for (int i = 0; i < nChannels; i++)
-		{
-			buffer.addFrom(i, 0, copyBuffer, i, 0, nSamples, -*wet);
-		}
-	}
-
     auto fdnSize = fdn.getFdnSize();
     if (fdnSize < nChannels)
     {
@@ -78,8 +78,6 @@ public:
 
 private:
     //==============================================================================
-	juce::AudioBuffer<float> copyBuffer;
-
     // parameters (from GUI)
     std::atomic<float>* revTime;
 	std::atomic<float>* fadeInTime;
@@ -93,7 +91,7 @@ private:
     std::atomic<float>* lowGain;
     std::atomic<float>* wet;
 
-    FeedbackDelayNetwork fdn, fdnFade;
+    FeedbackDelayNetwork fdn;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FdnReverbAudioProcessor)
 };
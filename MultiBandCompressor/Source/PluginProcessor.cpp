@@ -408,9 +408,11 @@ void MultiBandCompressorAudioProcessor::prepareToPlay (double sampleRate, int sa
     temp = juce::dsp::AudioBlock<float> (tempData, 64, samplesPerBlock);
     temp.clear();
 
-    gains = juce::dsp::AudioBlock<float> (gainData, 1, samplesPerBlock);
+    gains = juce::dsp::AudioBlock<float> (gainData, numFreqBands, samplesPerBlock);
     gains.clear();
 
+    sideChains = juce::dsp::AudioBlock<float> (sideChainData, numFreqBands, samplesPerBlock);
+
     tempBuffer.setSize (64, samplesPerBlock);
 
     repaintFilterVisualization = true;
@@ -450,7 +452,6 @@ void MultiBandCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& b
     auto* inout = channelPointers.getData();
     const int L = buffer.getNumSamples();
     const int numSimdFilters =  1 + (numChannels - 1) / filterRegisterSize;
-    gainChannelPointer = gains.getChannelPointer (0);
 
     tempBuffer.clear();
     gains.clear();
@@ -555,6 +556,31 @@ void MultiBandCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& b
     }
 
 
+    // the sidechain signal of each band is its first channel, all compressors are calculated at once
+    // with their ballistics in parallel SIMD lanes
+    iem::Compressor* activeCompressors[numFreqBands];
+    const float* sideChainPointers[numFreqBands];
+    float* gainPointers[numFreqBands];
+    int numActiveCompressors = 0;
+
+    for (int i = 0; i < numFreqBands; ++i)
+    {
+        if ((! soloArray.isZero() && ! soloArray[i]) || *bypass[i] >= 0.5f)
+            continue;
+
+        const float* interleavedBand = reinterpret_cast<const float*> (freqBands[i][0]->getChannelPointer (0));
+        float* sideChain = sideChains.getChannelPointer (i);
+        for (int n = 0; n < L; ++n)
+            sideChain[n] = interleavedBand[n * filterRegisterSize];
+
+        activeCompressors[numActiveCompressors] = &compressors[i];
+        sideChainPointers[numActiveCompressors] = sideChain;
+        gainPointers[numActiveCompressors] = gains.getChannelPointer (i);
+        ++numActiveCompressors;
+    }
+
+    iem::Compressor::getGainsFromSidechainSignals (activeCompressors, sideChainPointers, gainPointers, numActiveCompressors, L);
+
     for (int i = 0; i < numFreqBands; ++i)
     {
         if (! soloArray.isZero())
@@ -609,7 +635,7 @@ void MultiBandCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& b
         // Compress
         if (*bypass[i] < 0.5f)
         {
-            compressors[i].getGainFromSidechainSignal (inout[0], gainChannelPointer, L);
+            gainChannelPointer = gains.getChannelPointer (i);
             maxGR[i] = juce::Decibels::gainToDecibels (juce::FloatVectorOperations::findMinimum (gainChannelPointer, L)) - *makeUpGain[i];
             maxPeak[i] = compressors[i].getMaxLevelInDecibels();
 
@@ -144,12 +144,12 @@ private:
                                              iirAP[numFreqBands-1];
 
     juce::OwnedArray<juce::dsp::AudioBlock<filterFloatType>> interleaved, freqBands[numFreqBands];
-    juce::dsp::AudioBlock<float> zero, temp, gains;
+    juce::dsp::AudioBlock<float> zero, temp, gains, sideChains;
     juce::AudioBuffer<float> tempBuffer;
     float* gainChannelPointer;
 
     std::vector<juce::HeapBlock<char>> interleavedBlockData,  freqBandsBlocks[numFreqBands];
-    juce::HeapBlock<char> zeroData, tempData, gainData;
+    juce::HeapBlock<char> zeroData, tempData, gainData, sideChainData;
     juce::HeapBlock<const float*> channelPointers { 64 };
 
     juce::Atomic<bool> userChangedFilterSettings = true;
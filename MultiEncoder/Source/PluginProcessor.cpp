@@ -94,10 +94,15 @@ rms (64)
 
     yprInput = true; //input from ypr
 
+    for (int ch = 0; ch < 64; ++ch)
+        juce::FloatVectorOperations::clear (encoderGains[ch], maxNumberOfInputs);
+
     for (int i = 0; i < maxNumberOfInputs; ++i)
     {
         juce::FloatVectorOperations::clear(SH[i], 64);
-        _gain[i] = 0.0f;
+        encodedAzimuth[i] = 0.0f;
+        encodedElevation[i] = 0.0f;
+        encodedGain[i] = 0.0f;
         //elemActive[i] = *gain[i] >= -59.9f;
         elementColours[i] = juce::Colours::cyan;
     }
@@ -167,15 +172,23 @@ void MultiEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
             rms[ch] = timeConstant * rms[ch] + oneMinusTimeConstant * buffer.getRMSLevel (ch, 0, buffer.getNumSamples());
     }
 
+    const int L = buffer.getNumSamples();
+
     for (int i = 0; i < nChIn; ++i)
-        bufferCopy.copyFrom (i, 0, buffer.getReadPointer (i), buffer.getNumSamples());
+        bufferCopy.copyFrom (i, 0, buffer.getReadPointer (i), L);
+
+    const bool sn3d = *useSN3D >= 0.5f;
+    const bool encodingChanged = nChOut != encodedNumChannels || sn3d != encodedSN3D;
+    encodedNumChannels = nChOut;
+    encodedSN3D = sn3d;
 
-    buffer.clear();
+    // sources whose gains haven't changed are encoded without ramping
+    const float* rampedInputs[maxNumberOfInputs];
+    int rampedInputIndices[maxNumberOfInputs];
+    int nRampedInputs = 0;
 
     for (int i = 0; i < nChIn; ++i)
     {
-        juce::FloatVectorOperations::copy (_SH[i], SH[i], nChOut);
-
         float currGain = 0.0f;
 
         if (! soloMask.isZero())
@@ -190,21 +203,63 @@ void MultiEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
         }
 
 
-        const float azimuthInRad = juce::degreesToRadians (azimuth[i]->load());
-        const float elevationInRad = juce::degreesToRadians (elevation[i]->load());
+        const float azimuthInDegrees = azimuth[i]->load();
+        const float elevationInDegrees = elevation[i]->load();
+
+        // static source: its coefficients are still in the encoder matrix
+        if (! encodingChanged && azimuthInDegrees == encodedAzimuth[i]
+            && elevationInDegrees == encodedElevation[i] && currGain == encodedGain[i])
+            continue;
+
+        encodedAzimuth[i] = azimuthInDegrees;
+        encodedElevation[i] = elevationInDegrees;
+        encodedGain[i] = currGain;
+
+        const float azimuthInRad = juce::degreesToRadians (azimuthInDegrees);
+        const float elevationInRad = juce::degreesToRadians (elevationInDegrees);
 
         const juce::Vector3D<float> pos {Conversions<float>::sphericalToCartesian (azimuthInRad, elevationInRad)};
 
         SHEval (ambisonicOrder, pos.x, pos.y, pos.z, SH[i]);
 
-        if (*useSN3D >= 0.5f)
+        if (sn3d)
             juce::FloatVectorOperations::multiply (SH[i], SH[i], n3d2sn3d, nChOut);
 
-        const float* inpReadPtr = bufferCopy.getReadPointer(i);
+        bool changed = false;
         for (int ch = 0; ch < nChOut; ++ch)
-            buffer.addFromWithRamp (ch, 0, inpReadPtr, buffer.getNumSamples(), _SH[i][ch] * _gain[i], SH[i][ch] * currGain);
+            changed = changed || SH[i][ch] * currGain != encoderGains[ch][i];
 
-        _gain[i] = currGain;
+        if (changed)
+        {
+            for (int ch = 0; ch < nChOut; ++ch)
+                encoderGainDeltas[ch][nRampedInputs] = SH[i][ch] * currGain - encoderGains[ch][i];
+
+            rampedInputs[nRampedInputs] = bufferCopy.getReadPointer (i);
+            rampedInputIndices[nRampedInputs] = i;
+            ++nRampedInputs;
+        }
+    }
+
+    const float* gainRows[64];
+    const float* gainDeltaRows[64];
+    for (int ch = 0; ch < nChOut; ++ch)
+    {
+        gainRows[ch] = encoderGains[ch];
+        gainDeltaRows[ch] = encoderGainDeltas[ch];
+    }
+
+    MatrixMultiplicationKernel::processWithRamp (bufferCopy.getArrayOfReadPointers(), nChIn, gainRows,
+                                                 rampedInputs, nRampedInputs, gainDeltaRows,
+                                                 buffer.getArrayOfWritePointers(), nChOut, L);
+
+    for (int ch = nChOut; ch < buffer.getNumChannels(); ++ch)
+        buffer.clear (ch, 0, L);
+
+    for (int k = 0; k < nRampedInputs; ++k)
+    {
+        const int i = rampedInputIndices[k];
+        for (int ch = 0; ch < nChOut; ++ch)
+            encoderGains[ch][i] = SH[i][ch] * encodedGain[i];
     }
 }
 
@@ -28,6 +28,7 @@
 #include "../../resources/ambisonicTools.h"
 #include "../../resources/AudioProcessorBase.h"
 #include "../../resources/Conversions.h"
+#include "../../resources/MatrixMultiplicationKernel.h"
 
 #define CONFIGURATIONHELPER_ENABLE_LOUDSPEAKERLAYOUT_METHODS 1
 #include "../../resources/ConfigurationHelper.h"
@@ -139,8 +140,17 @@ private:
     bool moving = false;
 
     float SH[maxNumberOfInputs][64];
-    float _SH[maxNumberOfInputs][64];
-    float _gain[maxNumberOfInputs];
+
+    // encoder matrix (SH channels x inputs) at the start of the block, and the changes of the ramped inputs
+    float encoderGains[64][maxNumberOfInputs];
+    float encoderGainDeltas[64][maxNumberOfInputs];
+
+    // source parameters the encoder matrix has been calculated with, static sources are skipped
+    float encodedAzimuth[maxNumberOfInputs];
+    float encodedElevation[maxNumberOfInputs];
+    float encodedGain[maxNumberOfInputs];
+    int encodedNumChannels = -1;
+    bool encodedSN3D = false;
 
     juce::AudioBuffer<float> bufferCopy;
 
@@ -0,0 +1,233 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Authors: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+ Brickwall limiter gain computer. The gains it calculates have to be applied to the signal
+ delayed by the look-ahead time, which is the same for every sample, so the limiter never
+ lets a (true) peak above the ceiling pass.
+
+ The gain needed for each sample is held with a sliding-window minimum (a monotonic deque,
+ amortised O(1) per sample), released exponentially and smoothed with a moving average of the
+ same length, so the gain reduction ramps down over the whole look-ahead time. With true-peak
+ detection, the peaks are estimated from the sidechain signal oversampled four times with a
+ polyphase windowed-sinc interpolator. Its latency is taken from the look-ahead window. The
+ cost per sample doesn't depend on the look-ahead time.
+ */
+class LookAheadLimiter
+{
+public:
+    static constexpr int oversamplingFactor = 4;
+    static constexpr int tapsPerPhase = 12;
+    static constexpr int truePeakLatency = tapsPerPhase / 2;
+
+    LookAheadLimiter()
+    {
+        // phase p interpolates at p / oversamplingFactor between the samples n - truePeakLatency and n - truePeakLatency + 1
+        for (int p = 0; p < oversamplingFactor; ++p)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < tapsPerPhase; ++k)
+            {
+                const float t = k - truePeakLatency + static_cast<float> (p) / oversamplingFactor;
+                const float window = 0.5f + 0.5f * std::cos (juce::MathConstants<float>::pi * t / (truePeakLatency + 0.5f));
+                const float sinc = t == 0.0f ? 1.0f : std::sin (juce::MathConstants<float>::pi * t) / (juce::MathConstants<float>::pi * t);
+                interpolationCoefficients[p][k] = window * sinc;
+                sum += window * sinc;
+            }
+
+            for (int k = 0; k < tapsPerPhase; ++k)
+                interpolationCoefficients[p][k] /= sum;
+        }
+    }
+
+    /** Prepares the limiter for gains which are applied to the signal delayed by lookAheadInSamples. */
+    void prepare (const double newSampleRate, const int lookAheadInSamples)
+    {
+        sampleRate = newSampleRate;
+        lookAhead = juce::jmax (truePeakLatency + 1, lookAheadInSamples);
+
+        minimumValues.allocate (lookAhead + 1, true);
+        minimumIndices.allocate (lookAhead + 1, true);
+        averageBuffer.allocate (lookAhead + 1, true);
+
+        setReleaseTime (releaseTime);
+        reset();
+    }
+
+    void reset()
+    {
+        if (averageBuffer == nullptr)
+            return;
+
+        windowLength = lookAhead + 1 - (truePeakDetection ? truePeakLatency : 0);
+
+        dequeStart = 0;
+        dequeSize = 0;
+        sampleIndex = 0;
+
+        released = 1.0f;
+        juce::FloatVectorOperations::fill (averageBuffer.getData(), 1.0f, windowLength);
+        averageSum = windowLength;
+        averagePosition = 0;
+
+        juce::FloatVectorOperations::clear (history, 2 * tapsPerPhase);
+        historyPosition = 0;
+        previousIntervalPeak = 0.0f;
+    }
+
+    void setCeiling (const float ceilingInDecibels)
+    {
+        ceiling = juce::Decibels::decibelsToGain (ceilingInDecibels);
+    }
+
+    void setReleaseTime (const float releaseTimeInSeconds)
+    {
+        releaseTime = releaseTimeInSeconds;
+        alphaRelease = releaseTime > 0.0f && sampleRate > 0.0 ? static_cast<float> (1.0 - std::exp (-1.0 / (sampleRate * releaseTime))) : 1.0f;
+    }
+
+    /** Enables the 4x oversampled true-peak detection, changing it resets the limiter. */
+    void setTruePeakDetection (const bool shouldDetectTruePeaks)
+    {
+        if (truePeakDetection != shouldDetectTruePeaks)
+        {
+            truePeakDetection = shouldDetectTruePeaks;
+            reset();
+        }
+    }
+
+    const float getMaxLevelInDecibels()
+    {
+        return maxLevel;
+    }
+
+    /** Writes the linear gains for the sidechain signal into destination. */
+    void process (const float* sideChainSignal, float* destination, const int numSamples)
+    {
+        juce::ScopedNoDenormals noDenormals;
+
+        float maxPeak = 0.0f;
+        const int capacity = lookAhead + 1;
+        const double averageGain = 1.0 / windowLength;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float peak = truePeakDetection ? getTruePeak (sideChainSignal[i]) : std::abs (sideChainSignal[i]);
+            maxPeak = juce::jmax (maxPeak, peak);
+
+            const float gain = peak > ceiling ? ceiling / peak : 1.0f;
+
+            // sliding-window minimum: the deque holds the increasing minima of the window,
+            // the expired front is evicted first, so it never holds more than windowLength entries
+            if (dequeSize > 0 && minimumIndices[dequeStart] <= sampleIndex - windowLength)
+            {
+                dequeStart = (dequeStart + 1) % capacity;
+                --dequeSize;
+            }
+
+            while (dequeSize > 0 && minimumValues[(dequeStart + dequeSize - 1) % capacity] >= gain)
+                --dequeSize;
+
+            const int back = (dequeStart + dequeSize) % capacity;
+            minimumValues[back] = gain;
+            minimumIndices[back] = sampleIndex;
+            ++dequeSize;
+
+            const float hold = minimumValues[dequeStart];
+            ++sampleIndex;
+
+            // instant attack, exponential release, it never exceeds the held minimum
+            released = hold < released ? hold : released + alphaRelease * (hold - released);
+
+            // moving average over the window
+            averageSum += released - averageBuffer[averagePosition];
+            averageBuffer[averagePosition] = released;
+            if (++averagePosition >= windowLength)
+                averagePosition = 0;
+
+            destination[i] = static_cast<float> (averageSum * averageGain);
+        }
+
+        maxLevel = juce::Decibels::gainToDecibels (maxPeak);
+    }
+
+private:
+    /**
+     Returns the largest (interpolated) magnitude around the sample truePeakLatency samples ago,
+     so the maximum of the intervals before and after that sample.
+     */
+    inline float getTruePeak (const float sample) noexcept
+    {
+        history[historyPosition] = sample;
+        history[historyPosition + tapsPerPhase] = sample;
+        const float* newest = history + historyPosition + tapsPerPhase;
+        if (++historyPosition >= tapsPerPhase)
+            historyPosition = 0;
+
+        float intervalPeak = std::abs (newest[-truePeakLatency]);
+        for (int p = 1; p < oversamplingFactor; ++p)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < tapsPerPhase; ++k)
+                sum += interpolationCoefficients[p][k] * newest[-k];
+
+            intervalPeak = juce::jmax (intervalPeak, std::abs (sum));
+        }
+
+        const float peak = juce::jmax (intervalPeak, previousIntervalPeak);
+        previousIntervalPeak = intervalPeak;
+        return peak;
+    }
+
+    //==============================================================================
+    double sampleRate {0.0};
+    int lookAhead {truePeakLatency + 1};
+    int windowLength {1};
+
+    float ceiling {1.0f};
+    float releaseTime {0.15f};
+    float alphaRelease {1.0f};
+    bool truePeakDetection {false};
+    float maxLevel {-INFINITY};
+
+    // sliding-window minimum
+    juce::HeapBlock<float> minimumValues;
+    juce::HeapBlock<juce::int64> minimumIndices;
+    int dequeStart {0}, dequeSize {0};
+    juce::int64 sampleIndex {0};
+
+    // release and moving average
+    float released {1.0f};
+    juce::HeapBlock<float> averageBuffer;
+    double averageSum {0.0};
+    int averagePosition {0};
+
+    // true-peak interpolation
+    float interpolationCoefficients[oversamplingFactor][tapsPerPhase];
+    float history[2 * tapsPerPhase];
+    int historyPosition {0};
+    float previousIntervalPeak {0.0f};
+};
@@ -43,6 +43,16 @@ OmniCompressorAudioProcessorEditor::OmniCompressorAudioProcessorEditor (OmniComp
     tbLookAhead.setButtonText("Look ahead (5ms)");
     tbLookAhead.setColour (juce::ToggleButton::tickColourId, globalLaF.ClWidgetColours[0]);
 
+    addAndMakeVisible(&tbLimiterMode);
+    tbLimiterModeAttachment.reset (new ButtonAttachment (valueTreeState, "limiterMode", tbLimiterMode));
+    tbLimiterMode.setButtonText("Limiter (5ms)");
+    tbLimiterMode.setColour (juce::ToggleButton::tickColourId, globalLaF.ClWidgetColours[0]);
+
+    addAndMakeVisible(&tbTruePeak);
+    tbTruePeakAttachment.reset (new ButtonAttachment (valueTreeState, "truePeak", tbTruePeak));
+    tbTruePeak.setButtonText("True peak (4x)");
+    tbTruePeak.setColour (juce::ToggleButton::tickColourId, globalLaF.ClWidgetColours[0]);
+
     addAndMakeVisible(&sliderKnee);
     KnAttachment.reset (new SliderAttachment (valueTreeState,"knee", sliderKnee));
     sliderKnee.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
@@ -221,6 +231,10 @@ void OmniCompressorAudioProcessorEditor::resized()
 
     area.removeFromBottom(10);
     tbLookAhead.setBounds(area.removeFromBottom(20).removeFromLeft(130));
+    area.removeFromBottom(5);
+    sliderRow = area.removeFromBottom(20);
+    tbLimiterMode.setBounds(sliderRow.removeFromLeft(130));
+    tbTruePeak.setBounds(sliderRow.removeFromLeft(130));
     area.removeFromBottom(10);
     characteristic.setBounds(area);
 
@@ -75,6 +75,8 @@ private:
 
     juce::ToggleButton tbLookAhead;
     std::unique_ptr<ButtonAttachment> tbLookAheadAttachment;
+    juce::ToggleButton tbLimiterMode, tbTruePeak;
+    std::unique_ptr<ButtonAttachment> tbLimiterModeAttachment, tbTruePeakAttachment;
 
     CompressorVisualizer characteristic;
     LevelMeter inpMeter, dbGRmeter;
@@ -50,6 +50,8 @@ createParameterLayout())
     attack = parameters.getRawParameterValue ("attack");
     release = parameters.getRawParameterValue ("release");
     lookAhead = parameters.getRawParameterValue ("lookAhead");
+    limiterMode = parameters.getRawParameterValue ("limiterMode");
+    truePeak = parameters.getRawParameterValue ("truePeak");
     reportLatency = parameters.getRawParameterValue("reportLatency");
     GR = 0.0f;
 
@@ -112,8 +114,9 @@ void OmniCompressorAudioProcessor::prepareToPlay (double sampleRate, int samples
     grProcessing.prepare (spec);
     spec.numChannels = getTotalNumInputChannels();
     delay.prepare (spec);
+    limiter.prepare (sampleRate, delay.getDelayInSamples());
 
-    if (*reportLatency >= 0.5f && *lookAhead >= 0.5f)
+    if (*reportLatency >= 0.5f && (*lookAhead >= 0.5f || *limiterMode >= 0.5f))
         setLatencySamples(delay.getDelayInSamples());
     else
         setLatencySamples(0);
@@ -139,6 +142,7 @@ void OmniCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer
     const float* bufferReadPtr = buffer.getReadPointer(0);
 
     const bool useLookAhead = *lookAhead >= 0.5f;
+    const bool useLimiter = *limiterMode >= 0.5f;
 
     if (*ratio > 15.9f)
         compressor.setRatio(INFINITY);
@@ -156,7 +160,25 @@ void OmniCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer
     for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    if (useLookAhead)
+    if (useLimiter)
+    {
+        // the threshold is the limiter's ceiling, it always looks ahead
+        limiter.setCeiling (*threshold);
+        limiter.setReleaseTime (*release * 0.001f);
+        limiter.setTruePeakDetection (*truePeak >= 0.5f);
+        limiter.process (bufferReadPtr, gains.getWritePointer(0), bufferSize);
+        maxGR = juce::Decibels::gainToDecibels (juce::FloatVectorOperations::findMinimum (gains.getReadPointer(0), bufferSize));
+
+        // delay input signal
+        {
+            juce::dsp::AudioBlock<float> ab (buffer);
+            juce::dsp::ProcessContextReplacing<float> context (ab);
+            delay.process (context);
+        }
+
+        juce::FloatVectorOperations::multiply (gains.getWritePointer(0), juce::Decibels::decibelsToGain (outGain->load()), bufferSize);
+    }
+    else if (useLookAhead)
     {
         compressor.getGainFromSidechainSignalInDecibelsWithoutMakeUpGain (bufferReadPtr, gains.getWritePointer(0), bufferSize);
         maxGR = juce::FloatVectorOperations::findMinimum(gains.getWritePointer(0), bufferSize);
@@ -184,7 +206,7 @@ void OmniCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer
         maxGR = juce::Decibels::gainToDecibels(juce::FloatVectorOperations::findMinimum(gains.getWritePointer(0), bufferSize)) - *outGain;
     }
 
-    maxRMS = compressor.getMaxLevelInDecibels();
+    maxRMS = useLimiter ? limiter.getMaxLevelInDecibels() : compressor.getMaxLevelInDecibels();
 
     for (int channel = 0; channel < numCh; ++channel)
     {
@@ -298,6 +320,14 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>> OmniCompressorAudioProc
                                      juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f), 0.0,
                                      [](float value) {return value >= 0.5f ? "ON (5ms)" : "OFF";}, nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("limiterMode", "Limiter Mode", "",
+                                     juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f), 0.0,
+                                     [](float value) {return value >= 0.5f ? "ON (5ms)" : "OFF";}, nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("truePeak", "True Peak Detection", "",
+                                     juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f), 0.0,
+                                     [](float value) {return value >= 0.5f ? "ON (4x)" : "OFF";}, nullptr));
+
     params.push_back (OSCParameterInterface::createParameterTheOldWay ("reportLatency", "Report Latency to DAW", "",
                                      juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f), 1.0f,
                                      [](float value) {
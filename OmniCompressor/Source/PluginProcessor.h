@@ -29,6 +29,7 @@
 #include "../../resources/Compressor.h"
 #include "../../resources/Delay.h"
 #include "LookAheadGainReduction.h"
+#include "LookAheadLimiter.h"
 
 #define ProcessorClass OmniCompressorAudioProcessor
 
@@ -79,6 +80,7 @@ private:
     //==============================================================================
     Delay delay;
     LookAheadGainReduction grProcessing;
+    LookAheadLimiter limiter;
 
     juce::Array<float> RMS, allGR;
     juce::AudioBuffer<float> gains;
@@ -92,6 +94,8 @@ private:
     std::atomic<float>* release;
     std::atomic<float>* knee;
     std::atomic<float>* lookAhead;
+    std::atomic<float>* limiterMode;
+    std::atomic<float>* truePeak;
     std::atomic<float>* reportLatency;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OmniCompressorAudioProcessor)
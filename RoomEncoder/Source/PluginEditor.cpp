@@ -26,9 +26,6 @@
 //==============================================================================
 RoomEncoderAudioProcessorEditor::RoomEncoderAudioProcessorEditor (RoomEncoderAudioProcessor& p, juce::AudioProcessorValueTreeState& vts)
 : juce::AudioProcessorEditor (&p), footer (p.getOSCParameterInterface()), processor (p), valueTreeState (vts),
-sourceElement(*valueTreeState.getParameter("sourceX"), valueTreeState.getParameterRange("sourceX"),
-              *valueTreeState.getParameter("sourceY"), valueTreeState.getParameterRange("sourceY"),
-              *valueTreeState.getParameter("sourceZ"), valueTreeState.getParameterRange("sourceZ")),
 listenerElement(*valueTreeState.getParameter("listenerX"), valueTreeState.getParameterRange("listenerX"),
               *valueTreeState.getParameter("listenerY"), valueTreeState.getParameterRange("listenerY"),
               *valueTreeState.getParameter("listenerZ"), valueTreeState.getParameterRange("listenerZ"))
@@ -65,7 +62,7 @@ listenerElement(*valueTreeState.getParameter("listenerX"), valueTreeState.getPar
     gcListenerPosition.setColour (juce::GroupComponent::textColourId, juce::Colours::white);
 
     addAndMakeVisible(&gcSourcePosition);
-    gcSourcePosition.setText("Source Position");
+    gcSourcePosition.setText("Source");
     gcSourcePosition.setTextLabelPosition (juce::Justification::left);
     gcSourcePosition.setColour (juce::GroupComponent::outlineColourId, globalLaF.ClSeperator);
     gcSourcePosition.setColour (juce::GroupComponent::textColourId, juce::Colours::white);
@@ -131,19 +128,43 @@ listenerElement(*valueTreeState.getParameter("listenerX"), valueTreeState.getPar
     slRoomZ.setTooltip("room size z");
     slRoomZ.addListener(this);
 
+    for (int i = 0; i < RoomEncoderAudioProcessor::maxNumberOfSources; ++i)
+    {
+        const auto xID = RoomEncoderAudioProcessor::getSourceParameterID ("sourceX", i);
+        const auto yID = RoomEncoderAudioProcessor::getSourceParameterID ("sourceY", i);
+        const auto zID = RoomEncoderAudioProcessor::getSourceParameterID ("sourceZ", i);
+        auto element = sourceElements.add (new PositionPlane::ParameterElement (*valueTreeState.getParameter (xID), valueTreeState.getParameterRange (xID),
+                                                                                 *valueTreeState.getParameter (yID), valueTreeState.getParameterRange (yID),
+                                                                                 *valueTreeState.getParameter (zID), valueTreeState.getParameterRange (zID)));
+        element->setColour (globalLaF.ClWidgetColours[2]);
+    }
+
     addAndMakeVisible(&xyPlane);
-    xyPlane.addElement(&sourceElement);
     xyPlane.addElement(&listenerElement);
     xyPlane.useAutoScale(false);
 
     addAndMakeVisible(&zyPlane);
     zyPlane.setPlane(PositionPlane::Planes::zy);
-    zyPlane.addElement(&sourceElement);
     zyPlane.addElement(&listenerElement);
     zyPlane.useAutoScale(false);
 
+    addAndMakeVisible (&cbNumberOfSources);
+    cbNumberOfSources.setJustificationType (juce::Justification::centred);
+    cbNumberOfSources.addItem ("Dir.", 1);
+    for (int i = 1; i <= RoomEncoderAudioProcessor::maxNumberOfSources; ++i)
+        cbNumberOfSources.addItem (juce::String (i), i + 1);
+    cbNumberOfSourcesAttachment.reset (new ComboBoxAttachment (valueTreeState, "numberOfSources", cbNumberOfSources));
+    cbNumberOfSources.setTooltip ("number of sources: 'Dir.' renders one source with the input as its directivity, otherwise each input channel is an omnidirectional source");
+
+    addAndMakeVisible (&lbSourceOf);
+    lbSourceOf.setText ("of");
+
+    addAndMakeVisible (&cbSourceSelect);
+    cbSourceSelect.setJustificationType (juce::Justification::centred);
+    cbSourceSelect.setTooltip ("source to edit");
+    cbSourceSelect.onChange = [this] () { attachSourceSliders (juce::jmax (0, cbSourceSelect.getSelectedId() - 1)); };
+
     addAndMakeVisible(&slSourceX);
-    slSourceXAttachment.reset (new SliderAttachment(valueTreeState, "sourceX", slSourceX));
     slSourceX.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
     slSourceX.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 50, 15);
     slSourceX.setColour (juce::Slider::rotarySliderOutlineColourId, globalLaF.ClWidgetColours[2]);
@@ -152,7 +173,6 @@ listenerElement(*valueTreeState.getParameter("listenerX"), valueTreeState.getPar
     slSourceX.addListener(this);
 
     addAndMakeVisible(&slSourceY);
-    slSourceYAttachment.reset (new SliderAttachment(valueTreeState, "sourceY", slSourceY));
     slSourceY.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
     slSourceY.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 50, 15);
     slSourceY.setColour (juce::Slider::rotarySliderOutlineColourId, globalLaF.ClWidgetColours[2]);
@@ -161,7 +181,6 @@ listenerElement(*valueTreeState.getParameter("listenerX"), valueTreeState.getPar
     slSourceY.addListener(this);
 
     addAndMakeVisible(&slSourceZ);
-    slSourceZAttachment.reset (new SliderAttachment(valueTreeState, "sourceZ", slSourceZ));
     slSourceZ.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
     slSourceZ.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 50, 15);
     slSourceZ.setColour (juce::Slider::rotarySliderOutlineColourId, globalLaF.ClWidgetColours[2]);
@@ -197,16 +216,28 @@ listenerElement(*valueTreeState.getParameter("listenerX"), valueTreeState.getPar
     slListenerZ.setTooltip("listener position z");
     slListenerZ.addListener(this);
 
-    sourceElement.setColour(globalLaF.ClWidgetColours[2]);
     listenerElement.setColour(globalLaF.ClWidgetColours[1]);
 
+    updateSourceElements (processor.getNumberOfSources());
+
     addAndMakeVisible(&lbNumReflections);
-    lbNumReflections.setText("Number of Reflections");
+    lbNumReflections.setText("Reflections");
     addAndMakeVisible(&slNumReflections);
     slNumReflectionsAttachment.reset (new SliderAttachment(valueTreeState,"numRefl", slNumReflections));
     slNumReflections.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
     slNumReflections.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 50, 15);
     slNumReflections.setColour (juce::Slider::rotarySliderOutlineColourId, globalLaF.ClWidgetColours[1]);
+    slNumReflections.setTooltip ("number of rendered image sources");
+
+    addAndMakeVisible (&lbLateTailGain);
+    lbLateTailGain.setText ("Late Tail");
+    addAndMakeVisible (&slLateTailGain);
+    slLateTailGainAttachment.reset (new SliderAttachment (valueTreeState, "lateTailGain", slLateTailGain));
+    slLateTailGain.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
+    slLateTailGain.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 50, 15);
+    slLateTailGain.setColour (juce::Slider::rotarySliderOutlineColourId, globalLaF.ClWidgetColours[1]);
+    slLateTailGain.setTextValueSuffix (" dB");
+    slLateTailGain.setTooltip ("diffuse first-order reverberation tail continuing the image sources");
 
 
     addAndMakeVisible (lbWallAttenuation);
@@ -314,7 +345,7 @@ listenerElement(*valueTreeState.getParameter("listenerX"), valueTreeState.getPar
     fv.addCoefficients(processor.highShelfCoefficients, juce::Colours::orangered, &slHighShelfFreq, &slHighShelfGain);
 
     addAndMakeVisible(&rv);
-    rv.setDataPointers (p.allGains, p.mRadius, p.numRefl);
+    rv.setDataPointers (p.allGains, p.mRadius[0], p.numRefl);
 
     juce::Vector3D<float> dims(slRoomX.getValue(), slRoomY.getValue(), slRoomZ.getValue());
     float scale = juce::jmin(xyPlane.setDimensions(dims), zyPlane.setDimensions(dims));
@@ -452,7 +483,10 @@ void RoomEncoderAudioProcessorEditor::resized()
         coordinateArea.removeFromLeft (20);
         juce::Rectangle<int> sourceArea (coordinateArea.removeFromLeft(3*rotSliderWidth+2*rotSliderSpacing));
         gcSourcePosition.setBounds (sourceArea);
-        sourceArea.removeFromTop(25);
+        juce::Rectangle<int> sourceSelectRow (sourceArea.removeFromTop(25).removeFromTop (18));
+        cbNumberOfSources.setBounds (sourceSelectRow.removeFromRight (52));
+        lbSourceOf.setBounds (sourceSelectRow.removeFromRight (18));
+        cbSourceSelect.setBounds (sourceSelectRow.removeFromRight (42));
 
         sliderRow = (sourceArea.removeFromTop(rotSliderHeight));
         slSourceX.setBounds (sliderRow.removeFromLeft(rotSliderWidth));
@@ -565,8 +599,13 @@ void RoomEncoderAudioProcessorEditor::resized()
 
 
     propArea.removeFromTop (5);
-    slNumReflections.setBounds (propArea.removeFromTop (rotSliderHeight));
-    lbNumReflections.setBounds (propArea.removeFromTop (labelHeight));
+    sliderRow = propArea.removeFromTop (rotSliderHeight);
+    slNumReflections.setBounds (sliderRow.removeFromLeft (sliderRow.getWidth() / 2));
+    slLateTailGain.setBounds (sliderRow);
+
+    sliderRow = propArea.removeFromTop (labelHeight);
+    lbNumReflections.setBounds (sliderRow.removeFromLeft (sliderRow.getWidth() / 2));
+    lbLateTailGain.setBounds (sliderRow);
 
 
     area.removeFromRight(10);
@@ -613,7 +652,55 @@ void RoomEncoderAudioProcessorEditor::timerCallback()
     if (processor.repaintPositionPlanes.get())
     {
         processor.repaintPositionPlanes = false;
+        if (processor.getNumberOfSources() != lastNumberOfSources)
+            updateSourceElements (processor.getNumberOfSources());
         xyPlane.repaint();
         zyPlane.repaint();
     }
 }
+
+void RoomEncoderAudioProcessorEditor::attachSourceSliders (const int source)
+{
+    slSourceXAttachment.reset();
+    slSourceYAttachment.reset();
+    slSourceZAttachment.reset();
+
+    slSourceXAttachment.reset (new SliderAttachment (valueTreeState, RoomEncoderAudioProcessor::getSourceParameterID ("sourceX", source), slSourceX));
+    slSourceYAttachment.reset (new SliderAttachment (valueTreeState, RoomEncoderAudioProcessor::getSourceParameterID ("sourceY", source), slSourceY));
+    slSourceZAttachment.reset (new SliderAttachment (valueTreeState, RoomEncoderAudioProcessor::getSourceParameterID ("sourceZ", source), slSourceZ));
+
+    for (int i = 0; i < sourceElements.size(); ++i)
+        sourceElements[i]->setActive (lastNumberOfSources == 1 || i == source);
+
+    xyPlane.repaint();
+    zyPlane.repaint();
+}
+
+void RoomEncoderAudioProcessorEditor::updateSourceElements (const int numberOfSources)
+{
+    const int selectedSource = juce::jlimit (0, numberOfSources - 1, cbSourceSelect.getSelectedId() - 1);
+
+    for (int i = 0; i < sourceElements.size(); ++i)
+    {
+        auto element = sourceElements[i];
+        xyPlane.removeElement (element);
+        zyPlane.removeElement (element);
+
+        if (i < numberOfSources)
+        {
+            element->setLabel (numberOfSources > 1 ? juce::String (i + 1) : juce::String());
+            xyPlane.addElement (element);
+            zyPlane.addElement (element);
+        }
+    }
+
+    lastNumberOfSources = numberOfSources;
+
+    cbSourceSelect.clear (juce::dontSendNotification);
+    for (int i = 1; i <= numberOfSources; ++i)
+        cbSourceSelect.addItem (juce::String (i), i);
+    cbSourceSelect.setEnabled (numberOfSources > 1);
+    cbSourceSelect.setSelectedId (selectedSource + 1, juce::dontSendNotification);
+
+    attachSourceSliders (selectedSource);
+}
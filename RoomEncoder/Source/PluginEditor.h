@@ -65,15 +65,26 @@ private:
 
     void timerCallback() override;
 
+    /** Attaches the source position sliders to the parameters of the given source. */
+    void attachSourceSliders (const int source);
+
+    /** Shows as many source elements in the position planes as there are sources. */
+    void updateSourceElements (const int numberOfSources);
+
     RoomEncoderAudioProcessor& processor;
     juce::AudioProcessorValueTreeState& valueTreeState;
 
-    SimpleLabel lbReflCoeff, lbNumReflections;
+    SimpleLabel lbReflCoeff, lbNumReflections, lbLateTailGain;
     TripleLabel lbRoomDim;
 
     FilterVisualizer<float> fv;
     ReflectionsVisualizer rv;
 
+    juce::ComboBox cbNumberOfSources, cbSourceSelect;
+    SimpleLabel lbSourceOf;
+    std::unique_ptr<ComboBoxAttachment> cbNumberOfSourcesAttachment;
+    int lastNumberOfSources = 0;
+
     juce::ComboBox cbSyncChannel;
     SimpleLabel lbSyncChannel;
     juce::ToggleButton tbSyncRoomSize, tbSyncReflection, tbSyncListener;
@@ -101,7 +112,7 @@ private:
     ReverseSlider slRoomX, slRoomY, slRoomZ;
 
     ReverseSlider slReflCoeff, slLowShelfFreq, slLowShelfGain, slHighShelfFreq, slHighShelfGain;
-    ReverseSlider slNumReflections;
+    ReverseSlider slNumReflections, slLateTailGain;
 
     ReverseSlider slWallAttenuationFront, slWallAttenuationBack, slWallAttenuationLeft, slWallAttenuationRight, slWallAttenuationCeiling, slWallAttenuationFloor;
 
@@ -111,7 +122,7 @@ private:
     std::unique_ptr<SliderAttachment> slRoomXAttachment, slRoomYAttachment, slRoomZAttachment;
 
     std::unique_ptr<SliderAttachment> slReflCoeffAttachment, slLowShelfFreqAttachment, slLowShelfGainAttachment, slHighShelfFreqAttachment, slHighShelfGainAttachment;
-    std::unique_ptr<SliderAttachment> slNumReflectionsAttachment;
+    std::unique_ptr<SliderAttachment> slNumReflectionsAttachment, slLateTailGainAttachment;
 
     std::unique_ptr<SliderAttachment> slWallAttenuationFrontAttachment, slWallAttenuationBackAttachment, slWallAttenuationLeftAttachment, slWallAttenuationRightAttachment, slWallAttenuationCeilingAttachment, slWallAttenuationFloorAttachment;
 
@@ -122,7 +133,8 @@ private:
     std::unique_ptr<ComboBoxAttachment> cbDirectivityNormalizationAttachment;
 
     PositionPlane xyPlane, zyPlane;
-    PositionPlane::ParameterElement sourceElement, listenerElement;
+    PositionPlane::ParameterElement listenerElement;
+    juce::OwnedArray<PositionPlane::ParameterElement> sourceElements;
 
     juce::OpenGLContext mOpenGlContext;
 
@@ -48,9 +48,14 @@ createParameterLayout())
     roomY = parameters.getRawParameterValue ("roomY");
     roomZ = parameters.getRawParameterValue ("roomZ");
 
-    sourceX = parameters.getRawParameterValue ("sourceX");
-    sourceY = parameters.getRawParameterValue ("sourceY");
-    sourceZ = parameters.getRawParameterValue ("sourceZ");
+    numberOfSources = parameters.getRawParameterValue ("numberOfSources");
+    for (int i = 0; i < maxNumberOfSources; ++i)
+    {
+        sourceX[i] = parameters.getRawParameterValue (getSourceParameterID ("sourceX", i));
+        sourceY[i] = parameters.getRawParameterValue (getSourceParameterID ("sourceY", i));
+        sourceZ[i] = parameters.getRawParameterValue (getSourceParameterID ("sourceZ", i));
+    }
+
     listenerX = parameters.getRawParameterValue ("listenerX");
     listenerY = parameters.getRawParameterValue ("listenerY");
     listenerZ = parameters.getRawParameterValue ("listenerZ");
@@ -78,6 +83,11 @@ createParameterLayout())
     wallAttenuationCeiling = parameters.getRawParameterValue ("wallAttenuationCeiling");
     wallAttenuationFloor = parameters.getRawParameterValue ("wallAttenuationFloor");
 
+    lateTailGain = parameters.getRawParameterValue ("lateTailGain");
+    cullingThreshold = parameters.getRawParameterValue ("cullingThreshold");
+    lodImageOrder = parameters.getRawParameterValue ("lodImageOrder");
+    lodAmbisonicOrder = parameters.getRawParameterValue ("lodAmbisonicOrder");
+
     parameters.addParameterListener ("directivityOrderSetting", this);
     parameters.addParameterListener ("orderSetting", this);
     parameters.addParameterListener ("lowShelfFreq", this);
@@ -89,9 +99,13 @@ createParameterLayout())
     parameters.addParameterListener ("listenerX", this);
     parameters.addParameterListener ("listenerY", this);
     parameters.addParameterListener ("listenerZ", this);
-    parameters.addParameterListener ("sourceX", this);
-    parameters.addParameterListener ("sourceY", this);
-    parameters.addParameterListener ("sourceZ", this);
+    parameters.addParameterListener ("numberOfSources", this);
+    for (int i = 0; i < maxNumberOfSources; ++i)
+    {
+        parameters.addParameterListener (getSourceParameterID ("sourceX", i), this);
+        parameters.addParameterListener (getSourceParameterID ("sourceY", i), this);
+        parameters.addParameterListener (getSourceParameterID ("sourceZ", i), this);
+    }
     parameters.addParameterListener ("roomX", this);
     parameters.addParameterListener ("roomY", this);
     parameters.addParameterListener ("roomZ", this);
@@ -105,14 +119,20 @@ createParameterLayout())
 
 
     _numRefl = 0;
+    _numSources = getNumberOfSources();
 
-    sourcePos = juce::Vector3D<float>(*sourceX, *sourceY, *sourceZ);
+    for (int s = 0; s < maxNumberOfSources; ++s)
+        sourcePos[s] = juce::Vector3D<float>(*sourceX[s], *sourceY[s], *sourceZ[s]);
     listenerPos = juce::Vector3D<float>(*listenerX, *listenerY, *listenerZ);
 
     for (int i = 0; i<nImgSrc;++i) {
-        oldDelay[i] = 44100/343.2f*interpMult; //init oldRadius
+        for (int s = 0; s < maxNumberOfSources; ++s)
+        {
+            oldDelay[s][i] = 44100/343.2f; //init oldRadius
+            juce::FloatVectorOperations::clear(SHcoeffsOld[s][i], 64);
+            reflectionIsSilent[s][i] = true;
+        }
         allGains[i] = 0.0f;
-        juce::FloatVectorOperations::clear(SHcoeffsOld[i], 64);
         juce::FloatVectorOperations::clear((float *) &SHsampleOld[i], 64);
     }
 
@@ -134,11 +154,28 @@ createParameterLayout())
         }
     }
 
+    // the outputs of the late tail's delay lines are spread evenly over the sphere (spherical Fibonacci points)
+    for (int k = 0; k < lateTailNetworkSize; ++k)
+    {
+        const float z = 1.0f - (2.0f * k + 1.0f) / lateTailNetworkSize;
+        const float r = std::sqrt (1.0f - z * z);
+        const float azi = k * juce::MathConstants<float>::pi * (3.0f - std::sqrt (5.0f));
+
+        float coeffs[lateTailNumChannels];
+        SHEval (lateTailOrder, r * std::cos (azi), r * std::sin (azi), z, coeffs, true);
+        for (int ch = 0; ch < lateTailNumChannels; ++ch)
+            lateTailEncoder[ch][k] = coeffs[ch] / std::sqrt (static_cast<float> (lateTailNetworkSize));
+    }
+
+    lateTail.setDryWet (1.0f);
+
+    startBackgroundReconfiguration();
     startTimer(50);
 }
 
 RoomEncoderAudioProcessor::~RoomEncoderAudioProcessor()
 {
+    stopBackgroundReconfiguration();
 }
 
 //==============================================================================
@@ -242,7 +279,7 @@ void RoomEncoderAudioProcessor::changeProgramName (int index, const juce::String
 //==============================================================================
 void RoomEncoderAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    dist2smpls = sampleRate/343.2f*interpMult; //factor 128 is a small hack for Lagrange lookuptable
+    dist2smpls = sampleRate/343.2f;
 
     checkInputAndOutput(this, *directivityOrderSetting, *orderSetting, true);
 
@@ -277,21 +314,35 @@ void RoomEncoderAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
     const float rYHalfBound = rY / 2 - 0.1f;
     const float rZHalfBound = rZ / 2 - 0.1f;
 
-    sourcePos = juce::Vector3D<float> (juce::jlimit (-rXHalfBound, rXHalfBound, sourceX->load()),
-                                 juce::jlimit (-rYHalfBound, rYHalfBound, sourceY->load()),
-                                 juce::jlimit (-rZHalfBound, rZHalfBound, sourceZ->load()));
-
-
     listenerPos = juce::Vector3D<float> (juce::jlimit (-rXHalfBound, rXHalfBound, listenerX->load()),
                                    juce::jlimit (-rYHalfBound, rYHalfBound, listenerY->load()),
                                    juce::jlimit (-rZHalfBound, rZHalfBound, listenerZ->load()));
 
-    calculateImageSourcePositions (rX, rY, rZ);
+    calculateRoomGeometry (rX, rY, rZ);
 
-    for (int q = 0; q < nImgSrc; ++q)
-        oldDelay[q] = mRadius[q] * dist2smpls;
+    for (int s = 0; s < maxNumberOfSources; ++s)
+    {
+        sourcePos[s] = juce::Vector3D<float> (juce::jlimit (-rXHalfBound, rXHalfBound, sourceX[s]->load()),
+                                              juce::jlimit (-rYHalfBound, rYHalfBound, sourceY[s]->load()),
+                                              juce::jlimit (-rZHalfBound, rZHalfBound, sourceZ[s]->load()));
+
+        calculateImageSourcePositions (s);
+
+        for (int q = 0; q < nImgSrc; ++q)
+            oldDelay[s][q] = mRadius[s][q] * dist2smpls;
+    }
+
+    _numSources = getNumberOfSources();
 
     updateFilterCoefficients (sampleRate);
+
+    // the network is allocated for its longest delay length, so room changes don't allocate
+    lateTail.prepare ({ sampleRate, static_cast<juce::uint32> (samplesPerBlock), static_cast<juce::uint32> (lateTailNetworkSize) });
+    lateTailActive = false;
+
+    // the delayed tail is written into the first channels and can be slightly longer than a block
+    lateTailBuffer.setSize (lateTailNetworkSize, 2 * samplesPerBlock + FractionalDelay::numTaps);
+    lateTailEncodedBuffer.setSize (lateTailNumChannels, samplesPerBlock);
 }
 
 void RoomEncoderAudioProcessor::releaseResources()
@@ -307,7 +358,7 @@ void RoomEncoderAudioProcessor::parameterChanged (const juce::String &parameterI
     }
     else if (parameterID == "lowShelfFreq" || parameterID == "lowShelfGain" ||
         parameterID == "highShelfFreq" || parameterID == "highShelfGain") userChangedFilterSettings = true;
-    else if (parameterID.startsWith("source") || parameterID.startsWith("listener"))
+    else if (parameterID.startsWith("source") || parameterID.startsWith("listener") || parameterID == "numberOfSources")
     {
         repaintPositionPlanes = true;
     }
@@ -373,26 +424,187 @@ void RoomEncoderAudioProcessor::updateFilterCoefficients (double sampleRate)
     updateFv = true;
 }
 
-void RoomEncoderAudioProcessor::calculateImageSourcePositions (const float t, const float b, const float h)
+void RoomEncoderAudioProcessor::calculateRoomGeometry (const float t, const float b, const float h)
 {
+    for (int q = 0; q < nImgSrc; ++q)
+    {
+        roomOffsetX[q] = reflectionList[q]->x * t - listenerPos.x;
+        roomOffsetY[q] = reflectionList[q]->y * b - listenerPos.y;
+        roomOffsetZ[q] = reflectionList[q]->z * h - listenerPos.z;
+    }
+}
+
+void RoomEncoderAudioProcessor::calculateImageSourcePositions (const int source)
+{
+    const auto& pos = sourcePos[source];
+    float* x = mx[source];
+    float* y = my[source];
+    float* z = mz[source];
+    float* radius = mRadius[source];
+
     for (int q = 0; q < nImgSrc; ++q)
     {
         const int m = reflectionList[q]->x;
         const int n = reflectionList[q]->y;
         const int o = reflectionList[q]->z;
-        mx[q] = m * t + mSig[m&1] * sourcePos.x - listenerPos.x;
-        my[q] = n * b + mSig[n&1] * sourcePos.y - listenerPos.y;
-        mz[q] = o * h + mSig[o&1] * sourcePos.z - listenerPos.z;
-
-        mRadius[q] = sqrt (mx[q] * mx[q] + my[q] * my[q]+ mz[q] * mz[q]);
-        mx[q] /= mRadius[q];
-        my[q] /= mRadius[q];
-        mz[q] /= mRadius[q];
-
-        jassert (mRadius[q] >= mRadius[0]);
-        smx[q] = -mSig[m & 1] * mx[q];
-        smy[q] = -mSig[n & 1] * my[q];
-        smz[q] = -mSig[o & 1] * mz[q];
+        x[q] = roomOffsetX[q] + mSig[m&1] * pos.x;
+        y[q] = roomOffsetY[q] + mSig[n&1] * pos.y;
+        z[q] = roomOffsetZ[q] + mSig[o&1] * pos.z;
+
+        radius[q] = sqrt (x[q] * x[q] + y[q] * y[q]+ z[q] * z[q]);
+        x[q] /= radius[q];
+        y[q] /= radius[q];
+        z[q] /= radius[q];
+
+        jassert (radius[q] >= radius[0]);
+    }
+
+    if (source == 0) // the source-sided directions are only needed for the directivity of a single source
+    {
+        for (int q = 0; q < nImgSrc; ++q)
+        {
+            smx[q] = -mSig[reflectionList[q]->x & 1] * x[q];
+            smy[q] = -mSig[reflectionList[q]->y & 1] * y[q];
+            smz[q] = -mSig[reflectionList[q]->z & 1] * z[q];
+        }
+    }
+}
+
+void RoomEncoderAudioProcessor::processLateTail (const int nSources, const int L, const int maxNChOut, const int currNumRefl)
+{
+    const float tailGainInDb = lateTailGain->load();
+    if (tailGainInDb < -59.95f)
+    {
+        lateTailActive = false;
+        return;
+    }
+
+    const float rX = *roomX;
+    const float rY = *roomY;
+    const float rZ = *roomZ;
+
+    // statistical room acoustics: an average path hits a wall every mean free path
+    const float volume = rX * rY * rZ;
+    const float areaX = rY * rZ; // front and back wall
+    const float areaY = rX * rZ; // left and right wall
+    const float areaZ = rX * rY; // ceiling and floor
+    const float surface = 2.0f * (areaX + areaY + areaZ);
+    const float meanFreePath = 4.0f * volume / surface;
+    const float reflectionsPerSecond = 343.2f / meanFreePath;
+
+    const float wallAttenuationInDb = (areaX * (*wallAttenuationFront + *wallAttenuationBack)
+                                       + areaY * (*wallAttenuationLeft + *wallAttenuationRight)
+                                       + areaZ * (*wallAttenuationCeiling + *wallAttenuationFloor)) / surface;
+    const float averageReflectionGain = juce::Decibels::decibelsToGain (reflCoeff->load() + wallAttenuationInDb);
+
+    // ==== network settings, only updated when they have changed
+    const float gainPerSecond = juce::jmin (std::pow (averageReflectionGain, reflectionsPerSecond), 0.794f); // T60 of at most 30s
+    if (gainPerSecond != lateTailGainPerSecond)
+    {
+        lateTail.setOverallGainPerSecond (gainPerSecond);
+        lateTailGainPerSecond = gainPerSecond;
+    }
+
+    // the network's mean delay is about 1.1ms per delay length step, it should match the mean free path
+    const int delayLength = juce::jlimit (1, 30, juce::roundToInt (meanFreePath / 343.2f * 1000.0f / 1.1f));
+    if (delayLength != lateTailDelayLength)
+    {
+        lateTail.setDelayLength (delayLength);
+        lateTailDelayLength = delayLength;
+    }
+
+    FeedbackDelayNetwork::FilterParameter lowShelf, highShelf;
+    lowShelf.frequency = *lowShelfFreq;
+    lowShelf.linearGain = juce::jmax (1.0e-6f, std::pow (juce::Decibels::decibelsToGain (lowShelfGain->load()), reflectionsPerSecond));
+    highShelf.frequency = *highShelfFreq;
+    highShelf.linearGain = juce::jmax (1.0e-6f, std::pow (juce::Decibels::decibelsToGain (highShelfGain->load()), reflectionsPerSecond));
+    if (lowShelf.frequency != lateTailLowShelf.frequency || lowShelf.linearGain != lateTailLowShelf.linearGain
+        || highShelf.frequency != lateTailHighShelf.frequency || highShelf.linearGain != lateTailHighShelf.linearGain)
+    {
+        lateTail.setFilterParameter (lowShelf, highShelf);
+        lateTailLowShelf = lowShelf;
+        lateTailHighShelf = highShelf;
+    }
+
+    // ==== onset and level: the tail takes over with the first order which isn't rendered by image sources
+    const int tailOrder = reflectionList[currNumRefl]->order + 1;
+    const double targetDelay = juce::jlimit (0.0, static_cast<double> (bufferSize - 2 * L - FractionalDelay::numTaps),
+                                             tailOrder * meanFreePath * dist2smpls);
+
+    // the image sources deliver an energy of 4 pi c / V per second (with 1/r amplitudes), the network outputs
+    // its energy once per mean delay, and the omnidirectional channel gets 1 / networkSize of it
+    const float networkMeanDelay = 1.1e-3f * delayLength;
+    const float targetInputGain = std::sqrt (lateTailNetworkSize * networkMeanDelay * 4.0f * juce::MathConstants<float>::pi * 343.2f / volume)
+                                  * std::pow (averageReflectionGain, static_cast<float> (tailOrder))
+                                  * juce::Decibels::decibelsToGain (tailGainInDb);
+
+    if (! lateTailActive)
+    {
+        // start from silence, without sweeping from an old onset
+        lateTail.reset();
+        lateTailDelay = targetDelay;
+        lateTailInputGain = 0.0f;
+        lateTailActive = true;
+    }
+
+    // ==== network input: omnidirectional part of all sources
+    float* tailInput = lateTailBuffer.getWritePointer (0);
+    juce::FloatVectorOperations::clear (tailInput, L);
+    for (int ch = 1; ch < lateTailNetworkSize; ++ch)
+        lateTailBuffer.clear (ch, 0, L);
+
+    const float gainStep = (targetInputGain - lateTailInputGain) / L;
+    for (int s = 0; s < nSources; ++s)
+    {
+        // each lane holds one source, or the zeroth order of a single source's directivity
+        const float* src = reinterpret_cast<const float*> (interleavedData[s / IIRfloat_elements]->getChannelPointer (0))
+                           + s % IIRfloat_elements;
+        const float sourceGain = *directPathUnityGain > 0.5f ? mRadius[s][0] : 1.0f;
+
+        float gain = lateTailInputGain * sourceGain;
+        const float step = gainStep * sourceGain;
+        for (int i = 0; i < L; ++i)
+        {
+            tailInput[i] += gain * src[i * IIRfloat_elements];
+            gain += step;
+        }
+    }
+    lateTailInputGain = targetInputGain;
+
+    juce::dsp::AudioBlock<float> networkBlock (lateTailBuffer.getArrayOfWritePointers(), lateTailNetworkSize, L);
+    lateTail.process (juce::dsp::ProcessContextReplacing<float> (networkBlock));
+
+    // ==== encode the delay lines' outputs as a diffuse field
+    const int nChTail = juce::jmin (maxNChOut, lateTailNumChannels);
+    for (int ch = 0; ch < nChTail; ++ch)
+    {
+        float* dest = lateTailEncodedBuffer.getWritePointer (ch);
+        const float normalization = *useSN3D > 0.5f ? n3d2sn3d[ch] : 1.0f;
+
+        juce::FloatVectorOperations::copyWithMultiply (dest, lateTailBuffer.getReadPointer (0), lateTailEncoder[ch][0] * normalization, L);
+        for (int k = 1; k < lateTailNetworkSize; ++k)
+            juce::FloatVectorOperations::addWithMultiply (dest, lateTailBuffer.getReadPointer (k), lateTailEncoder[ch][k] * normalization, L);
+    }
+
+    // ==== delay the tail to its onset, changes glide slowly so they don't click
+    const double maxDelayChange = FractionalDelay::maxReadSlope * L;
+    const double newDelay = lateTailDelay + juce::jlimit (-maxDelayChange, maxDelayChange, targetDelay - lateTailDelay);
+
+    const auto range = FractionalDelay::process (lateTailEncodedBuffer.getArrayOfReadPointers(), lateTailBuffer.getArrayOfWritePointers(),
+                                                 nChTail, L, lateTailDelay, (newDelay - lateTailDelay) / L);
+    lateTailDelay = newDelay;
+
+    int writeIdx = readOffset + range.getStart();
+    if (writeIdx >= bufferSize)
+        writeIdx -= bufferSize;
+
+    const int firstNumCopy = juce::jmin (range.getLength(), bufferSize - writeIdx);
+    const int secondNumCopy = range.getLength() - firstNumCopy;
+    for (int ch = 0; ch < nChTail; ++ch)
+    {
+        delayBuffer.addFrom (ch, writeIdx, lateTailBuffer, ch, 0, firstNumCopy);
+        if (secondNumCopy > 0)
+            delayBuffer.addFrom (ch, 0, lateTailBuffer, ch, firstNumCopy, secondNumCopy);
     }
 }
 
@@ -402,7 +614,12 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer, j
     checkInputAndOutput(this, *directivityOrderSetting, *orderSetting);
 
     // =============================== settings and parameters
-    const int maxNChIn = juce::jmin(buffer.getNumChannels(), input.getNumberOfChannels());
+    const bool multipleSources = *numberOfSources >= 0.5f;
+    // the buffer also holds the output-only channels, which must not be encoded as sources
+    const int nSources = multipleSources ? juce::jmin (getNumberOfSources(), getTotalNumInputChannels(), buffer.getNumChannels()) : 1;
+
+    // with multiple sources each input channel holds an omnidirectional source, otherwise the directivity of one source
+    const int maxNChIn = multipleSources ? nSources : juce::jmin(buffer.getNumChannels(), input.getNumberOfChannels());
     const int maxNChOut = juce::jmin(buffer.getNumChannels(), output.getNumberOfChannels());
     const int directivityOrder = input.getOrder();
     const int ambisonicOrder = output.getOrder();
@@ -423,7 +640,7 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer, j
 
     if (maxNChIn < 1)
         return;
-    
+
     // update iir filter coefficients
     if (userChangedFilterSettings) updateFilterCoefficients(sampleRate);
 
@@ -453,7 +670,7 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer, j
         size_t ch;
         for (ch = 0; ch < partial; ++ch)
         {
-            addr[ch] = buffer.getReadPointer(i * static_cast<int> (IIRfloat_elements + ch));
+            addr[ch] = buffer.getReadPointer(i * static_cast<int> (IIRfloat_elements) + static_cast<int> (ch));
         }
         for (; ch < IIRfloat_elements; ++ch)
         {
@@ -467,6 +684,12 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer, j
     int currNumRefl = juce::roundToInt (numRefl->load());
     int workingNumRefl = (currNumRefl < _numRefl) ? _numRefl : currNumRefl;
 
+    // culling threshold relative to the direct path, and the reduced order of late reflections
+    const float cullThresholdInDb = cullingThreshold->load();
+    const float cullGain = cullThresholdInDb < -119.95f ? 0.0f : juce::Decibels::decibelsToGain (cullThresholdInDb);
+    const int lodImgOrder = juce::roundToInt (lodImageOrder->load());
+    const int lodOrder = juce::jmin (ambisonicOrder, juce::roundToInt (lodAmbisonicOrder->load()));
+
 
     // calculating reflection coefficients (only if parameter changed)
     float reflCoeffGain = juce::Decibels::decibelsToGain (reflCoeff->load());
@@ -490,18 +713,22 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer, j
     //===== LIMIT MOVING SPEED OF SOURCE AND LISTENER ===============================
     const float maxDist = 30.0f / sampleRate * L; // 30 meters per second
     {
-        const juce::Vector3D<float> targetSourcePos (*sourceX, *sourceY, *sourceZ);
-        const auto sourcePosDiff = targetSourcePos - sourcePos;
-        const float sourcePosDiffLength = sourcePosDiff.length();
+        for (int s = 0; s < nSources; ++s)
+        {
+            const juce::Vector3D<float> targetSourcePos (*sourceX[s], *sourceY[s], *sourceZ[s]);
+            const auto sourcePosDiff = targetSourcePos - sourcePos[s];
+            const float sourcePosDiffLength = sourcePosDiff.length();
 
-        if (sourcePosDiffLength > maxDist)
-            sourcePos += sourcePosDiff * maxDist / sourcePosDiffLength;
-        else
-            sourcePos = targetSourcePos;
+            // sources which have just been added jump to their position
+            if (sourcePosDiffLength > maxDist && s < _numSources)
+                sourcePos[s] += sourcePosDiff * maxDist / sourcePosDiffLength;
+            else
+                sourcePos[s] = targetSourcePos;
 
-        sourcePos = juce::Vector3D<float> (juce::jlimit (-rXHalfBound, rXHalfBound, sourcePos.x),
-                                     juce::jlimit (-rYHalfBound, rYHalfBound, sourcePos.y),
-                                     juce::jlimit (-rZHalfBound, rZHalfBound, sourcePos.z));
+            sourcePos[s] = juce::Vector3D<float> (juce::jlimit (-rXHalfBound, rXHalfBound, sourcePos[s].x),
+                                                  juce::jlimit (-rYHalfBound, rYHalfBound, sourcePos[s].y),
+                                                  juce::jlimit (-rZHalfBound, rZHalfBound, sourcePos[s].z));
+        }
 
 
         const juce::Vector3D<float> listenerSourcePos (*listenerX, *listenerY, *listenerZ);
@@ -522,22 +749,40 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer, j
     const bool doRenderDirectPath = *renderDirectPath > 0.5f;
     if (doRenderDirectPath)
     {
-        // prevent division by zero when source is as listener's position
-        auto difPos = sourcePos - listenerPos;
-        const auto length = difPos.length();
-        if (length == 0.0)
-            sourcePos = listenerPos - sourcePos * 0.1f / sourcePos.length(); //Vector3D<float> (0.1f, 0.0f, 0.0f);
-        else if (length < 0.1)
-            sourcePos = listenerPos + difPos * 0.1f / length;
+        for (int s = 0; s < nSources; ++s)
+        {
+            // prevent division by zero when source is as listener's position
+            auto difPos = sourcePos[s] - listenerPos;
+            const auto length = difPos.length();
+            if (length == 0.0)
+                sourcePos[s] = listenerPos - sourcePos[s] * 0.1f / sourcePos[s].length(); //Vector3D<float> (0.1f, 0.0f, 0.0f);
+            else if (length < 0.1)
+                sourcePos[s] = listenerPos + difPos * 0.1f / length;
+        }
     }
 
     float* pMonoBufferWrite = monoBuffer.getWritePointer(0);
 
-    calculateImageSourcePositions (rX, rY, rZ);
+    // the room geometry is calculated once, each source only adds its own mirrored position
+    calculateRoomGeometry (rX, rY, rZ);
+    for (int s = 0; s < nSources; ++s)
+        calculateImageSourcePositions (s);
+
+    // sources which have just been added start without a delay sweep and fade in
+    for (int s = _numSources; s < nSources; ++s)
+    {
+        for (int q = 0; q < nImgSrc; ++q)
+        {
+            oldDelay[s][q] = mRadius[s][q] * dist2smpls;
+            juce::FloatVectorOperations::clear (SHcoeffsOld[s][q], 64);
+            reflectionIsSilent[s][q] = true;
+        }
+    }
 
 
     for (int q=0; q<workingNumRefl+1; ++q)
     {
+        // the shelving filters of the reflection orders process all sources at once
         const int idx = filterPoints.indexOf (q);
         if (idx != -1)
         {
@@ -553,235 +798,235 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer, j
             }
         }
 
-        // ========================================   CALCULATE SAMPLED MONO SIGNALS
-        /* JMZ:
-         * the following section is broken, as it hardcodes asumptions about how
-         * many floats can be stored in IIRfloat
-         */
-        IIRfloat SHsample[16]; //TODO: can be smaller: (N+1)^2/IIRfloat_elements
-        IIRfloat SHsampleStep[16];
-#if JUCE_USE_SIMD
-        juce::FloatVectorOperations::clear((float *) &SHsample->value,
-                                     IIRfloat_elements * sizeof(SHsample) / sizeof(*SHsample));
-        SHEval(directivityOrder, smx[q], smy[q], smz[q],(float *) &SHsample->value, false); // deoding -> false
-#else  /* !JUCE_USE_SIMD */
-        juce::FloatVectorOperations::clear((float *) SHsample,
-                                     IIRfloat_elements * sizeof(SHsample) / sizeof(*SHsample));
-        SHEval(directivityOrder, smx[q], smy[q], smz[q],(float *) SHsample, false); // deoding -> false
-#endif /* JUCE_USE_SIMD */
-
-        if (doInputSn3dToN3dConversion)
-            juce::FloatVectorOperations::multiply((float *) SHsample, sn3d2n3d, maxNChIn);
+        float reflectionGain = powReflCoeff[reflectionList[q]->order];
 
-        juce::Array<IIRfloat*> interleavedDataPtr;
-        interleavedDataPtr.resize(nSIMDFilters);
-        IIRfloat** intrlvdDataArrayPtr = interleavedDataPtr.getRawDataPointer();
+        // additional wall attenuations
+        float extraAttenuationInDb = 0.0f;
+        auto reflProp = *reflectionList[q];
+        extraAttenuationInDb += reflProp.xPlusReflections * *wallAttenuationFront;
+        extraAttenuationInDb += reflProp.xMinusReflections * *wallAttenuationBack;
+        extraAttenuationInDb += reflProp.yPlusReflections * *wallAttenuationLeft;
+        extraAttenuationInDb += reflProp.yMinusReflections * *wallAttenuationRight;
+        extraAttenuationInDb += reflProp.zPlusReflections * *wallAttenuationCeiling;
+        extraAttenuationInDb += reflProp.zMinusReflections * *wallAttenuationFloor;
+        reflectionGain *= juce::Decibels::decibelsToGain (extraAttenuationInDb);
 
-        for (int i = 0; i<nSIMDFilters; ++i)
+        // direct path rendering
+        if (q == 0 && ! doRenderDirectPath)
         {
-            intrlvdDataArrayPtr[i] = reinterpret_cast<IIRfloat*> (interleavedData[i]->getChannelPointer (0));
-            SHsampleStep[i] = SHsample[i]-SHsampleOld[q][i];
-            SHsampleStep[i] *= oneOverL;
-            SHsample[i] = SHsampleOld[q][i];
+            allGains[0] = 0.0f;
+            continue;
         }
 
-        for (int smpl = 0; smpl < L; ++smpl)
+        // late reflections can be encoded with a lower order, the higher channels are zero-padded
+        const int reflectionAmbisonicOrder = reflProp.order > lodImgOrder ? lodOrder : ambisonicOrder;
+        const int nChRefl = juce::jmin (maxNChOut, squares[reflectionAmbisonicOrder + 1]);
+
+        for (int s = 0; s < nSources; ++s)
         {
-            IIRfloat SIMDTemp;
-            SIMDTemp = 0.0f;
+            double delayOffset = *directPathZeroDelay > 0.5f ? mRadius[s][0] * dist2smpls : 0.0;
+            double delay = mRadius[s][q]*dist2smpls - delayOffset;
 
-            for (int i = 0; i<nSIMDFilters; ++i)
+            float gain = reflectionGain / mRadius[s][q];
+            if (*directPathUnityGain > 0.5f)
+                gain *= mRadius[s][0];
+
+            // reflections which are too quiet compared to the direct path are faded out and then skipped
+            const bool culled = q > 0 && reflectionGain * mRadius[s][0] < cullGain * mRadius[s][q];
+            const bool audible = q <= currNumRefl && ! culled;
+
+            if (s == 0)
+                allGains[q] = culled ? 0.0f : gain; // for reflectionVisualizer
+
+            if (! audible && reflectionIsSilent[s][q])
+            {
+                oldDelay[s][q] = delay;
+                continue;
+            }
+
+            // ========================================   CALCULATE SAMPLED MONO SIGNALS
+            IIRfloat SHsample[16]; //TODO: can be smaller: (N+1)^2/IIRfloat_elements
+
+            if (multipleSources)
             {
-                SIMDTemp += SHsample[i] * *(intrlvdDataArrayPtr[i]++);
-                SHsample[i] += SHsampleStep[i];
+                // each source occupies one lane of the interleaved data
+                const float* src = reinterpret_cast<const float*> (interleavedData[s / IIRfloat_elements]->getChannelPointer (0))
+                                   + s % IIRfloat_elements;
+                for (int smpl = 0; smpl < L; ++smpl)
+                    pBufferWrite[smpl] = src[smpl * IIRfloat_elements];
             }
+            else
+            {
+                /* JMZ:
+                 * the following section is broken, as it hardcodes asumptions about how
+                 * many floats can be stored in IIRfloat
+                 */
+                IIRfloat SHsampleStep[16];
 #if JUCE_USE_SIMD
-            pBufferWrite[smpl] = SIMDTemp.sum();
-#else /* !JUCE_USE_SIMD */
-            pBufferWrite[smpl] = SIMDTemp;
+                juce::FloatVectorOperations::clear((float *) &SHsample->value,
+                                             IIRfloat_elements * sizeof(SHsample) / sizeof(*SHsample));
+                SHEval(directivityOrder, smx[q], smy[q], smz[q],(float *) &SHsample->value, false); // deoding -> false
+#else  /* !JUCE_USE_SIMD */
+                juce::FloatVectorOperations::clear((float *) SHsample,
+                                             IIRfloat_elements * sizeof(SHsample) / sizeof(*SHsample));
+                SHEval(directivityOrder, smx[q], smy[q], smz[q],(float *) SHsample, false); // deoding -> false
 #endif /* JUCE_USE_SIMD */
-        }
 
-        // ============================================
-        double delayOffset = *directPathZeroDelay > 0.5f ? mRadius[0] * dist2smpls : 0.0;
-        double delay, delayStep;
-        int firstIdx, copyL;
-        delay = mRadius[q]*dist2smpls - delayOffset; // dist2smpls also contains factor 128 for LUT
-        delayStep = (delay - oldDelay[q])*oneOverL;
-
-        //calculate firstIdx and copyL
-        int startIdx = ((int)oldDelay[q])>>interpShift;
-        int stopIdx = L-1 + (((int)(oldDelay[q] + delayStep * L-1))>>interpShift); // ((int)(startIdx + delayStep * L-1))>>7
-        firstIdx = juce::jmin (startIdx, stopIdx);
-        copyL = abs(stopIdx-startIdx) + interpLength;
-
-        monoBuffer.clear(0,firstIdx, copyL); //TODO: optimization idea: resample input to match delay stretching
-
-        float* tempWritePtr = pMonoBufferWrite; //reset writePtr as it gets increased during the next for loop
-        const float* readPtr = pBufferRead;
-
-        double tempDelay = oldDelay[q]; //start from oldDelay and add delayStep after each interation;
-
-        //int interpCoeffIdx;
-        for (int smplIdx = 0; smplIdx < L; ++smplIdx) {
-            //int delayInt; = truncatePositiveToUnsignedInt(tempDelay); //(int)tempDelay;
-            float integer;
-            float fraction = modff(tempDelay, &integer);
-            int delayInt = (int) integer;
-
-            int interpCoeffIdx = delayInt&interpMask;
-            delayInt = delayInt>>interpShift;
-            int idx = delayInt;
-
-
-            float* dest = tempWritePtr++ + idx;
-
-#if JUCE_USE_SSE_INTRINSICS
-            __m128 destSamples = _mm_loadu_ps(dest);
-            __m128 srcSample = _mm_set1_ps(*readPtr++);
-            __m128 interp = getInterpolatedLagrangeWeights(interpCoeffIdx, fraction);
-
-            destSamples = _mm_add_ps(destSamples, _mm_mul_ps(interp, srcSample));
-            _mm_storeu_ps(dest, destSamples);
-#else /* !JUCE_USE_SSE_INTRINSICS */
-            float interp[4];
-            getInterpolatedLagrangeWeights(interpCoeffIdx, fraction, interp);
-            float src = *readPtr++;
-            dest[0] += interp[0] * src;
-            dest[1] += interp[1] * src;
-            dest[2] += interp[2] * src;
-            dest[3] += interp[3] * src;
-#endif /* JUCE_USE_SSE_INTRINSICS */
-            tempDelay += delayStep;
-        }
+                if (doInputSn3dToN3dConversion)
+                    juce::FloatVectorOperations::multiply((float *) SHsample, sn3d2n3d, maxNChIn);
 
-        const float* monoBufferReadPtrWithOffset = monoBuffer.getReadPointer(0) + firstIdx;
-        firstIdx = firstIdx + readOffset;
-        if (firstIdx >= bufferSize)
-            firstIdx -= bufferSize;
+                juce::Array<IIRfloat*> interleavedDataPtr;
+                interleavedDataPtr.resize(nSIMDFilters);
+                IIRfloat** intrlvdDataArrayPtr = interleavedDataPtr.getRawDataPointer();
 
-        float SHcoeffs[64];
-        float SHcoeffsStep[64];
+                for (int i = 0; i<nSIMDFilters; ++i)
+                {
+                    intrlvdDataArrayPtr[i] = reinterpret_cast<IIRfloat*> (interleavedData[i]->getChannelPointer (0));
+                    SHsampleStep[i] = SHsample[i]-SHsampleOld[q][i];
+                    SHsampleStep[i] *= oneOverL;
+                    SHsample[i] = SHsampleOld[q][i];
+                }
 
-        if (q<=currNumRefl)
-        {
-            SHEval(ambisonicOrder, mx[q], my[q], mz[q], SHcoeffs, true); // encoding -> true
-            if (*useSN3D > 0.5f)
-            {
-                juce::FloatVectorOperations::multiply(SHcoeffs, SHcoeffs, n3d2sn3d, maxNChOut);
+                for (int smpl = 0; smpl < L; ++smpl)
+                {
+                    IIRfloat SIMDTemp;
+                    SIMDTemp = 0.0f;
+
+                    for (int i = 0; i<nSIMDFilters; ++i)
+                    {
+                        SIMDTemp += SHsample[i] * *(intrlvdDataArrayPtr[i]++);
+                        SHsample[i] += SHsampleStep[i];
+                    }
+#if JUCE_USE_SIMD
+                    pBufferWrite[smpl] = SIMDTemp.sum();
+#else /* !JUCE_USE_SIMD */
+                    pBufferWrite[smpl] = SIMDTemp;
+#endif /* JUCE_USE_SIMD */
+                }
             }
-        }
-        else
-            juce::FloatVectorOperations::clear(SHcoeffs, 64);
 
-        float gain = powReflCoeff[reflectionList[q]->order] / mRadius[q];
-        if (*directPathUnityGain > 0.5f)
-            gain *= mRadius[0];
+            // ============================================
+            int firstIdx, copyL;
+            const double delayStep = (delay - oldDelay[s][q])*oneOverL;
 
-        // additional wall attenuations
-        float extraAttenuationInDb = 0.0f;
-        auto reflProp = *reflectionList[q];
-        extraAttenuationInDb += reflProp.xPlusReflections * *wallAttenuationFront;
-        extraAttenuationInDb += reflProp.xMinusReflections * *wallAttenuationBack;
-        extraAttenuationInDb += reflProp.yPlusReflections * *wallAttenuationLeft;
-        extraAttenuationInDb += reflProp.yMinusReflections * *wallAttenuationRight;
-        extraAttenuationInDb += reflProp.zPlusReflections * *wallAttenuationCeiling;
-        extraAttenuationInDb += reflProp.zMinusReflections * *wallAttenuationFloor;
-        gain *= juce::Decibels::decibelsToGain (extraAttenuationInDb);
+            // writes the delayed signal into the monoBuffer, starting with its first sample
+            const auto range = FractionalDelay::process (&pBufferRead, &pMonoBufferWrite, 1, L, oldDelay[s][q], delayStep);
+            firstIdx = range.getStart();
+            copyL = range.getLength();
 
-        // direct path rendering
-        if (q == 0 && ! doRenderDirectPath)
-        {
-            allGains[0] = 0.0f;
-            continue;
-        }
+            const float* monoBufferReadPtrWithOffset = monoBuffer.getReadPointer(0);
+            firstIdx = firstIdx + readOffset;
+            if (firstIdx >= bufferSize)
+                firstIdx -= bufferSize;
 
-        allGains[q] = gain; // for reflectionVisualizer
+            float SHcoeffs[64];
+            float SHcoeffsStep[64];
+            float* SHcoeffsOldPtr = SHcoeffsOld[s][q];
 
-        juce::FloatVectorOperations::multiply(SHcoeffs, gain, maxNChOut);
-        juce::FloatVectorOperations::subtract(SHcoeffsStep, SHcoeffs, SHcoeffsOld[q], maxNChOut);
-        juce::FloatVectorOperations::multiply(SHcoeffsStep, 1.0f/copyL, maxNChOut);
+            if (audible)
+            {
+                SHEval(reflectionAmbisonicOrder, mx[s][q], my[s][q], mz[s][q], SHcoeffs, true); // encoding -> true
+                juce::FloatVectorOperations::clear (SHcoeffs + nChRefl, maxNChOut - nChRefl);
+                if (*useSN3D > 0.5f)
+                {
+                    juce::FloatVectorOperations::multiply(SHcoeffs, SHcoeffs, n3d2sn3d, maxNChOut);
+                }
+            }
+            else
+                juce::FloatVectorOperations::clear(SHcoeffs, 64);
 
-        if (firstIdx + copyL - 1 >= bufferSize)
-        {
-            int firstNumCopy = bufferSize - firstIdx;
-            int secondNumCopy = copyL-firstNumCopy;
+            juce::FloatVectorOperations::multiply(SHcoeffs, gain, maxNChOut);
+            juce::FloatVectorOperations::subtract(SHcoeffsStep, SHcoeffs, SHcoeffsOldPtr, maxNChOut);
+            juce::FloatVectorOperations::multiply(SHcoeffsStep, 1.0f/copyL, maxNChOut);
 
-            for (int channel = 0; channel < maxNChOut; ++channel)
+            if (firstIdx + copyL - 1 >= bufferSize)
             {
-                if (SHcoeffsOld[q][channel] != SHcoeffs[channel])
+                int firstNumCopy = bufferSize - firstIdx;
+                int secondNumCopy = copyL-firstNumCopy;
+
+                for (int channel = 0; channel < maxNChOut; ++channel)
                 {
+                    if (SHcoeffsOldPtr[channel] != SHcoeffs[channel])
+                    {
 #if defined(JUCE_USE_VDSP_FRAMEWORK) && defined(JUCE_MAC)
-                    vDSP_vrampmuladd(monoBufferReadPtrWithOffset, 1, //input vector with stride
-                                     &SHcoeffsOld[q][channel], //ramp start value (gets increased)
-                                     &SHcoeffsStep[channel], //step value
-                                     delayBufferWritePtrArray[channel] + firstIdx, 1,// output with stride
-                                     (size_t) firstNumCopy //num
-                                     );
-                    vDSP_vrampmuladd(monoBufferReadPtrWithOffset+firstNumCopy, 1, //input vector with stride
-                                     &SHcoeffsOld[q][channel], //ramp start value (gets increased)
-                                     &SHcoeffsStep[channel], //step value
-                                     delayBufferWritePtrArray[channel], 1,// output with stride
-                                     (size_t) secondNumCopy //num
-                                     );
+                        vDSP_vrampmuladd(monoBufferReadPtrWithOffset, 1, //input vector with stride
+                                         &SHcoeffsOldPtr[channel], //ramp start value (gets increased)
+                                         &SHcoeffsStep[channel], //step value
+                                         delayBufferWritePtrArray[channel] + firstIdx, 1,// output with stride
+                                         (size_t) firstNumCopy //num
+                                         );
+                        vDSP_vrampmuladd(monoBufferReadPtrWithOffset+firstNumCopy, 1, //input vector with stride
+                                         &SHcoeffsOldPtr[channel], //ramp start value (gets increased)
+                                         &SHcoeffsStep[channel], //step value
+                                         delayBufferWritePtrArray[channel], 1,// output with stride
+                                         (size_t) secondNumCopy //num
+                                         );
 #else
-                    delayBuffer.addFromWithRamp(channel, firstIdx, monoBufferReadPtrWithOffset, firstNumCopy,
-                                                SHcoeffsOld[q][channel], SHcoeffsOld[q][channel] + SHcoeffsStep[channel]*firstNumCopy);
-                    delayBuffer.addFromWithRamp(channel, 0,        monoBufferReadPtrWithOffset+firstNumCopy, secondNumCopy,
-                                                SHcoeffsOld[q][channel] + SHcoeffsStep[channel]*firstNumCopy, SHcoeffs[channel]);
+                        delayBuffer.addFromWithRamp(channel, firstIdx, monoBufferReadPtrWithOffset, firstNumCopy,
+                                                    SHcoeffsOldPtr[channel], SHcoeffsOldPtr[channel] + SHcoeffsStep[channel]*firstNumCopy);
+                        delayBuffer.addFromWithRamp(channel, 0,        monoBufferReadPtrWithOffset+firstNumCopy, secondNumCopy,
+                                                    SHcoeffsOldPtr[channel] + SHcoeffsStep[channel]*firstNumCopy, SHcoeffs[channel]);
 #endif
-                }
-                else
-                {
-                    juce::FloatVectorOperations::addWithMultiply(delayBufferWritePtrArray[channel] + firstIdx,
-                                                           monoBufferReadPtrWithOffset,
-                                                           SHcoeffs[channel], firstNumCopy);
-                    juce::FloatVectorOperations::addWithMultiply(delayBufferWritePtrArray[channel],
-                                                           monoBufferReadPtrWithOffset + firstNumCopy,
-                                                           SHcoeffs[channel], secondNumCopy);
+                    }
+                    else if (SHcoeffs[channel] != 0.0f)
+                    {
+                        juce::FloatVectorOperations::addWithMultiply(delayBufferWritePtrArray[channel] + firstIdx,
+                                                               monoBufferReadPtrWithOffset,
+                                                               SHcoeffs[channel], firstNumCopy);
+                        juce::FloatVectorOperations::addWithMultiply(delayBufferWritePtrArray[channel],
+                                                               monoBufferReadPtrWithOffset + firstNumCopy,
+                                                               SHcoeffs[channel], secondNumCopy);
+                    }
                 }
             }
-        }
-        else
-        {
-            for (int channel = 0; channel < maxNChOut; ++channel)
+            else
             {
-                if (SHcoeffsOld[q][channel] != SHcoeffs[channel])
+                for (int channel = 0; channel < maxNChOut; ++channel)
                 {
+                    if (SHcoeffsOldPtr[channel] != SHcoeffs[channel])
+                    {
 #if defined(JUCE_USE_VDSP_FRAMEWORK) && defined(JUCE_MAC)
-                    vDSP_vrampmuladd(monoBufferReadPtrWithOffset, 1, //input vector with stride
-                                     &SHcoeffsOld[q][channel], //ramp start value (gets increased)
-                                     &SHcoeffsStep[channel], //step value
-                                     delayBufferWritePtrArray[channel] + firstIdx, 1,// output with stride
-                                     (size_t) copyL //num
-                                     );
+                        vDSP_vrampmuladd(monoBufferReadPtrWithOffset, 1, //input vector with stride
+                                         &SHcoeffsOldPtr[channel], //ramp start value (gets increased)
+                                         &SHcoeffsStep[channel], //step value
+                                         delayBufferWritePtrArray[channel] + firstIdx, 1,// output with stride
+                                         (size_t) copyL //num
+                                         );
 #else
-                    delayBuffer.addFromWithRamp(channel, firstIdx, monoBufferReadPtrWithOffset, copyL, SHcoeffsOld[q][channel], SHcoeffs[channel]);
+                        delayBuffer.addFromWithRamp(channel, firstIdx, monoBufferReadPtrWithOffset, copyL, SHcoeffsOldPtr[channel], SHcoeffs[channel]);
 #endif
-                }
-                else
-                {
-                    juce::FloatVectorOperations::addWithMultiply(delayBufferWritePtrArray[channel] + firstIdx,
-                                                           monoBufferReadPtrWithOffset,
-                                                           SHcoeffs[channel], copyL);
-                }
+                    }
+                    else if (SHcoeffs[channel] != 0.0f)
+                    {
+                        juce::FloatVectorOperations::addWithMultiply(delayBufferWritePtrArray[channel] + firstIdx,
+                                                               monoBufferReadPtrWithOffset,
+                                                               SHcoeffs[channel], copyL);
+                    }
 
+                }
             }
-        }
 
-        juce::FloatVectorOperations::copy(SHcoeffsOld[q], SHcoeffs, maxNChOut);
+            juce::FloatVectorOperations::copy(SHcoeffsOldPtr, SHcoeffs, maxNChOut);
+            reflectionIsSilent[s][q] = ! audible;
+            if (! multipleSources)
+            {
 #if JUCE_USE_SIMD
-        juce::FloatVectorOperations::copy((float *) &SHsampleOld[q]->value, (float *) &SHsample->value, maxNChIn);
+                juce::FloatVectorOperations::copy((float *) &SHsampleOld[q]->value, (float *) &SHsample->value, maxNChIn);
 #else  /* !JUCE_USE_SIMD */
-        juce::FloatVectorOperations::copy((float *) SHsampleOld[q], (float *) SHsample, maxNChIn);
+                juce::FloatVectorOperations::copy((float *) SHsampleOld[q], (float *) SHsample, maxNChIn);
 #endif /* JUCE_USE_SIMD */
-        //oldDelay[q] = delay;
-        oldDelay[q] = tempDelay;
+            }
+            oldDelay[s][q] = delay;
+        }
     }
 
     //updating the remaining oldDelay values
-    for (int q = workingNumRefl + 1; q < nImgSrc; ++q)
-        oldDelay[q] = mRadius[q]*dist2smpls;
+    for (int s = 0; s < nSources; ++s)
+        for (int q = workingNumRefl + 1; q < nImgSrc; ++q)
+            oldDelay[s][q] = mRadius[s][q]*dist2smpls;
+
+    // the interleaved data now carries the shelving filters of the last rendered order
+    processLateTail (nSources, L, maxNChOut, currNumRefl);
 
     // ======= Read from delayBuffer and clear read content ==============
     buffer.clear();
@@ -805,6 +1050,7 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer, j
     }
 
     _numRefl = currNumRefl;
+    _numSources = nSources;
 
     readOffset += L;
     if (readOffset >= bufferSize) readOffset -= bufferSize;
@@ -933,24 +1179,41 @@ void RoomEncoderAudioProcessor::timerCallback()
 }
 
 
-void RoomEncoderAudioProcessor::updateBuffers()
+std::unique_ptr<IOConfiguration> RoomEncoderAudioProcessor::prepareConfiguration (const IOTypes::Ambisonics<>& newInput, const IOTypes::Ambisonics<>& newOutput)
 {
-    DBG("IOHelper:  input size: " << input.getSize());
-    DBG("IOHelper: output size: " << output.getSize());
+    juce::ignoreUnused (newInput);
 
-    const int nChOut = output.getNumberOfChannels();
+    const int nChOut = newOutput.getNumberOfChannels();
     const int samplesPerBlock = getBlockSize();
 
-    bufferSize = round (180.0f / 343.2f * getSampleRate()) + samplesPerBlock + 100;
-    bufferSize += samplesPerBlock - bufferSize%samplesPerBlock;
+    auto delayLines = std::make_unique<DelayLines>();
+
+    int newBufferSize = round (180.0f / 343.2f * getSampleRate()) + samplesPerBlock + 100;
+    newBufferSize += samplesPerBlock - newBufferSize%samplesPerBlock;
+    delayLines->bufferSize = newBufferSize;
+
+    delayLines->monoBuffer.setSize(1, newBufferSize);
+    delayLines->monoBuffer.clear();
+
+    delayLines->delayBuffer.setSize(nChOut, newBufferSize);
+    delayLines->delayBuffer.clear();
+
+    return delayLines;
+}
+
+void RoomEncoderAudioProcessor::applyConfiguration (IOConfiguration& newConfiguration)
+{
+    auto& delayLines = static_cast<DelayLines&> (newConfiguration);
 
-    monoBuffer.setSize(1, bufferSize);
-    monoBuffer.clear();
+    // swapping doesn't (de)allocate, the old buffers are released with the configuration
+    bufferSize = delayLines.bufferSize;
+    std::swap (delayBuffer, delayLines.delayBuffer);
+    std::swap (monoBuffer, delayLines.monoBuffer);
 
-    delayBuffer.setSize(nChOut, bufferSize);
-    delayBuffer.clear();
+    if (readOffset >= bufferSize)
+        readOffset = 0;
 
-    if (input.getSize() != input.getPreviousSize())
+    if (inputSizeHasChanged)
     {
         for (int i = 0; i<interleavedData.size(); ++i)
         {
@@ -1014,6 +1277,13 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>> RoomEncoderAudioProcess
                                      juce::NormalisableRange<float> (1.0f, 20.0f, 0.01f), 7.0f,
                                      [](float value) { return juce::String(value, 2); }, nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("numberOfSources", "Number of Sources", "",
+                                     juce::NormalisableRange<float> (0.0f, maxNumberOfSources, 1.0f), 0.0f,
+                                     [](float value) {
+                                         if (value < 0.5f) return juce::String ("Directivity");
+                                         else return juce::String ((int) value); },
+                                     nullptr));
+
     params.push_back (OSCParameterInterface::createParameterTheOldWay ("sourceX", "source position x", "m",
                                      juce::NormalisableRange<float> (-15.0f, 15.0f, 0.001f), 1.0f,
                                      [](float value) { return juce::String(value, 3); }, nullptr));
@@ -1024,6 +1294,21 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>> RoomEncoderAudioProcess
                                      juce::NormalisableRange<float> (-10.0f, 10.0f, 0.001f), -1.0f,
                                      [](float value) { return juce::String(value, 3); }, nullptr));
 
+    // further sources are placed on a circle around the room's centre
+    for (int i = 1; i < maxNumberOfSources; ++i)
+    {
+        const float angle = juce::MathConstants<float>::twoPi * i / maxNumberOfSources;
+        params.push_back (OSCParameterInterface::createParameterTheOldWay (getSourceParameterID ("sourceX", i), "source position x " + juce::String (i + 1), "m",
+                                         juce::NormalisableRange<float> (-15.0f, 15.0f, 0.001f), std::round (2000.0f * std::cos (angle)) / 1000.0f,
+                                         [](float value) { return juce::String(value, 3); }, nullptr));
+        params.push_back (OSCParameterInterface::createParameterTheOldWay (getSourceParameterID ("sourceY", i), "source position y " + juce::String (i + 1), "m",
+                                         juce::NormalisableRange<float> (-15.0f, 15.0f, 0.001f), std::round (2000.0f * std::sin (angle)) / 1000.0f,
+                                         [](float value) { return juce::String(value, 3); }, nullptr));
+        params.push_back (OSCParameterInterface::createParameterTheOldWay (getSourceParameterID ("sourceZ", i), "source position z " + juce::String (i + 1), "m",
+                                         juce::NormalisableRange<float> (-10.0f, 10.0f, 0.001f), -1.0f,
+                                         [](float value) { return juce::String(value, 3); }, nullptr));
+    }
+
     params.push_back (OSCParameterInterface::createParameterTheOldWay ("listenerX", "listener position x", "m",
                                      juce::NormalisableRange<float> (-15.0f, 15.0f, 0.001f), -1.0f,
                                      [](float value) { return juce::String(value, 3); }, nullptr));
@@ -1038,6 +1323,31 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>> RoomEncoderAudioProcess
                                      juce::NormalisableRange<float> (0.0f, nImgSrc-1, 1.0f), 33.0f,
                                      [](float value) { return juce::String((int) value); }, nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("lateTailGain", "Late Tail Gain", "dB",
+                                     juce::NormalisableRange<float> (-60.0f, 12.0f, 0.1f), -60.0f,
+                                     [](float value) {
+                                         if (value < -59.95f) return juce::String ("off");
+                                         else return juce::String (value, 1); },
+                                     nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("cullingThreshold", "Culling Threshold", "dB",
+                                     juce::NormalisableRange<float> (-120.0f, -20.0f, 0.1f), -120.0f,
+                                     [](float value) {
+                                         if (value < -119.95f) return juce::String ("off");
+                                         else return juce::String (value, 1); },
+                                     nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("lodImageOrder", "Reduced Order above Image Order", "",
+                                     juce::NormalisableRange<float> (0.0f, maxOrderImgSrc, 1.0f), maxOrderImgSrc,
+                                     [](float value) {
+                                         if (value >= maxOrderImgSrc - 0.5f) return juce::String ("off");
+                                         else return juce::String ((int) value); },
+                                     nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("lodAmbisonicOrder", "Reduced Ambisonics Order", "",
+                                     juce::NormalisableRange<float> (0.0f, 7.0f, 1.0f), 3.0f,
+                                     [](float value) { return juce::String ((int) value); }, nullptr));
+
     params.push_back (OSCParameterInterface::createParameterTheOldWay ("lowShelfFreq", "LowShelf Frequency", "Hz",
                                      juce::NormalisableRange<float> (20.0f, 20000.0f, 1.0f, 0.2f), 100.0,
                                      [](float value) { return juce::String((int) value); }, nullptr));
@@ -25,7 +25,8 @@
 #pragma once
 
 #include "../JuceLibraryCode/JuceHeader.h"
-#include "../../resources/interpLagrangeWeights.h"
+#include "../../resources/FractionalDelay.h"
+#include "../../resources/FeedbackDelayNetwork.h"
 #include "../../resources/efficientSHvanilla.h"
 #include "reflections.h"
 #include "../../resources/ambisonicTools.h"
@@ -96,6 +97,7 @@ class RoomEncoderAudioProcessor  :  public AudioProcessorBase<IOTypes::Ambisonic
 public:
     constexpr static int numberOfInputChannels = 64;
     constexpr static int numberOfOutputChannels = 64;
+    constexpr static int maxNumberOfSources = 16;
     //==============================================================================
     RoomEncoderAudioProcessor();
     ~RoomEncoderAudioProcessor();
@@ -131,8 +133,17 @@ public:
     //======= Parameters ===========================================================
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> createParameterLayout();
 
+    /** Returns the ID of a source position parameter, e.g. "sourceX" for the first and "sourceX2" for the second source. */
+    static juce::String getSourceParameterID (const juce::String& coordinate, const int source)
+    {
+        return source == 0 ? coordinate : coordinate + juce::String (source + 1);
+    }
+
+    /** Returns the number of rendered sources, which is one when the input holds the directivity of a single source. */
+    int getNumberOfSources() const { return juce::jmax (1, juce::roundToInt (numberOfSources->load())); }
+
     //==============================================================================
-    double oldDelay[nImgSrc];
+    double oldDelay[maxNumberOfSources][nImgSrc];
     float allGains[nImgSrc];
 
     //filter coefficients
@@ -145,12 +156,15 @@ public:
     void timerCallback() override;
 
     void updateFilterCoefficients (double sampleRate);
-    void calculateImageSourcePositions (const float t, const float b, const float h);
+    void calculateRoomGeometry (const float t, const float b, const float h);
+    void calculateImageSourcePositions (const int source);
+    void processLateTail (const int nSources, const int L, const int maxNChOut, const int currNumRefl);
 
     std::atomic<float>* numRefl;
-    float mRadius[nImgSrc];
+    float mRadius[maxNumberOfSources][nImgSrc];
 
-    void updateBuffers() override;
+    std::unique_ptr<IOConfiguration> prepareConfiguration (const IOTypes::Ambisonics<>& newInput, const IOTypes::Ambisonics<>& newOutput) override;
+    void applyConfiguration (IOConfiguration& newConfiguration) override;
 
     juce::Atomic<bool> repaintPositionPlanes = true;
 
@@ -173,9 +187,10 @@ private:
     std::atomic<float>* roomY;
     std::atomic<float>* roomZ;
 
-    std::atomic<float>* sourceX;
-    std::atomic<float>* sourceY;
-    std::atomic<float>* sourceZ;
+    std::atomic<float>* numberOfSources;
+    std::atomic<float>* sourceX[maxNumberOfSources];
+    std::atomic<float>* sourceY[maxNumberOfSources];
+    std::atomic<float>* sourceZ[maxNumberOfSources];
 
     std::atomic<float>* listenerX;
     std::atomic<float>* listenerY;
@@ -204,7 +219,13 @@ private:
     std::atomic<float>* wallAttenuationCeiling;
     std::atomic<float>* wallAttenuationFloor;
 
+    std::atomic<float>* lateTailGain;
+    std::atomic<float>* cullingThreshold;
+    std::atomic<float>* lodImageOrder;
+    std::atomic<float>* lodAmbisonicOrder;
+
     int _numRefl;
+    int _numSources;
 
     juce::SharedResourcePointer<SharedParams> sharedParams;
 
@@ -218,11 +239,16 @@ private:
 
     juce::Array<int> filterPoints {1, 7, 25, 61, 113, 169, 213};
 
-    juce::Vector3D<float> sourcePos, listenerPos;
+    juce::Vector3D<float> sourcePos[maxNumberOfSources], listenerPos;
 
-    float mx[nImgSrc];
-    float my[nImgSrc];
-    float mz[nImgSrc];
+    // image source positions relative to the listener without the source's contribution, shared by all sources
+    float roomOffsetX[nImgSrc];
+    float roomOffsetY[nImgSrc];
+    float roomOffsetZ[nImgSrc];
+
+    float mx[maxNumberOfSources][nImgSrc];
+    float my[maxNumberOfSources][nImgSrc];
+    float mz[maxNumberOfSources][nImgSrc];
     float smx[nImgSrc];
     float smy[nImgSrc];
     float smz[nImgSrc];
@@ -230,18 +256,44 @@ private:
     int bufferSize;
     int bufferReadIdx;
 
-    int readOffset;
+    int readOffset = 0;
 
     float powReflCoeff[maxOrderImgSrc+1];
     double dist2smpls;
 
-    float SHcoeffsOld[nImgSrc][64];
+    float SHcoeffsOld[maxNumberOfSources][nImgSrc][64];
+    bool reflectionIsSilent[maxNumberOfSources][nImgSrc]; // SHcoeffsOld are all zero, so culled reflections can be skipped
     IIRfloat SHsampleOld[nImgSrc][16]; //TODO: can be smaller: (N+1)^2/IIRfloat_elements()
 
     juce::AudioBuffer<float> delayBuffer;
     juce::AudioBuffer<float> monoBuffer;
 
+    // the delay lines are allocated in the background and swapped in when the output order changes
+    struct DelayLines : public IOConfiguration
+    {
+        int bufferSize;
+        juce::AudioBuffer<float> delayBuffer;
+        juce::AudioBuffer<float> monoBuffer;
+    };
+
     juce::OwnedArray<ReflectionProperty> reflectionList;
 
+    // diffuse late tail which continues the image sources, rendered in first order
+    static constexpr int lateTailOrder = 1;
+    static constexpr int lateTailNumChannels = (lateTailOrder + 1) * (lateTailOrder + 1);
+    static constexpr int lateTailNetworkSize = FeedbackDelayNetwork::tiny;
+
+    FeedbackDelayNetwork lateTail { FeedbackDelayNetwork::tiny };
+    juce::AudioBuffer<float> lateTailBuffer;
+    juce::AudioBuffer<float> lateTailEncodedBuffer;
+    float lateTailEncoder[lateTailNumChannels][lateTailNetworkSize];
+    bool lateTailActive = false;
+    float lateTailInputGain = 0.0f;
+    double lateTailDelay = 0.0;
+
+    float lateTailGainPerSecond = -1.0f;
+    int lateTailDelayLength = -1;
+    FeedbackDelayNetwork::FilterParameter lateTailLowShelf, lateTailHighShelf;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RoomEncoderAudioProcessor)
 };
@@ -31,7 +31,7 @@ SceneRotatorAudioProcessorEditor::SceneRotatorAudioProcessorEditor (SceneRotator
     // ============== BEGIN: essentials ======================
     // set GUI size and lookAndFeel
     //setSize(500, 300); // use this to create a fixed-size GUI
-    setResizeLimits (450, 320, 800, 500); // use this to create a resizable GUI
+    setResizeLimits (450, 345, 800, 500); // use this to create a resizable GUI
     setLookAndFeel (&globalLaF);
 
     // make title and footer visible, and set the PluginName
@@ -189,6 +189,11 @@ SceneRotatorAudioProcessorEditor::SceneRotatorAudioProcessorEditor (SceneRotator
     addAndMakeVisible (slMidiScheme);
     slMidiScheme.setText ("Scheme");
 
+    addAndMakeVisible (tbSubBlockUpdates);
+    tbSubBlockUpdatesAttachment.reset (new ButtonAttachment (valueTreeState, "subBlockUpdates", tbSubBlockUpdates));
+    tbSubBlockUpdates.setButtonText ("Update rotation every 16 samples");
+    tbSubBlockUpdates.setTooltip ("Follows fast head movements along the actual rotation path instead of fading linearly between the matrices of two blocks.");
+
     tooltipWin.setLookAndFeel (&globalLaF);
     tooltipWin.setMillisecondsBeforeTipAppears (500);
     tooltipWin.setOpaque (false);
@@ -315,6 +320,9 @@ void SceneRotatorAudioProcessorEditor::resized()
     slMidiScheme.setBounds (row.removeFromLeft (48));
     cbMidiScheme.setBounds (row.removeFromLeft (140));
 
+    area.removeFromTop (5);
+    tbSubBlockUpdates.setBounds (area.removeFromTop (20).removeFromLeft (250));
+
 }
 
 void SceneRotatorAudioProcessorEditor::timerCallback()
@@ -106,6 +106,9 @@ private:
     SimpleLabel slMidiDevices, slMidiScheme;
     juce::ComboBox cbMidiDevices, cbMidiScheme;
 
+    juce::ToggleButton tbSubBlockUpdates;
+    std::unique_ptr<ButtonAttachment> tbSubBlockUpdatesAttachment;
+
     juce::Atomic<bool> refreshingMidiDevices = false;
     juce::Atomic<bool> updatingMidiScheme = false;
 
@@ -20,24 +20,6 @@
  ==============================================================================
  */
 
-/*
- The computation of Ambisonic rotation matrices is done by the recursive method
- of Ivanic and Ruedenberg:
-
-    Ivanic, J., Ruedenberg, K. (1996). Rotation Matrices for Real Spherical
-    Harmonics. Direct Determination by Recursion. The Journal of Physical
-    Chemistry, 100(15), 6342?6347.
-
- Including their corrections:
-
-    Ivanic, J., Ruedenberg, K. (1998). Rotation Matrices for Real Spherical
-    Harmonics. Direct Determination by Recursion Page: Additions and
-    Corrections. Journal of Physical Chemistry A, 102(45), 9099?9100.
-
- It also follows the implementations of Archontis Politis (Spherical Harmonic
- Transform Toolbox) and Matthias Kronlachner (AmbiX Plug-in Suite).
- */
-
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
@@ -72,6 +54,7 @@ createParameterLayout())
     invertRoll = parameters.getRawParameterValue ("invertRoll");
     invertQuaternion = parameters.getRawParameterValue ("invertQuaternion");
     rotationSequence = parameters.getRawParameterValue ("rotationSequence");
+    subBlockUpdates = parameters.getRawParameterValue ("subBlockUpdates");
 
 
     // add listeners to parameter changes
@@ -91,20 +74,6 @@ createParameterLayout())
     parameters.addParameterListener ("invertQuaternion", this);
     parameters.addParameterListener ("rotationSequence", this);
 
-
-
-    orderMatrices.add (new juce::dsp::Matrix<float> (0, 0)); // 0th
-    orderMatricesCopy.add (new juce::dsp::Matrix<float> (0, 0)); // 0th
-
-    for (int l = 1; l <= 7; ++l )
-    {
-        const int nCh = (2 * l + 1);
-        auto elem = orderMatrices.add (new juce::dsp::Matrix<float> (nCh, nCh));
-        elem->clear();
-        auto elemCopy = orderMatricesCopy.add (new juce::dsp::Matrix<float> (nCh, nCh));
-        elemCopy->clear();
-    }
-
     startTimer (500);
 }
 
@@ -176,97 +145,16 @@ void SceneRotatorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
     {
         removeNextBlockOfMessages (midiMessages, buffer.getNumSamples());
 
-        for (const auto& msg : midiMessages)
-        {
-            const auto message = msg.getMessage();
-
-            if (! message.isController())
-                break;
-
-            switch (currentMidiScheme)
-            {
-                case MidiScheme::mrHeadTrackerYprDir:
-                case MidiScheme::mrHeadTrackerYprInv:
-                    switch (message.getControllerNumber())
-                    {
-                        case 48: yawLsb = message.getControllerValue(); break;
-                        case 49: pitchLsb = message.getControllerValue(); break;
-                        case 50: rollLsb = message.getControllerValue(); break;
-
-                        case 16:
-                        {
-                            float yawVal = (128 * message.getControllerValue() + yawLsb) * (1.0f / 16384);
-                            parameters.getParameter ("yaw")->setValueNotifyingHost (yawVal);
-                            break;
-                        }
-
-                        case 17:
-                        {
-                            float pitchVal = (128 * message.getControllerValue() + pitchLsb) * (1.0f / 16384);
-                            parameters.getParameter ("pitch")->setValueNotifyingHost (pitchVal);
-                            break;
-                        }
-
-                        case 18:
-                        {
-                            float rollVal = (128 * message.getControllerValue() + rollLsb) * (1.0f / 16384);
-                            parameters.getParameter ("roll")->setValueNotifyingHost (rollVal);
-                            break;
-                        }
-                    } // switch (message.getControllerNumber())
-                    break;
-
-                case MidiScheme::mrHeadTrackerQuaternions:
-                    switch (message.getControllerNumber())
-                    {
-                        case 48: qwLsb = message.getControllerValue(); break;
-                        case 49: qxLsb = message.getControllerValue(); break;
-                        case 50: qyLsb = message.getControllerValue(); break;
-                        case 51: qzLsb = message.getControllerValue(); break;
-
-                        case 16:
-                        {
-                            float qwVal = (128 * message.getControllerValue() + qwLsb) * (1.0f / 16384);
-                            parameters.getParameter ("qw")->setValueNotifyingHost (qwVal);
-                            break;
-                        }
-
-                        case 17:
-                        {
-                            float qxVal = (128 * message.getControllerValue() + qxLsb) * (1.0f / 16384);
-                            parameters.getParameter ("qx")->setValueNotifyingHost (qxVal);
-                            break;
-                        }
-
-                        case 18:
-                        {
-                            float qyVal = (128 * message.getControllerValue() + qyLsb) * (1.0f / 16384);
-                            parameters.getParameter ("qy")->setValueNotifyingHost (qyVal);
-                            break;
-                        }
-
-                        case 19:
-                        {
-                            float qzVal = (128 * message.getControllerValue() + qzLsb) * (1.0f / 16384);
-                            parameters.getParameter ("qz")->setValueNotifyingHost (qzVal);
-                            break;
-                        }
-                    } // switch (message.getControllerNumber())
-                    break;
-                default:
-                    break;
-            } // switch (currentMidiScheme)
-        } //while (i.getNextEvent (message, time))
+        midiParser.processMidiMessages (midiMessages, currentMidiScheme);
     } //if (currentMidiScheme != MidiScheme::none)
 
 
 
-    bool newRotationMatrix = false;
-    if (rotationParamsHaveChanged.get())
-    {
-        newRotationMatrix = true;
+    const bool updateRotation = rotationParamsHaveChanged.get();
+    const bool useSubBlockUpdates = *subBlockUpdates >= 0.5f;
+
+    if (updateRotation && ! useSubBlockUpdates)
         calcRotationMatrix (inputOrder);
-    }
 
     // make copy of input
     for (int ch = 0; ch < actualChannels; ++ch)
@@ -277,190 +165,31 @@ void SceneRotatorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
         buffer.clear (ch, 0, L);
 
     // rotate buffer
-    for (int l = 1; l <= actualOrder; ++l)
+    if (updateRotation && useSubBlockUpdates)
     {
-        const int offset = l * l;
-        const int nCh = 2 * l + 1;
-        auto R = orderMatrices[l];
-        auto Rcopy = orderMatricesCopy[l];
-        for (int o = 0;  o < nCh; ++o)
-        {
-            const int chOut = offset + o;
-            for (int p = 0; p < nCh; ++p)
-            {
-                buffer.addFromWithRamp (chOut, 0, copyBuffer.getReadPointer (offset + p), L, Rcopy->operator() (o, p), R->operator() (o, p));
-            }
-        }
+        rotationParamsHaveChanged = false;
+        rotation.processWithSubBlockUpdates (copyBuffer.getArrayOfReadPointers(), buffer.getArrayOfWritePointers(), actualOrder, L,
+                                             getCartesianRotationMatrix(), inputOrder, subBlockSize);
     }
-
-    // make copies for fading between old and new matrices
-    if (newRotationMatrix)
-        for (int l = 1; l <= inputOrder; ++l)
-            *orderMatricesCopy[l] = *orderMatrices[l];
-
-    midiMessages.clear();
-}
-
-double SceneRotatorAudioProcessor::P (int i, int l, int a, int b, juce::dsp::Matrix<float>& R1, juce::dsp::Matrix<float>& Rlm1)
-{
-    double ri1 = R1 (i + 1, 2);
-    double rim1 = R1 (i + 1, 0);
-    double ri0 = R1 (i + 1, 1);
-
-    if (b == -l)
-        return ri1 * Rlm1(a + l - 1, 0) + rim1 * Rlm1(a + l - 1, 2 * l - 2);
-    else if (b == l)
-        return ri1 * Rlm1(a + l - 1, 2 * l - 2) - rim1 * Rlm1(a + l-1, 0);
     else
-        return ri0 * Rlm1(a + l - 1, b + l - 1);
-};
-
-double SceneRotatorAudioProcessor::U (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
-{
-    return P (0, l, m, n, Rone, Rlm1);
-}
+        rotation.process (copyBuffer.getArrayOfReadPointers(), buffer.getArrayOfWritePointers(), actualOrder, L);
 
-double SceneRotatorAudioProcessor::V (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
-{
-    if (m == 0)
-    {
-        auto p0 = P (1, l, 1, n, Rone, Rlm1);
-        auto p1 = P (-1 , l, -1, n, Rone, Rlm1);
-        return p0 + p1;
-    }
-    else if (m > 0)
-    {
-        auto p0 = P (1, l, m - 1, n, Rone, Rlm1);
-        if (m == 1) // d = 1;
-            return p0 * sqrt (2);
-        else // d = 0;
-            return p0 - P (-1, l, 1 - m, n, Rone, Rlm1);
-    }
-    else
-    {
-        auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
-        if (m == -1) // d = 1;
-            return p1 * sqrt (2);
-        else // d = 0;
-            return p1 + P (1, l, m + 1, n, Rone, Rlm1);
-    }
+    midiMessages.clear();
 }
 
-double SceneRotatorAudioProcessor::W (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
+void SceneRotatorAudioProcessor::calcRotationMatrix (const int order)
 {
-    if (m > 0)
-    {
-        auto p0 = P (1, l, m + 1, n, Rone, Rlm1);
-        auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
-        return p0 + p1;
-    }
-    else if (m < 0)
-    {
-        auto p0 = P(1, l, m - 1, n, Rone, Rlm1);
-        auto p1 = P (-1, l, 1 - m, n, Rone, Rlm1);
-        return p0 - p1;
-    }
-
-    return 0.0;
+    rotationParamsHaveChanged = false;
+    rotation.calcRotationMatrix (getCartesianRotationMatrix(), order);
 }
 
-
-void SceneRotatorAudioProcessor::calcRotationMatrix (const int order)
+juce::dsp::Matrix<float> SceneRotatorAudioProcessor::getCartesianRotationMatrix()
 {
     const auto yawRadians = Conversions<float>::degreesToRadians (*yaw) * (*invertYaw > 0.5 ? -1 : 1);
     const auto pitchRadians = Conversions<float>::degreesToRadians (*pitch) * (*invertPitch > 0.5 ? -1 : 1);
     const auto rollRadians = Conversions<float>::degreesToRadians (*roll) * (*invertRoll > 0.5 ? -1 : 1);
 
-    auto ca = std::cos (yawRadians);
-    auto cb = std::cos (pitchRadians);
-    auto cy = std::cos (rollRadians);
-
-    auto sa = std::sin (yawRadians);
-    auto sb = std::sin (pitchRadians);
-    auto sy = std::sin (rollRadians);
-
-
-    juce::dsp::Matrix<float> rotMat (3, 3);
-
-    if (*rotationSequence >= 0.5f) // roll -> pitch -> yaw (extrinsic rotations)
-    {
-        rotMat(0, 0) = ca * cb;
-        rotMat(1, 0) = sa * cb;
-        rotMat(2, 0) = - sb;
-
-        rotMat(0, 1) = ca * sb * sy - sa * cy;
-        rotMat(1, 1) = sa * sb * sy + ca * cy;
-        rotMat(2, 1) = cb * sy;
-
-        rotMat(0, 2) = ca * sb * cy + sa * sy;
-        rotMat(1, 2) = sa * sb * cy - ca * sy;
-        rotMat(2, 2) = cb * cy;
-    }
-    else // yaw -> pitch -> roll (extrinsic rotations)
-    {
-        rotMat(0, 0) = ca * cb;
-        rotMat(1, 0) = sa * cy + ca * sb * sy;
-        rotMat(2, 0) = sa * sy - ca * sb * cy;
-
-        rotMat(0, 1) = - sa * cb;
-        rotMat(1, 1) = ca * cy - sa * sb * sy;
-        rotMat(2, 1) = ca * sy + sa * sb * cy;
-
-        rotMat(0, 2) = sb;
-        rotMat(1, 2) = - cb * sy;
-        rotMat(2, 2) = cb * cy;
-    }
-
-
-
-    auto Rl = orderMatrices[1];
-
-    Rl->operator() (0, 0) = rotMat(1, 1);
-    Rl->operator() (0, 1) = rotMat(1, 2);
-    Rl->operator() (0, 2) = rotMat(1, 0);
-    Rl->operator() (1, 0) = rotMat(2, 1);
-    Rl->operator() (1, 1) = rotMat(2, 2);
-    Rl->operator() (1, 2) = rotMat(2, 0);
-    Rl->operator() (2, 0) = rotMat(0, 1);
-    Rl->operator() (2, 1) = rotMat(0, 2);
-    Rl->operator() (2, 2) = rotMat(0, 0);
-
-
-
-    for (int l = 2; l <= order; ++l)
-    {
-        auto Rone = orderMatrices[1];
-        auto Rlm1 = orderMatrices[l - 1];
-        auto Rl = orderMatrices[l];
-        for (int m = -l; m <= l; ++m)
-        {
-            for (int n = -l; n <= l; ++n)
-            {
-                const int d = (m == 0) ? 1 : 0;
-                double denom;
-                if (abs(n) == l)
-                    denom = (2 * l) * (2 * l - 1);
-                else
-                    denom = l * l - n * n;
-
-                double u = sqrt ((l * l - m * m) / denom);
-                double v = sqrt ((1.0 + d) * (l + abs (m) - 1.0) * (l + abs (m)) / denom) * (1.0 - 2.0 * d) * 0.5;
-                double w = sqrt ((l - abs (m) - 1.0) * (l - abs (m)) / denom) * (1.0 - d) * (-0.5);
-
-                if (u != 0.0)
-                    u *= U (l, m, n, *Rone, *Rlm1);
-                if (v != 0.0)
-                    v *= V (l, m, n, *Rone, *Rlm1);
-                if (w != 0.0)
-                    w *= W (l, m, n, *Rone, *Rlm1);
-
-                Rl->operator() (m + l, n + l) = u + v + w;
-            }
-        }
-    }
-
-    rotationParamsHaveChanged = false;
-
+    return AmbisonicRotation::getCartesianRotationMatrix (yawRadians, pitchRadians, rollRadians, *rotationSequence >= 0.5f);
 }
 
 
@@ -679,6 +408,7 @@ void SceneRotatorAudioProcessor::updateBuffers()
     DBG ("IOHelper: output size: " << output.getSize());
 
     copyBuffer.setSize (input.getNumberOfChannels(), copyBuffer.getNumSamples());
+    rotationParamsHaveChanged = true; // the matrices of higher orders might not have been calculated yet
 }
 
 
@@ -798,6 +528,10 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>> SceneRotatorAudioProces
                                                        juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f), 1.0,
                                                        [](float value) { return value >= 0.5f ? "Roll->Pitch->Yaw" : "Yaw->Pitch->Roll"; }, nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay ("subBlockUpdates", "Sub-block Rotation Updates", "",
+                                                       juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f), 0.0f,
+                                                       [](float value) { return value >= 0.5f ? "every 16 samples" : "once per block"; }, nullptr));
+
 
     return params;
 }
@@ -28,6 +28,8 @@
 #include "../../resources/Conversions.h"
 #include "../../resources/Quaternion.h"
 #include "../../resources/ReferenceCountedMatrix.h"
+#include "../../resources/AmbisonicRotation.h"
+#include "../../resources/MrHeadTrackerMidiParser.h"
 
 #define ProcessorClass SceneRotatorAudioProcessor
 
@@ -81,15 +83,10 @@ public:
 
     void rotateBuffer (juce::AudioBuffer<float>* bufferToRotate, const int nChannels, const int samples);
     void calcRotationMatrix (const int order);
+    juce::dsp::Matrix<float> getCartesianRotationMatrix();
 
     //======= MIDI Connection ======================================================
-    enum class MidiScheme
-    {
-        none = 0,
-        mrHeadTrackerYprDir,
-        mrHeadTrackerYprInv,
-        mrHeadTrackerQuaternions
-    };
+    using MidiScheme = MrHeadTrackerMidiParser::MidiScheme;
 
     const juce::StringArray midiSchemeNames
     {
@@ -142,26 +139,21 @@ private:
     std::atomic<float>* invertRoll;
     std::atomic<float>* invertQuaternion;
     std::atomic<float>* rotationSequence;
+    std::atomic<float>* subBlockUpdates;
+
+    static constexpr int subBlockSize = 16;
 
     juce::Atomic<bool> updatingParams {false};
     juce::Atomic<bool> rotationParamsHaveChanged {true};
 
     juce::AudioBuffer<float> copyBuffer;
 
-    juce::OwnedArray<juce::dsp::Matrix<float>> orderMatrices;
-    juce::OwnedArray<juce::dsp::Matrix<float>> orderMatricesCopy;
-
-    double P (int i, int l, int a, int b, juce::dsp::Matrix<float>& R1, juce::dsp::Matrix<float>& Rlm1);
-    double U (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1);
-    double V (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1);
-    double W (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1);
+    AmbisonicRotation rotation;
 
     void timerCallback() override;
 
     // ============ MIDI Device Connection ======================
-    // MrHeadTracker 14-bit MIDI Data
-    int yawLsb = 0, pitchLsb = 0, rollLsb = 0;
-    int qwLsb = 0, qxLsb = 0, qyLsb = 0, qzLsb = 0;
+    MrHeadTrackerMidiParser midiParser {parameters};
 
     std::unique_ptr<juce::MidiInput> midiInput;
     juce::String currentMidiDeviceName = "";
@@ -338,9 +338,10 @@ void SimpleDecoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
 
     const int nChIn = juce::jmin(retainedDecoder->getNumInputChannels(), buffer.getNumChannels(), input.getNumberOfChannels());
     const int nChOut = juce::jmin(retainedDecoder->getNumOutputChannels(), buffer.getNumChannels());
+    const int nChDecoded = juce::jmin(decoder.getNumOutputChannels(), buffer.getNumChannels()); // includes the channels of a previous decoder which is faded out
     const int swProcessing = *swMode;
 
-    for (int ch = juce::jmax(nChIn, nChOut); ch < buffer.getNumChannels(); ++ch) // clear all not needed channels
+    for (int ch = juce::jmax(nChIn, nChDecoded); ch < buffer.getNumChannels(); ++ch) // clear all not needed channels
         buffer.clear(ch, 0, buffer.getNumSamples());
 
     if (swProcessing > 0)
@@ -374,10 +375,10 @@ void SimpleDecoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
     // ambisonic decoding
     const int L = buffer.getNumSamples();
     auto inputAudioBlock = juce::dsp::AudioBlock<float> (buffer.getArrayOfWritePointers(), nChIn, L);
-    auto outputAudioBlock = juce::dsp::AudioBlock<float> (buffer.getArrayOfWritePointers(), nChOut, L);
+    auto outputAudioBlock = juce::dsp::AudioBlock<float> (buffer.getArrayOfWritePointers(), nChDecoded, L);
     decoder.process (inputAudioBlock, outputAudioBlock);
 
-    for (int ch = nChOut; ch < nChIn; ++ch) // clear all not needed channels
+    for (int ch = nChDecoded; ch < nChIn; ++ch) // clear all not needed channels
         buffer.clear(ch, 0, buffer.getNumSamples());
 
 
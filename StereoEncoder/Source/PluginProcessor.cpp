@@ -186,7 +186,11 @@ void StereoEncoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
 
     for (int i = 0; i < totalNumInputChannels; ++i)
         bufferCopy.copyFrom(i, 0, buffer.getReadPointer(i), buffer.getNumSamples());
-    buffer.clear();
+
+    const bool sn3d = *useSN3D > 0.5f;
+    const bool encodingChanged = ambisonicOrder != encodedOrder || sn3d != encodedSN3D;
+    encodedOrder = ambisonicOrder;
+    encodedSN3D = sn3d;
 
     const float widthInRadiansQuarter {Conversions<float>::degreesToRadians (*width) / 4.0f};
     const iem::Quaternion<float> quatLRot {iem::Quaternion<float> (cos (widthInRadiansQuarter), 0.0f, 0.0f, sin (widthInRadiansQuarter))};
@@ -201,34 +205,9 @@ void StereoEncoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
     Conversions<float>::cartesianToSpherical (left, azimuthL, elevationL);
     Conversions<float>::cartesianToSpherical (right, azimuthR, elevationR);
 
+    bool smoothing = false;
 
-    if (*highQuality < 0.5f) // no high-quality
-    {
-        if (positionHasChanged.compareAndSetBool (false, true))
-        {
-            smoothAzimuthL.setCurrentAndTargetValue (azimuthL);
-            smoothElevationL.setCurrentAndTargetValue (elevationL);
-            smoothAzimuthR.setCurrentAndTargetValue (azimuthR);
-            smoothElevationR.setCurrentAndTargetValue (elevationR);
-
-            SHEval (ambisonicOrder, left.x, left.y, left.z, SHL);
-            SHEval (ambisonicOrder, right.x, right.y, right.z, SHR);
-
-            if (*useSN3D > 0.5f)
-            {
-                juce::FloatVectorOperations::multiply(SHL, SHL, n3d2sn3d, nChOut);
-                juce::FloatVectorOperations::multiply(SHR, SHR, n3d2sn3d, nChOut);
-            }
-        }
-        const float *leftIn = bufferCopy.getReadPointer(0);
-        const float *rightIn = bufferCopy.getReadPointer(1);
-        for (int i = 0; i < nChOut; ++i)
-        {
-            buffer.copyFromWithRamp(i, 0, leftIn, buffer.getNumSamples(), _SHL[i], SHL[i]);
-            buffer.addFromWithRamp(i, 0, rightIn, buffer.getNumSamples(), _SHR[i], SHR[i]);
-        }
-    }
-    else // high-quality sampling
+    if (*highQuality >= 0.5f) // high-quality sampling
     {
         if (smoothAzimuthL.getTargetValue() - azimuthL > juce::MathConstants<float>::pi)
             smoothAzimuthL.setCurrentAndTargetValue (smoothAzimuthL.getTargetValue() - 2.0f * juce::MathConstants<float>::pi);
@@ -255,6 +234,58 @@ void StereoEncoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
         smoothAzimuthR.setTargetValue (azimuthR);
         smoothElevationR.setTargetValue (elevationR);
 
+        smoothing = smoothAzimuthL.isSmoothing() || smoothElevationL.isSmoothing()
+                    || smoothAzimuthR.isSmoothing() || smoothElevationR.isSmoothing();
+    }
+
+    if (! smoothing) // no high-quality, or a static source: one set of coefficients per block
+    {
+        if (positionHasChanged.compareAndSetBool (false, true) || encodingChanged)
+        {
+            smoothAzimuthL.setCurrentAndTargetValue (azimuthL);
+            smoothElevationL.setCurrentAndTargetValue (elevationL);
+            smoothAzimuthR.setCurrentAndTargetValue (azimuthR);
+            smoothElevationR.setCurrentAndTargetValue (elevationR);
+
+            SHEval (ambisonicOrder, left.x, left.y, left.z, SHL);
+            SHEval (ambisonicOrder, right.x, right.y, right.z, SHR);
+
+            if (sn3d)
+            {
+                juce::FloatVectorOperations::multiply(SHL, SHL, n3d2sn3d, nChOut);
+                juce::FloatVectorOperations::multiply(SHR, SHR, n3d2sn3d, nChOut);
+            }
+        }
+
+        float gains[64][2];
+        float gainDeltas[64][2];
+        const float* gainRows[64];
+        const float* gainDeltaRows[64];
+        bool ramped = false;
+
+        for (int ch = 0; ch < nChOut; ++ch)
+        {
+            gains[ch][0] = _SHL[ch];
+            gains[ch][1] = _SHR[ch];
+            gainDeltas[ch][0] = SHL[ch] - _SHL[ch];
+            gainDeltas[ch][1] = SHR[ch] - _SHR[ch];
+            ramped = ramped || SHL[ch] != _SHL[ch] || SHR[ch] != _SHR[ch];
+
+            gainRows[ch] = gains[ch];
+            gainDeltaRows[ch] = gainDeltas[ch];
+        }
+
+        const float* inputs[2] = { bufferCopy.getReadPointer (0), bufferCopy.getReadPointer (1) };
+        MatrixMultiplicationKernel::processWithRamp (inputs, 2, gainRows, inputs, ramped ? 2 : 0, gainDeltaRows,
+                                                     buffer.getArrayOfWritePointers(), nChOut, L);
+
+        for (int ch = nChOut; ch < buffer.getNumChannels(); ++ch)
+            buffer.clear (ch, 0, L);
+    }
+    else
+    {
+        buffer.clear();
+
         for (int i = 0; i < L; ++i) // left
         {
             const float azimuth = smoothAzimuthL.getNextValue();
@@ -281,7 +312,7 @@ void StereoEncoderAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
                 buffer.addSample(ch, i, sample * SHR[ch]);
         }
 
-        if (*useSN3D > 0.5f)
+        if (sn3d)
         {
             for (int ch = 0; ch < nChOut; ++ch)
             {
@@ -30,6 +30,7 @@
 #include "../../resources/ambisonicTools.h"
 
 #include "../../resources/Conversions.h"
+#include "../../resources/MatrixMultiplicationKernel.h"
 
 
 #define ProcessorClass StereoEncoderAudioProcessor
@@ -114,6 +115,8 @@ private:
     float _SHR[64];
 
     juce::Atomic<bool> positionHasChanged = true;
+    int encodedOrder = -1;
+    bool encodedSN3D = false;
 
     iem::Quaternion<float> quaternionDirection;
 
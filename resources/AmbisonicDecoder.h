@@ -41,8 +41,11 @@ public:
         spec = newSpec;
         matMult.prepare (newSpec, false); // we let do this class do the buffering
 
-        buffer.setSize (buffer.getNumChannels(), spec.maximumBlockSize);
+        // allocate for the maximum number of channels, so new decoders don't need any resizing
+        buffer.setSize (static_cast<int> (spec.numChannels), static_cast<int> (spec.maximumBlockSize));
         buffer.clear();
+        previousBuffer.setSize (static_cast<int> (spec.numChannels), static_cast<int> (spec.maximumBlockSize));
+        previousBuffer.clear();
 
         checkIfNewDecoderAvailable();
     }
@@ -53,6 +56,12 @@ public:
         inputNormalization = newNormalization;
     }
 
+    /** Sets the duration of the cross-fade between the previous and a new decoder. */
+    void setCrossfadeTime (const double newCrossfadeTimeInSeconds)
+    {
+        matMult.setCrossfadeTime (newCrossfadeTimeInSeconds);
+    }
+
     /**
      Decodes the Ambisonic input signals to loudspeaker signals using the current decoder.
      This method takes care of buffering the input data, so inputBlock and outputBlock are
@@ -62,78 +71,91 @@ public:
     {
         checkIfNewDecoderAvailable();
 
-        ReferenceCountedDecoder::Ptr retainedDecoder = currentDecoder;
+        // copy and weight the input data for both decoders, before the output overwrites it
+        auto ab = copyAndApplyWeights (getCurrentDecoder(), inputBlock, buffer);
 
-        auto& T = retainedDecoder->getMatrix();
-
-        const int nInputChannels = juce::jmin (static_cast<int> (inputBlock.getNumChannels()), static_cast<int> (T.getNumColumns()));
-        const int nSamples = static_cast<int> (inputBlock.getNumSamples());
-
-        // copy input data to buffer
-        for (int ch = 0; ch < nInputChannels; ++ch)
-            buffer.copyFrom (ch, 0, inputBlock.getChannelPointer (ch), nSamples);
+        juce::ScopedNoDenormals noDenormals;
 
-        juce::dsp::AudioBlock<float> ab (buffer.getArrayOfWritePointers(), nInputChannels, 0, nSamples);
-        processInternal (ab, outputBlock);
+        if (matMult.isCrossfading())
+        {
+            auto previousAb = copyAndApplyWeights (getPreviousDecoder(), inputBlock, previousBuffer);
+            matMult.processNonReplacing (ab, previousAb, outputBlock, false);
+        }
+        else
+            matMult.processNonReplacing (ab, outputBlock, false);
     }
 
+    /** Takes over a new decoder if one is available. Call this from the audio thread only. */
     const bool checkIfNewDecoderAvailable()
     {
-        if (newDecoderAvailable)
-        {
-            newDecoderAvailable = false;
-            currentDecoder = newDecoder;
-            newDecoder = nullptr;
-
-            if (currentDecoder != nullptr)
-            {
-                currentDecoder->removeAppliedWeights();
-                const int cols = (int) currentDecoder->getMatrix().getNumColumns();
-                buffer.setSize (cols, buffer.getNumSamples());
-            }
-
-            matMult.setMatrix (currentDecoder, true);
-            return true;
-        }
-        return false;
+        return matMult.checkIfNewMatrixAvailable();
     };
 
     /** Giving the AmbisonicDecoder a new decoder for the audio processing. Note: The AmbisonicDecoder will call the removeAppliedWeights() of the ReferenceCountedDecoder before it processes audio! The matrix elements may change due to this method.
+        This method also creates the execution plan of the decoder matrix, so don't call it from the audio thread.
      */
     void setDecoder (ReferenceCountedDecoder::Ptr newDecoderToUse)
     {
-        newDecoder = newDecoderToUse;
-        newDecoderAvailable = true;
+        if (newDecoderToUse != nullptr)
+            newDecoderToUse->removeAppliedWeights();
+
+        matMult.setMatrix (newDecoderToUse.get());
     }
 
     ReferenceCountedDecoder::Ptr getCurrentDecoder()
     {
-        return currentDecoder;
+        // the matrix multiplication only gets decoders from us
+        return static_cast<ReferenceCountedDecoder*> (matMult.getMatrix().get());
+    }
+
+    /**
+     Returns the number of output channels of the current decoder, or of the previous one while
+     cross-fading if it has more, so the output channels it drops are faded out as well.
+     */
+    const int getNumOutputChannels()
+    {
+        int nChannels = 0;
+        if (auto currentDecoder = getCurrentDecoder())
+            nChannels = currentDecoder->getNumOutputChannels();
+
+        if (auto previousDecoder = getPreviousDecoder())
+            nChannels = juce::jmax (nChannels, previousDecoder->getNumOutputChannels());
+
+        return nChannels;
     }
 
     /** Checks if a new decoder waiting to be used.
      */
-    const bool isNewDecoderWaiting() { return newDecoderAvailable; }
+    const bool isNewDecoderWaiting() { return matMult.isNewMatrixWaiting(); }
 
 private:
+    ReferenceCountedDecoder::Ptr getPreviousDecoder()
+    {
+        return static_cast<ReferenceCountedDecoder*> (matMult.getPreviousMatrix().get());
+    }
+
     /**
-     Decodes the Ambisonic input signals to loudspeaker signals using the current decoder. Keep in mind that the input data will be changed!
+     Copies the Ambisonic input signals into the given buffer and applies the Ambisonic weights, the normalization
+     and the order correction expected by the decoder. Returns the block of the buffer which holds the weighted signals.
      */
-    void processInternal (juce::dsp::AudioBlock<float> inputBlock, juce::dsp::AudioBlock<float> outputBlock)
+    juce::dsp::AudioBlock<float> copyAndApplyWeights (ReferenceCountedDecoder::Ptr retainedDecoder, const juce::dsp::AudioBlock<float> inputBlock, juce::AudioBuffer<float>& destBuffer)
     {
-        // you should call the processReplacing instead, it will buffer the input data
-        // this is a weak check, as e.g. if number channels differ, it won't trigger
-        jassert (inputBlock != outputBlock);
+        int nInputChannels = juce::jmin (static_cast<int> (inputBlock.getNumChannels()), destBuffer.getNumChannels(), 64);
+        if (retainedDecoder != nullptr)
+            nInputChannels = juce::jmin (nInputChannels, static_cast<int> (retainedDecoder->getMatrix().getNumColumns()));
 
-        juce::ScopedNoDenormals noDenormals;
+        const int nSamples = static_cast<int> (inputBlock.getNumSamples());
+
+        // copy input data to buffer
+        for (int ch = 0; ch < nInputChannels; ++ch)
+            destBuffer.copyFrom (ch, 0, inputBlock.getChannelPointer (ch), nSamples);
 
-        ReferenceCountedDecoder::Ptr retainedDecoder = currentDecoder;
+        juce::dsp::AudioBlock<float> ab (destBuffer.getArrayOfWritePointers(), nInputChannels, 0, nSamples);
 
-        if (retainedDecoder != nullptr) // if decoder is available, do the pre-processing
+        if (retainedDecoder != nullptr && nInputChannels > 0) // if decoder is available, do the pre-processing
         {
-            const int order = isqrt (static_cast<int> (inputBlock.getNumChannels())) - 1;
+            const int order = isqrt (nInputChannels) - 1;
             const int chAmbi = juce::square (order + 1);
-            const int numSamples = static_cast<int> (inputBlock.getNumSamples());
 
             float weights[64];
             const float correction = std::sqrt (std::sqrt ((static_cast<float> (retainedDecoder->getOrder()) + 1) / (static_cast<float> (order) + 1)));
@@ -157,20 +179,18 @@ private:
             }
 
             for (int ch = 0; ch < chAmbi; ++ch)
-                juce::FloatVectorOperations::multiply (inputBlock.getChannelPointer (ch), weights[ch], numSamples);
+                juce::FloatVectorOperations::multiply (ab.getChannelPointer (ch), weights[ch], nSamples);
         }
 
-        matMult.processNonReplacing (inputBlock, outputBlock);
+        return ab;
     }
 
 private:
     //==============================================================================
     juce::dsp::ProcessSpec spec = {-1, 0, 0};
-    ReferenceCountedDecoder::Ptr currentDecoder {nullptr};
-    ReferenceCountedDecoder::Ptr newDecoder {nullptr};
-    bool newDecoderAvailable {false};
 
     juce::AudioBuffer<float> buffer;
+    juce::AudioBuffer<float> previousBuffer;
 
     ReferenceCountedDecoder::Normalization inputNormalization {ReferenceCountedDecoder::Normalization:: sn3d};
 
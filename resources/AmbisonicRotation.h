@@ -0,0 +1,709 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+/*
+ The computation of Ambisonic rotation matrices is done by the recursive method
+ of Ivanic and Ruedenberg:
+
+    Ivanic, J., Ruedenberg, K. (1996). Rotation Matrices for Real Spherical
+    Harmonics. Direct Determination by Recursion. The Journal of Physical
+    Chemistry, 100(15), 6342?6347.
+
+ Including their corrections:
+
+    Ivanic, J., Ruedenberg, K. (1998). Rotation Matrices for Real Spherical
+    Harmonics. Direct Determination by Recursion Page: Additions and
+    Corrections. Journal of Physical Chemistry A, 102(45), 9099?9100.
+
+ It also follows the implementations of Archontis Politis (Spherical Harmonic
+ Transform Toolbox) and Matthias Kronlachner (AmbiX Plug-in Suite).
+ */
+
+#pragma once
+
+#include "Quaternion.h"
+#include "SIMDHelpers.h"
+
+/**
+ Calculates the per-order rotation matrices of Ambisonic signals up to 7th order and applies them
+ to the SH channels. Whenever the matrices change, the next call of process() ramps from the
+ previous matrices to the new ones over the whole block.
+
+ The rotation only mixes channels of the same order, so each order is processed by its own
+ fused kernel: the samples are processed in small tiles, and all (2l+1) outputs of a tile are
+ accumulated in registers from the (2l+1) inputs, skipping the matrix entries which are zero
+ (e.g. all but two per row for a pure yaw rotation). A ramp costs one additional accumulator
+ per output, as the ramped gains are linear in the difference of the two matrices.
+ */
+class AmbisonicRotation
+{
+public:
+    static constexpr int maxOrder = 7;
+    static constexpr int maxNumChannels = (maxOrder + 1) * (maxOrder + 1);
+
+   #if JUCE_USE_SIMD
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int simdSize = static_cast<int> (SIMDFloat::size());
+    static constexpr int registersPerTile = 2;
+   #else
+    static constexpr int simdSize = 1;
+    static constexpr int registersPerTile = 8;
+   #endif
+
+    static constexpr int samplesPerTile = registersPerTile * simdSize;
+
+    AmbisonicRotation()
+    {
+        orderMatrices.add (new juce::dsp::Matrix<float> (0, 0)); // 0th
+        orderMatricesCopy.add (new juce::dsp::Matrix<float> (0, 0)); // 0th
+
+        for (int l = 1; l <= maxOrder; ++l )
+        {
+            const int nCh = (2 * l + 1);
+            auto elem = orderMatrices.add (new juce::dsp::Matrix<float> (nCh, nCh));
+            elem->clear();
+            auto elemCopy = orderMatricesCopy.add (new juce::dsp::Matrix<float> (nCh, nCh));
+            elemCopy->clear();
+        }
+
+        calcWignerTables();
+    }
+
+    /**
+     Returns the cartesian rotation matrix of the given angles (in radians).
+
+     @param rollPitchYaw    true for roll -> pitch -> yaw, false for yaw -> pitch -> roll (extrinsic rotations)
+     */
+    static juce::dsp::Matrix<float> getCartesianRotationMatrix (const float yawRadians, const float pitchRadians,
+                                                                const float rollRadians, const bool rollPitchYaw)
+    {
+        auto ca = std::cos (yawRadians);
+        auto cb = std::cos (pitchRadians);
+        auto cy = std::cos (rollRadians);
+
+        auto sa = std::sin (yawRadians);
+        auto sb = std::sin (pitchRadians);
+        auto sy = std::sin (rollRadians);
+
+
+        juce::dsp::Matrix<float> rotMat (3, 3);
+
+        if (rollPitchYaw) // roll -> pitch -> yaw (extrinsic rotations)
+        {
+            rotMat(0, 0) = ca * cb;
+            rotMat(1, 0) = sa * cb;
+            rotMat(2, 0) = - sb;
+
+            rotMat(0, 1) = ca * sb * sy - sa * cy;
+            rotMat(1, 1) = sa * sb * sy + ca * cy;
+            rotMat(2, 1) = cb * sy;
+
+            rotMat(0, 2) = ca * sb * cy + sa * sy;
+            rotMat(1, 2) = sa * sb * cy - ca * sy;
+            rotMat(2, 2) = cb * cy;
+        }
+        else // yaw -> pitch -> roll (extrinsic rotations)
+        {
+            rotMat(0, 0) = ca * cb;
+            rotMat(1, 0) = sa * cy + ca * sb * sy;
+            rotMat(2, 0) = sa * sy - ca * sb * cy;
+
+            rotMat(0, 1) = - sa * cb;
+            rotMat(1, 1) = ca * cy - sa * sb * sy;
+            rotMat(2, 1) = ca * sy + sa * sb * cy;
+
+            rotMat(0, 2) = sb;
+            rotMat(1, 2) = - cb * sy;
+            rotMat(2, 2) = cb * cy;
+        }
+
+        return rotMat;
+    }
+
+    /**
+     Calculates the rotation matrices of all orders up to the given one from a cartesian 3x3 rotation matrix.
+
+     The rotation is decomposed into z-y-z Euler angles. The rotations about the z-axis only mix
+     the channels m and -m with cos (m angle) and sin (m angle), and the rotation about the y-axis
+     is a short Fourier series in the pitch angle with precomputed, sparse coefficient matrices
+     (the Wigner-d matrices), so there's no recursion across the orders.
+     */
+    void calcRotationMatrix (const juce::dsp::Matrix<float>& rotMat, const int order)
+    {
+        // copied element-wise, assigning the matrix would allocate
+        std::copy_n (rotMat.getRawDataPointer(), 9, cartesianRotation.getRawDataPointer());
+        hasCartesianRotation = true;
+
+        setFirstOrderMatrix (rotMat, *orderMatrices[1]);
+
+        const int maxL = juce::jmin (order, maxOrder);
+        if (maxL >= 2)
+        {
+            double alpha, beta, gamma;
+            getZYZEulerAngles (rotMat, alpha, beta, gamma);
+
+            float cosAlpha[maxOrder + 1], sinAlpha[maxOrder + 1];
+            float cosBeta[maxOrder + 1], sinBeta[maxOrder + 1];
+            float cosGamma[maxOrder + 1], sinGamma[maxOrder + 1];
+            getHarmonics (alpha, maxL, cosAlpha, sinAlpha);
+            getHarmonics (beta, maxL, cosBeta, sinBeta);
+            getHarmonics (gamma, maxL, cosGamma, sinGamma);
+
+            float betaHarmonics[2 * maxOrder + 1] = { 1.0f };
+            for (int k = 1; k <= maxL; ++k)
+            {
+                betaHarmonics[2 * k - 1] = cosBeta[k];
+                betaHarmonics[2 * k] = sinBeta[k];
+            }
+
+            for (int l = 2; l <= maxL; ++l)
+            {
+                const int nCh = 2 * l + 1;
+                float* R = orderMatrices[l]->getRawDataPointer();
+
+                // rotation about the y-axis
+                juce::FloatVectorOperations::clear (R, nCh * nCh);
+                for (auto& entry : wignerTables[l])
+                    R[entry.index] += entry.coefficient * betaHarmonics[entry.harmonic];
+
+                // first rotation about the z-axis (columns)
+                for (int m = 1; m <= l; ++m)
+                {
+                    for (int row = 0; row < nCh; ++row)
+                    {
+                        float& pos = R[row * nCh + l + m];
+                        float& neg = R[row * nCh + l - m];
+                        const float p = pos;
+                        pos = p * cosGamma[m] + neg * sinGamma[m];
+                        neg = neg * cosGamma[m] - p * sinGamma[m];
+                    }
+                }
+
+                // second rotation about the z-axis (rows)
+                for (int m = 1; m <= l; ++m)
+                {
+                    float* pos = R + (l + m) * nCh;
+                    float* neg = R + (l - m) * nCh;
+                    for (int col = 0; col < nCh; ++col)
+                    {
+                        const float p = pos[col];
+                        pos[col] = p * cosAlpha[m] - neg[col] * sinAlpha[m];
+                        neg[col] = neg[col] * cosAlpha[m] + p * sinAlpha[m];
+                    }
+                }
+
+                // flush the rounding residues of entries which should be zero, so process() can skip them
+                for (int i = 0; i < nCh * nCh; ++i)
+                    if (std::abs (R[i]) < 1e-6f)
+                        R[i] = 0.0f;
+            }
+        }
+
+        calculatedOrder = maxL;
+        newRotationMatrix = true;
+    }
+
+    /**
+     Calculates the same matrices as calcRotationMatrix() with the recursion of Ivanic and Ruedenberg.
+     It is considerably slower and is used to set up the Wigner-d tables.
+     */
+    void calcRotationMatrixRecursively (const juce::dsp::Matrix<float>& rotMat, const int order)
+    {
+        cartesianRotation = rotMat;
+        hasCartesianRotation = true;
+
+        calcRotationMatricesRecursively (rotMat, orderMatrices, order);
+
+        calculatedOrder = juce::jmin (order, maxOrder);
+        newRotationMatrix = true;
+    }
+
+    /**
+     Rotates the SH channels of the given order. If the matrices have changed since the last call,
+     the gains are ramped from the previous to the new matrices. The input and output channels must
+     not overlap, and the order must not exceed the one the matrices have been calculated for.
+     */
+    void process (const float* const* input, float* const* output, const int order, const int numSamples) noexcept
+    {
+        jassert (order <= calculatedOrder);
+
+        if (order < 0)
+            return;
+
+        juce::FloatVectorOperations::copy (output[0], input[0], numSamples);
+
+        const float rampIncrement = 1.0f / numSamples;
+
+        for (int l = 1; l <= order; ++l)
+        {
+            const int offset = l * l;
+            const int nCh = 2 * l + 1;
+            auto R = orderMatrices[l];
+            auto Rcopy = orderMatricesCopy[l];
+
+            SparseRow rows[2 * maxOrder + 1];
+            bool ramped = false;
+
+            for (int o = 0; o < nCh; ++o)
+            {
+                auto& row = rows[o];
+                row.numEntries = 0;
+
+                for (int p = 0; p < nCh; ++p)
+                {
+                    const float startGain = Rcopy->operator() (o, p);
+                    const float endGain = R->operator() (o, p);
+
+                    if (startGain == 0.0f && endGain == 0.0f)
+                        continue;
+
+                    row.channels[row.numEntries] = offset + p;
+                    row.gains[row.numEntries] = startGain;
+                    row.gainDeltas[row.numEntries] = endGain - startGain;
+                    ramped = ramped || startGain != endGain;
+                    ++row.numEntries;
+                }
+            }
+
+            if (ramped)
+                processOrder<true> (input, output + offset, rows, nCh, numSamples, rampIncrement);
+            else
+                processOrder<false> (input, output + offset, rows, nCh, numSamples, rampIncrement);
+        }
+
+        // make copies for fading between old and new matrices
+        if (newRotationMatrix)
+        {
+            // element-wise, as assigning a juce::dsp::Matrix allocates
+            for (int l = 1; l <= calculatedOrder; ++l)
+                std::copy_n (orderMatrices[l]->getRawDataPointer(), juce::square (2 * l + 1), orderMatricesCopy[l]->getRawDataPointer());
+
+            newRotationMatrix = false;
+        }
+    }
+
+    /**
+     Rotates the SH channels like process(), but instead of ramping linearly from the previous
+     matrices to the ones of the new rotation, it follows the shortest rotation from the previous
+     cartesian rotation to the new one and recalculates the matrices every subBlockSize samples.
+     A linear ramp between two distant rotations passes through matrices which are no rotations
+     and attenuate the sound field; with fast head movements this becomes audible.
+
+     @param targetRotation  cartesian rotation matrix at the end of the block
+     @param matrixOrder     order up to which the matrices are calculated, see calcRotationMatrix()
+     */
+    void processWithSubBlockUpdates (const float* const* input, float* const* output, const int order, const int numSamples,
+                                     const juce::dsp::Matrix<float>& targetRotation, const int matrixOrder, const int subBlockSize) noexcept
+    {
+        if (! hasCartesianRotation || order < 0)
+        {
+            calcRotationMatrix (targetRotation, matrixOrder);
+            process (input, output, order, numSamples);
+            return;
+        }
+
+        const auto from = toQuaternion (cartesianRotation);
+        auto to = toQuaternion (targetRotation);
+
+        const int nCh = juce::square (order + 1);
+        const float* subBlockInput[maxNumChannels];
+        float* subBlockOutput[maxNumChannels];
+
+        for (int start = 0; start < numSamples; start += subBlockSize)
+        {
+            const int n = juce::jmin (subBlockSize, numSamples - start);
+            const float fraction = static_cast<float> (start + n) / numSamples;
+            toCartesianRotationMatrix (slerp (from, to, fraction), subBlockRotation);
+            calcRotationMatrix (subBlockRotation, matrixOrder);
+
+            for (int ch = 0; ch < nCh; ++ch)
+            {
+                subBlockInput[ch] = input[ch] + start;
+                subBlockOutput[ch] = output[ch] + start;
+            }
+
+            process (subBlockInput, subBlockOutput, order, n);
+        }
+    }
+
+    const juce::dsp::Matrix<float>& getOrderMatrix (const int l) const { return *orderMatrices[l]; }
+
+private:
+    /** The non-zero entries of one row of a rotation matrix and their change during the block. */
+    struct SparseRow
+    {
+        int numEntries;
+        int channels[2 * maxOrder + 1];
+        float gains[2 * maxOrder + 1];
+        float gainDeltas[2 * maxOrder + 1];
+    };
+
+    template <bool ramped>
+    static void processOrder (const float* const* input, float* const* output, const SparseRow* rows,
+                              const int nCh, const int numSamples, const float rampIncrement) noexcept
+    {
+        const int tailStart = numSamples - numSamples % samplesPerTile;
+
+        for (int n = 0; n < tailStart; n += samplesPerTile)
+            for (int o = 0; o < nCh; ++o)
+                processTile<ramped> (input, output[o], rows[o], n, rampIncrement);
+
+        if (tailStart < numSamples)
+            for (int o = 0; o < nCh; ++o)
+                processTail<ramped> (input, output[o], rows[o], tailStart, numSamples, rampIncrement);
+    }
+
+    template <bool ramped>
+    static inline void processTile (const float* const* input, float* dest, const SparseRow& row,
+                                    const int offset, const float rampIncrement) noexcept
+    {
+       #if JUCE_USE_SIMD
+        SIMDFloat acc[registersPerTile];
+        SIMDFloat delta[registersPerTile];
+        for (int k = 0; k < registersPerTile; ++k)
+            acc[k] = delta[k] = SIMDFloat::expand (0.0f);
+
+        for (int i = 0; i < row.numEntries; ++i)
+        {
+            const float* x = input[row.channels[i]] + offset;
+            const auto gain = SIMDFloat::expand (row.gains[i]);
+            const auto gainDelta = SIMDFloat::expand (row.gainDeltas[i]);
+
+            for (int k = 0; k < registersPerTile; ++k)
+            {
+                const auto in = SIMDHelpers::loadUnaligned (x + k * simdSize);
+                acc[k] += gain * in;
+                if (ramped)
+                    delta[k] += gainDelta * in;
+            }
+        }
+
+        for (int k = 0; k < registersPerTile; ++k)
+        {
+            if (ramped)
+            {
+                const auto ramp = (SIMDHelpers::loadUnaligned (SIMDHelpers::laneIndices) + static_cast<float> (offset + k * simdSize)) * rampIncrement;
+                acc[k] += ramp * delta[k];
+            }
+
+            SIMDHelpers::storeUnaligned (dest + offset + k * simdSize, acc[k]);
+        }
+       #else
+        processTail<ramped> (input, dest, row, offset, offset + samplesPerTile, rampIncrement);
+       #endif
+    }
+
+    template <bool ramped>
+    static inline void processTail (const float* const* input, float* dest, const SparseRow& row,
+                                    const int start, const int end, const float rampIncrement) noexcept
+    {
+        for (int n = start; n < end; ++n)
+        {
+            float sum = 0.0f;
+            float delta = 0.0f;
+            for (int i = 0; i < row.numEntries; ++i)
+            {
+                const float in = input[row.channels[i]][n];
+                sum += row.gains[i] * in;
+                if (ramped)
+                    delta += row.gainDeltas[i] * in;
+            }
+
+            dest[n] = ramped ? sum + n * rampIncrement * delta : sum;
+        }
+    }
+
+    //==============================================================================
+    static iem::Quaternion<float> toQuaternion (const juce::dsp::Matrix<float>& R)
+    {
+        const float trace = R (0, 0) + R (1, 1) + R (2, 2);
+
+        if (trace > 0.0f)
+        {
+            const float s = 0.5f / std::sqrt (trace + 1.0f);
+            return { 0.25f / s, (R (2, 1) - R (1, 2)) * s, (R (0, 2) - R (2, 0)) * s, (R (1, 0) - R (0, 1)) * s };
+        }
+        else if (R (0, 0) > R (1, 1) && R (0, 0) > R (2, 2))
+        {
+            const float s = 2.0f * std::sqrt (1.0f + R (0, 0) - R (1, 1) - R (2, 2));
+            return { (R (2, 1) - R (1, 2)) / s, 0.25f * s, (R (0, 1) + R (1, 0)) / s, (R (0, 2) + R (2, 0)) / s };
+        }
+        else if (R (1, 1) > R (2, 2))
+        {
+            const float s = 2.0f * std::sqrt (1.0f + R (1, 1) - R (0, 0) - R (2, 2));
+            return { (R (0, 2) - R (2, 0)) / s, (R (0, 1) + R (1, 0)) / s, 0.25f * s, (R (1, 2) + R (2, 1)) / s };
+        }
+        else
+        {
+            const float s = 2.0f * std::sqrt (1.0f + R (2, 2) - R (0, 0) - R (1, 1));
+            return { (R (1, 0) - R (0, 1)) / s, (R (0, 2) + R (2, 0)) / s, (R (1, 2) + R (2, 1)) / s, 0.25f * s };
+        }
+    }
+
+    static void toCartesianRotationMatrix (const iem::Quaternion<float>& q, juce::dsp::Matrix<float>& R) noexcept
+    {
+        R (0, 0) = 1.0f - 2.0f * (q.y * q.y + q.z * q.z);
+        R (0, 1) = 2.0f * (q.x * q.y - q.w * q.z);
+        R (0, 2) = 2.0f * (q.x * q.z + q.w * q.y);
+
+        R (1, 0) = 2.0f * (q.x * q.y + q.w * q.z);
+        R (1, 1) = 1.0f - 2.0f * (q.x * q.x + q.z * q.z);
+        R (1, 2) = 2.0f * (q.y * q.z - q.w * q.x);
+
+        R (2, 0) = 2.0f * (q.x * q.z - q.w * q.y);
+        R (2, 1) = 2.0f * (q.y * q.z + q.w * q.x);
+        R (2, 2) = 1.0f - 2.0f * (q.x * q.x + q.y * q.y);
+    }
+
+    /** Spherical linear interpolation along the shorter of the two arcs between a and b. */
+    static iem::Quaternion<float> slerp (const iem::Quaternion<float>& a, iem::Quaternion<float> b, const float t)
+    {
+        float cosAngle = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+        if (cosAngle < 0.0f)
+        {
+            b = b * -1.0f;
+            cosAngle = -cosAngle;
+        }
+
+        iem::Quaternion<float> q;
+        if (cosAngle > 0.9995f) // almost identical, linear interpolation is accurate enough
+            q = a * (1.0f - t) + b * t;
+        else
+        {
+            const float angle = std::acos (cosAngle);
+            const float sinAngle = std::sin (angle);
+            q = a * (std::sin ((1.0f - t) * angle) / sinAngle) + b * (std::sin (t * angle) / sinAngle);
+        }
+
+        q.normalize();
+        return q;
+    }
+
+    //==============================================================================
+    static void setFirstOrderMatrix (const juce::dsp::Matrix<float>& rotMat, juce::dsp::Matrix<float>& R1)
+    {
+        R1 (0, 0) = rotMat (1, 1);
+        R1 (0, 1) = rotMat (1, 2);
+        R1 (0, 2) = rotMat (1, 0);
+        R1 (1, 0) = rotMat (2, 1);
+        R1 (1, 1) = rotMat (2, 2);
+        R1 (1, 2) = rotMat (2, 0);
+        R1 (2, 0) = rotMat (0, 1);
+        R1 (2, 1) = rotMat (0, 2);
+        R1 (2, 2) = rotMat (0, 0);
+    }
+
+    /** Decomposes the cartesian rotation into rotMat = Rz (alpha) * Ry (beta) * Rz (gamma). */
+    static void getZYZEulerAngles (const juce::dsp::Matrix<float>& rotMat, double& alpha, double& beta, double& gamma)
+    {
+        alpha = std::atan2 (static_cast<double> (rotMat (1, 2)), static_cast<double> (rotMat (0, 2)));
+
+        // removing Rz (alpha) leaves Ry (beta) * Rz (gamma), whose angles are well-conditioned even for beta close to zero or pi
+        const double ca = std::cos (alpha);
+        const double sa = std::sin (alpha);
+        const double m02 = ca * rotMat (0, 2) + sa * rotMat (1, 2);
+        const double m10 = ca * rotMat (1, 0) - sa * rotMat (0, 0);
+        const double m11 = ca * rotMat (1, 1) - sa * rotMat (0, 1);
+
+        beta = std::atan2 (m02, static_cast<double> (rotMat (2, 2)));
+        gamma = std::atan2 (m10, m11);
+    }
+
+    static void getHarmonics (const double angle, const int maxL, float* cosines, float* sines)
+    {
+        const double c1 = std::cos (angle);
+        const double s1 = std::sin (angle);
+        double c = 1.0;
+        double s = 0.0;
+
+        for (int k = 0; k <= maxL; ++k)
+        {
+            cosines[k] = static_cast<float> (c);
+            sines[k] = static_cast<float> (s);
+
+            const double cNext = c * c1 - s * s1;
+            s = s * c1 + c * s1;
+            c = cNext;
+        }
+    }
+
+    /**
+     A rotation about the y-axis equals Q^T * Rz * Q, with Q the rotation by 90 degrees about the
+     x-axis. Rz (beta) only has the entries cos (k beta) and sin (k beta), so the SH rotation
+     matrix of Ry (beta) is the sum of 2l+1 constant matrices weighted with cos (0), cos (beta),
+     sin (beta), cos (2 beta), ... Most of their coefficients are zero, so only the others are stored.
+     */
+    void calcWignerTables()
+    {
+        juce::OwnedArray<juce::dsp::Matrix<float>> Q;
+        Q.add (new juce::dsp::Matrix<float> (0, 0));
+        for (int l = 1; l <= maxOrder; ++l)
+            Q.add (new juce::dsp::Matrix<float> (2 * l + 1, 2 * l + 1));
+
+        calcRotationMatricesRecursively (getCartesianRotationMatrix (0.0f, 0.0f, juce::MathConstants<float>::halfPi, false), Q, maxOrder);
+
+        for (int l = 2; l <= maxOrder; ++l)
+        {
+            const int nCh = 2 * l + 1;
+            auto& q = *Q[l];
+
+            auto addEntry = [&] (const int i, const int j, const int harmonic, const float coefficient)
+            {
+                if (std::abs (coefficient) > 1e-6f)
+                    wignerTables[l].add ({ i * nCh + j, harmonic, coefficient });
+            };
+
+            for (int i = 0; i < nCh; ++i)
+                for (int j = 0; j < nCh; ++j)
+                {
+                    addEntry (i, j, 0, q (l, i) * q (l, j));
+
+                    for (int k = 1; k <= l; ++k)
+                    {
+                        addEntry (i, j, 2 * k - 1, q (l - k, i) * q (l - k, j) + q (l + k, i) * q (l + k, j));
+                        addEntry (i, j, 2 * k, q (l - k, i) * q (l + k, j) - q (l + k, i) * q (l - k, j));
+                    }
+                }
+        }
+    }
+
+    static void calcRotationMatricesRecursively (const juce::dsp::Matrix<float>& rotMat, juce::OwnedArray<juce::dsp::Matrix<float>>& matrices, const int order)
+    {
+        setFirstOrderMatrix (rotMat, *matrices[1]);
+
+        for (int l = 2; l <= juce::jmin (order, maxOrder); ++l)
+        {
+            auto Rone = matrices[1];
+            auto Rlm1 = matrices[l - 1];
+            auto Rl = matrices[l];
+            for (int m = -l; m <= l; ++m)
+            {
+                for (int n = -l; n <= l; ++n)
+                {
+                    const int d = (m == 0) ? 1 : 0;
+                    double denom;
+                    if (abs(n) == l)
+                        denom = (2 * l) * (2 * l - 1);
+                    else
+                        denom = l * l - n * n;
+
+                    double u = sqrt ((l * l - m * m) / denom);
+                    double v = sqrt ((1.0 + d) * (l + abs (m) - 1.0) * (l + abs (m)) / denom) * (1.0 - 2.0 * d) * 0.5;
+                    double w = sqrt ((l - abs (m) - 1.0) * (l - abs (m)) / denom) * (1.0 - d) * (-0.5);
+
+                    if (u != 0.0)
+                        u *= U (l, m, n, *Rone, *Rlm1);
+                    if (v != 0.0)
+                        v *= V (l, m, n, *Rone, *Rlm1);
+                    if (w != 0.0)
+                        w *= W (l, m, n, *Rone, *Rlm1);
+
+                    Rl->operator() (m + l, n + l) = u + v + w;
+                }
+            }
+        }
+    }
+
+    static double P (int i, int l, int a, int b, juce::dsp::Matrix<float>& R1, juce::dsp::Matrix<float>& Rlm1)
+    {
+        double ri1 = R1 (i + 1, 2);
+        double rim1 = R1 (i + 1, 0);
+        double ri0 = R1 (i + 1, 1);
+
+        if (b == -l)
+            return ri1 * Rlm1(a + l - 1, 0) + rim1 * Rlm1(a + l - 1, 2 * l - 2);
+        else if (b == l)
+            return ri1 * Rlm1(a + l - 1, 2 * l - 2) - rim1 * Rlm1(a + l-1, 0);
+        else
+            return ri0 * Rlm1(a + l - 1, b + l - 1);
+    }
+
+    static double U (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
+    {
+        return P (0, l, m, n, Rone, Rlm1);
+    }
+
+    static double V (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
+    {
+        if (m == 0)
+        {
+            auto p0 = P (1, l, 1, n, Rone, Rlm1);
+            auto p1 = P (-1 , l, -1, n, Rone, Rlm1);
+            return p0 + p1;
+        }
+        else if (m > 0)
+        {
+            auto p0 = P (1, l, m - 1, n, Rone, Rlm1);
+            if (m == 1) // d = 1;
+                return p0 * sqrt (2);
+            else // d = 0;
+                return p0 - P (-1, l, 1 - m, n, Rone, Rlm1);
+        }
+        else
+        {
+            auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
+            if (m == -1) // d = 1;
+                return p1 * sqrt (2);
+            else // d = 0;
+                return p1 + P (1, l, m + 1, n, Rone, Rlm1);
+        }
+    }
+
+    static double W (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
+    {
+        if (m > 0)
+        {
+            auto p0 = P (1, l, m + 1, n, Rone, Rlm1);
+            auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
+            return p0 + p1;
+        }
+        else if (m < 0)
+        {
+            auto p0 = P(1, l, m - 1, n, Rone, Rlm1);
+            auto p1 = P (-1, l, 1 - m, n, Rone, Rlm1);
+            return p0 - p1;
+        }
+
+        return 0.0;
+    }
+
+    //==============================================================================
+    juce::OwnedArray<juce::dsp::Matrix<float>> orderMatrices;
+    juce::OwnedArray<juce::dsp::Matrix<float>> orderMatricesCopy;
+    struct WignerEntry
+    {
+        int index; // row * (2l+1) + column
+        int harmonic; // 0: constant, 2k-1: cos (k beta), 2k: sin (k beta)
+        float coefficient;
+    };
+
+    juce::Array<WignerEntry> wignerTables[maxOrder + 1];
+
+    juce::dsp::Matrix<float> cartesianRotation {3, 3};
+    juce::dsp::Matrix<float> subBlockRotation {3, 3}; // slerped rotation of processWithSubBlockUpdates()
+    bool hasCartesianRotation = false;
+
+    int calculatedOrder = maxOrder; // all matrices are zero before the first calculation
+    bool newRotationMatrix = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AmbisonicRotation)
+};
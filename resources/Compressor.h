@@ -21,12 +21,31 @@
  */
 
 #pragma once
+
+#include "SIMDHelpers.h"
+
 namespace iem
 {
 
+/**
+ Feed-forward compressor with a soft knee. The gain computer runs in three stages: the static
+ curve and the conversion back to linear gains are vectorised over the samples with
+ juce::dsp::SIMDRegister and fast log2 / exp2 approximations, only the recursive attack /
+ release ballistics run sample by sample. The ballistics of several compressors can run in
+ parallel SIMD lanes with getGainsFromSidechainSignals().
+
+ The approximations deviate less than 1e-4 dB from the exact level and gain conversions.
+ */
 class Compressor
 {
 public:
+   #if JUCE_USE_SIMD
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int simdSize = static_cast<int> (SIMDFloat::size());
+   #else
+    static constexpr int simdSize = 1;
+   #endif
+
     Compressor()
     {
     }
@@ -63,6 +82,7 @@ public:
     {
         knee = kneeInDecibels;
         kneeHalf = knee / 2.0f;
+        halfOverKnee = knee > 0.0f ? 0.5f / knee : 0.0f;
     }
 
     const float getKnee ()
@@ -113,50 +133,39 @@ public:
 
     void getGainFromSidechainSignal (const float* sideChainSignal, float* destination, const int numSamples)
     {
-        maxLevel = -INFINITY;
-        for (int i = 0; i < numSamples; ++i)
-        {
-            // convert sample to decibels
-            float levelInDecibels =  juce::Decibels::gainToDecibels(abs(sideChainSignal[i]));
-            if (levelInDecibels > maxLevel)
-                maxLevel = levelInDecibels;
-            // calculate overshoot and apply knee and ratio
-            float overShoot = levelInDecibels - threshold;
-            applyCharacteristicToOverShoot(overShoot); //y_G = levelInDecibels + slope * overShoot;
-
-            // ballistics
-            const float diff = overShoot - state;
-            if (diff < 0.0f)
-                state += alphaAttack * diff;
-            else
-                state += alphaRelease * diff;
-
-            destination[i] = juce::Decibels::decibelsToGain(state + makeUpGain);
-        }
+        getGainReductionFromSidechainSignal (sideChainSignal, destination, numSamples);
+        applyBallistics (destination, numSamples);
+        decibelsToGain (destination, makeUpGain, numSamples);
     }
 
     void getGainFromSidechainSignalInDecibelsWithoutMakeUpGain (const float* sideChainSignal, float* destination, const int numSamples)
     {
-        maxLevel = -INFINITY;
-        for (int i = 0; i < numSamples; ++i)
-        {
-            // convert sample to decibels
-            float levelInDecibels =  juce::Decibels::gainToDecibels(abs(sideChainSignal[i]));
-            if (levelInDecibels > maxLevel)
-                maxLevel = levelInDecibels;
-            // calculate overshoot and apply knee and ratio
-            float overShoot = levelInDecibels - threshold;
-            applyCharacteristicToOverShoot(overShoot); //y_G = levelInDecibels + slope * overShoot;
-
-            // ballistics
-            const float diff = overShoot - state;
-            if (diff < 0.0f)
-                state += alphaAttack * diff;
-            else
-                state += alphaRelease * diff;
-
-            destination[i] = state;
-        }
+        getGainReductionFromSidechainSignal (sideChainSignal, destination, numSamples);
+        applyBallistics (destination, numSamples);
+    }
+
+    /**
+     Same as calling getGainFromSidechainSignal() of each compressor, however, the ballistics of
+     up to simdSize compressors are calculated at once in parallel lanes.
+     */
+    static void getGainsFromSidechainSignals (Compressor* const* compressors, const float* const* sideChainSignals,
+                                              float* const* destinations, const int numCompressors, const int numSamples)
+    {
+        for (int c = 0; c < numCompressors; ++c)
+            compressors[c]->getGainReductionFromSidechainSignal (sideChainSignals[c], destinations[c], numSamples);
+
+        int first = 0;
+
+       #if JUCE_USE_SIMD
+        for (; first + 1 < numCompressors; first += simdSize)
+            applyBallisticsInLanes (compressors + first, destinations + first, juce::jmin (simdSize, numCompressors - first), numSamples);
+       #endif
+
+        for (; first < numCompressors; ++first)
+            compressors[first]->applyBallistics (destinations[first], numSamples);
+
+        for (int c = 0; c < numCompressors; ++c)
+            decibelsToGain (destinations[c], compressors[c]->makeUpGain, numSamples);
     }
 
     void getCharacteristic (float* inputLevels, float* dest, const int numSamples)
@@ -177,10 +186,232 @@ public:
 
 
 private:
+    //==============================================================================
+    /** Writes the static gain reduction in decibels (the characteristic applied to the overshoot) into destination. */
+    void getGainReductionFromSidechainSignal (const float* sideChainSignal, float* destination, const int numSamples)
+    {
+        float maxMagnitude = 0.0f;
+        int i = 0;
+
+       #if JUCE_USE_SIMD
+        auto maxMagnitudes = SIMDFloat::expand (0.0f);
+        for (; i + simdSize <= numSamples; i += simdSize)
+        {
+            const auto magnitude = abs (SIMDHelpers::loadUnaligned (sideChainSignal + i));
+            maxMagnitudes = SIMDFloat::max (maxMagnitudes, magnitude);
+            SIMDHelpers::storeUnaligned (destination + i, getGainReduction (magnitude));
+        }
+
+        for (int k = 0; k < simdSize; ++k)
+            maxMagnitude = juce::jmax (maxMagnitude, maxMagnitudes.get (static_cast<size_t> (k)));
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            const float magnitude = std::abs (sideChainSignal[i]);
+            maxMagnitude = juce::jmax (maxMagnitude, magnitude);
+            destination[i] = getGainReduction (magnitude);
+        }
+
+        maxLevel = numSamples > 0 ? juce::Decibels::gainToDecibels (maxMagnitude) : -INFINITY;
+    }
+
+    /** Branch-free version of applyCharacteristicToOverShoot(), for float and SIMDFloat. */
+    template <typename Type>
+    inline Type getGainReduction (const Type magnitude) const noexcept
+    {
+        const Type levelInDecibels = max (fastLog2 (magnitude) * decibelsPerOctave, minusInfinityDb);
+        const Type overShoot = levelInDecibels + (kneeHalf - threshold); // relative to the start of the knee
+        const Type inKnee = min (max (overShoot, 0.0f), knee);
+        return (inKnee * inKnee * halfOverKnee + max (overShoot - knee, 0.0f)) * slope;
+    }
+
+    void applyBallistics (float* data, const int numSamples) noexcept
+    {
+        const float attack = static_cast<float> (alphaAttack);
+        const float release = static_cast<float> (alphaRelease);
+        float s = state;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float diff = data[i] - s;
+            s += (diff < 0.0f ? attack : release) * diff;
+            data[i] = s;
+        }
+
+        state = s;
+    }
+
+    /** Replaces the gain reduction in decibels in data with linear gains, including the make-up gain. */
+    static void decibelsToGain (float* data, const float makeUpGainInDecibels, const int numSamples) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SIMD
+        for (; i + simdSize <= numSamples; i += simdSize)
+        {
+            const auto decibels = SIMDHelpers::loadUnaligned (data + i) + makeUpGainInDecibels;
+            const auto gain = fastExp2 (max (decibels, minusInfinityDb) * octavesPerDecibel);
+            SIMDHelpers::storeUnaligned (data + i, gain & SIMDFloat::greaterThan (decibels, SIMDFloat::expand (minusInfinityDb)));
+        }
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            const float decibels = data[i] + makeUpGainInDecibels;
+            data[i] = decibels > minusInfinityDb ? fastExp2 (decibels * octavesPerDecibel) : 0.0f;
+        }
+    }
+
+   #if JUCE_USE_SIMD
+    static void applyBallisticsInLanes (Compressor* const* compressors, float* const* data, const int numLanes, const int numSamples) noexcept
+    {
+        float lanes[simdSize] = {};
+        float attack[simdSize] = {};
+        float release[simdSize] = {};
+
+        for (int l = 0; l < numLanes; ++l)
+        {
+            lanes[l] = compressors[l]->state;
+            attack[l] = static_cast<float> (compressors[l]->alphaAttack);
+            release[l] = static_cast<float> (compressors[l]->alphaRelease);
+        }
+
+        auto s = SIMDHelpers::loadUnaligned (lanes);
+        const auto alphaRelease = SIMDHelpers::loadUnaligned (release);
+        const auto attackMinusRelease = SIMDHelpers::loadUnaligned (attack) - alphaRelease;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int l = 0; l < numLanes; ++l)
+                lanes[l] = data[l][i];
+
+            const auto diff = SIMDHelpers::loadUnaligned (lanes) - s;
+            s += (alphaRelease + (attackMinusRelease & SIMDFloat::lessThan (diff, SIMDFloat::expand (0.0f)))) * diff;
+
+            SIMDHelpers::storeUnaligned (lanes, s);
+            for (int l = 0; l < numLanes; ++l)
+                data[l][i] = lanes[l];
+        }
+
+        for (int l = 0; l < numLanes; ++l)
+            compressors[l]->state = lanes[l];
+    }
+   #endif
+
+    //==============================================================================
+    /*
+     Fast approximations of log2 and exp2: the exponent is taken from the floating point
+     representation, and the mantissa is approximated with a polynomial. The absolute error of
+     fastLog2 is below 1.6e-5 (1e-4 dB), the relative error of fastExp2 below 5e-6.
+     Inputs of fastLog2 have to be positive (zero returns -127), fastExp2 clips at +-126.
+     */
+    template <typename Type>
+    static inline Type fastLog2 (const Type x) noexcept
+    {
+        Type mantissa;
+        const Type exponent = splitFloat (x, mantissa);
+        const Type t = mantissa - 1.0f;
+        return exponent + ((((t * 0.0451481865f - 0.193573318f) * t + 0.415603758f) * t - 0.709095556f) * t + 1.44191693f) * t;
+    }
+
+    template <typename Type>
+    static inline Type fastExp2 (const Type x) noexcept
+    {
+        const Type biased = min (max (x, -126.0f), 126.0f) + 127.0f;
+        Type integerPart;
+        const Type powerOfTwo = getPowerOfTwo (biased, integerPart);
+        const Type t = biased - integerPart;
+        return powerOfTwo * ((((t * 0.0137019871f + 0.0517442687f) * t + 0.241549826f) * t + 0.693003918f) * t + 1.0f);
+    }
+
+    /** Returns the unbiased exponent of a positive float, and writes its mantissa (between 1 and 2) into mantissa. */
+    static inline float splitFloat (const float x, float& mantissa) noexcept
+    {
+        uint32_t bits;
+        std::memcpy (&bits, &x, sizeof (bits));
+
+        const uint32_t mantissaBits = (bits & 0x007fffffu) | 0x3f800000u;
+        std::memcpy (&mantissa, &mantissaBits, sizeof (mantissa));
+
+        return static_cast<float> (static_cast<int> (bits >> 23) - 127);
+    }
+
+    /** Returns 2^(floor (x) - 127) for x between 1 and 254, and writes floor (x) into integerPart. */
+    static inline float getPowerOfTwo (const float x, float& integerPart) noexcept
+    {
+        const int k = static_cast<int> (x);
+        integerPart = static_cast<float> (k);
+
+        const uint32_t bits = static_cast<uint32_t> (k) << 23;
+        float powerOfTwo;
+        std::memcpy (&powerOfTwo, &bits, sizeof (powerOfTwo));
+        return powerOfTwo;
+    }
+
+    static inline float abs (const float x) noexcept { return std::abs (x); }
+    static inline float min (const float a, const float b) noexcept { return juce::jmin (a, b); }
+    static inline float max (const float a, const float b) noexcept { return juce::jmax (a, b); }
+
+   #if JUCE_USE_SIMD
+    // juce::dsp::SIMDRegister has no integer shifts and conversions, so these work on the native type
+    static inline SIMDFloat splitFloat (const SIMDFloat x, SIMDFloat& mantissa) noexcept
+    {
+        SIMDFloat exponent;
+       #if JUCE_USE_SSE_INTRINSICS
+        const __m128i bits = _mm_castps_si128 (x.value);
+        mantissa.value = _mm_castsi128_ps (_mm_or_si128 (_mm_and_si128 (bits, _mm_set1_epi32 (0x007fffff)), _mm_set1_epi32 (0x3f800000)));
+        exponent.value = _mm_cvtepi32_ps (_mm_sub_epi32 (_mm_srli_epi32 (bits, 23), _mm_set1_epi32 (127)));
+       #elif JUCE_USE_ARM_NEON
+        const uint32x4_t bits = vreinterpretq_u32_f32 (x.value);
+        mantissa.value = vreinterpretq_f32_u32 (vorrq_u32 (vandq_u32 (bits, vdupq_n_u32 (0x007fffff)), vdupq_n_u32 (0x3f800000)));
+        exponent.value = vcvtq_f32_s32 (vsubq_s32 (vreinterpretq_s32_u32 (vshrq_n_u32 (bits, 23)), vdupq_n_s32 (127)));
+       #else
+        for (size_t k = 0; k < SIMDFloat::size(); ++k)
+        {
+            float m;
+            exponent.set (k, splitFloat (x.get (k), m));
+            mantissa.set (k, m);
+        }
+       #endif
+        return exponent;
+    }
+
+    static inline SIMDFloat getPowerOfTwo (const SIMDFloat x, SIMDFloat& integerPart) noexcept
+    {
+        SIMDFloat powerOfTwo;
+       #if JUCE_USE_SSE_INTRINSICS
+        const __m128i k = _mm_cvttps_epi32 (x.value);
+        integerPart.value = _mm_cvtepi32_ps (k);
+        powerOfTwo.value = _mm_castsi128_ps (_mm_slli_epi32 (k, 23));
+       #elif JUCE_USE_ARM_NEON
+        const int32x4_t k = vcvtq_s32_f32 (x.value);
+        integerPart.value = vcvtq_f32_s32 (k);
+        powerOfTwo.value = vreinterpretq_f32_s32 (vshlq_n_s32 (k, 23));
+       #else
+        for (size_t k = 0; k < SIMDFloat::size(); ++k)
+        {
+            float i;
+            powerOfTwo.set (k, getPowerOfTwo (x.get (k), i));
+            integerPart.set (k, i);
+        }
+       #endif
+        return powerOfTwo;
+    }
+
+    static inline SIMDFloat abs (const SIMDFloat x) noexcept { return SIMDFloat::abs (x); }
+    static inline SIMDFloat min (const SIMDFloat a, const float b) noexcept { return SIMDFloat::min (a, SIMDFloat::expand (b)); }
+    static inline SIMDFloat max (const SIMDFloat a, const float b) noexcept { return SIMDFloat::max (a, SIMDFloat::expand (b)); }
+   #endif
+
+    static constexpr float minusInfinityDb = -100.0f; // like juce::Decibels
+    static constexpr float decibelsPerOctave = 6.0205999f; // 20 * log10 (2)
+    static constexpr float octavesPerDecibel = 0.16609640f; // 1 / decibelsPerOctave
+
     double sampleRate {0.0};
     bool prepared;
 
-    float knee {0.0f}, kneeHalf {0.0f};
+    float knee {0.0f}, kneeHalf {0.0f}, halfOverKnee {0.0f};
     float threshold {- 10.0f};
     float attackTime {0.01f};
     float releaseTime {0.15f};
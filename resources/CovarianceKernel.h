@@ -0,0 +1,135 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+
+#pragma once
+
+#include "SIMDHelpers.h"
+
+/**
+ Register-blocked kernel for the covariance matrix C = X X^T of multichannel audio data. Only
+ the upper triangle is calculated, in tiles of rowsPerTile x columnsPerTile channel pairs, so
+ each sample of a channel is loaded once per tile instead of once per pair. The products are
+ accumulated in SIMD registers and summed up horizontally once per block.
+
+ Energies of any linear combination a of the channels, e.g. of beamformers, follow from the
+ covariance as the quadratic form a^T C a, without processing the signals again.
+ */
+class CovarianceKernel
+{
+public:
+   #if JUCE_USE_SIMD
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int simdSize = static_cast<int> (SIMDFloat::size());
+   #else
+    static constexpr int simdSize = 1;
+   #endif
+
+    static constexpr int rowsPerTile = 2;
+    static constexpr int columnsPerTile = 4;
+
+    /**
+     Calculates covariance[r * stride + c] = decay * covariance[r * stride + c] + gain * sum_n (input[r][n] * input[c][n])
+     for all nChannels x nChannels entries. With decay = 0 and gain = 1 / nSamples, it's the
+     covariance of the block, with 0 < decay < 1 it's smoothed over the blocks.
+
+     @param input       array of nChannels pointers to the channels
+     @param nChannels   number of channels
+     @param nSamples    number of samples
+     @param covariance  nChannels x nChannels matrix, row-major with the given stride
+     @param stride      number of floats between two rows of the covariance matrix
+     */
+    static void process (const float* const* input, const int nChannels, const int nSamples,
+                         float* covariance, const int stride, const float gain, const float decay = 0.0f) noexcept
+    {
+        for (int r = 0; r < nChannels; r += rowsPerTile)
+        {
+            if (r + rowsPerTile <= nChannels)
+                processRows<rowsPerTile> (input, nChannels, nSamples, r, covariance, stride, gain, decay);
+            else
+                processRows<1> (input, nChannels, nSamples, r, covariance, stride, gain, decay);
+        }
+
+        // mirror the upper triangle
+        for (int r = 1; r < nChannels; ++r)
+            for (int c = 0; c < r; ++c)
+                covariance[r * stride + c] = covariance[c * stride + r];
+    }
+
+private:
+    template <int numRows>
+    static inline void processRows (const float* const* input, const int nChannels, const int nSamples, const int row,
+                                    float* covariance, const int stride, const float gain, const float decay) noexcept
+    {
+        int c = row;
+        for (; c + columnsPerTile <= nChannels; c += columnsPerTile)
+            processTile<numRows, columnsPerTile> (input, nSamples, row, c, covariance, stride, gain, decay);
+
+        for (; c < nChannels; ++c)
+            processTile<numRows, 1> (input, nSamples, row, c, covariance, stride, gain, decay);
+    }
+
+    template <int numRows, int numColumns>
+    static inline void processTile (const float* const* input, const int nSamples, const int row, const int column,
+                                    float* covariance, const int stride, const float gain, const float decay) noexcept
+    {
+        float sums[numRows][numColumns] = {};
+        int n = 0;
+
+       #if JUCE_USE_SIMD
+        SIMDFloat acc[numRows][numColumns];
+        for (int r = 0; r < numRows; ++r)
+            for (int c = 0; c < numColumns; ++c)
+                acc[r][c] = SIMDFloat::expand (0.0f);
+
+        for (; n + simdSize <= nSamples; n += simdSize)
+        {
+            SIMDFloat x[numRows];
+            for (int r = 0; r < numRows; ++r)
+                x[r] = SIMDHelpers::loadUnaligned (input[row + r] + n);
+
+            for (int c = 0; c < numColumns; ++c)
+            {
+                const auto y = SIMDHelpers::loadUnaligned (input[column + c] + n);
+                for (int r = 0; r < numRows; ++r)
+                    acc[r][c] += x[r] * y;
+            }
+        }
+
+        for (int r = 0; r < numRows; ++r)
+            for (int c = 0; c < numColumns; ++c)
+                sums[r][c] = acc[r][c].sum();
+       #endif
+
+        for (; n < nSamples; ++n)
+            for (int r = 0; r < numRows; ++r)
+                for (int c = 0; c < numColumns; ++c)
+                    sums[r][c] += input[row + r][n] * input[column + c][n];
+
+        for (int r = 0; r < numRows; ++r)
+        {
+            float* dest = covariance + (row + r) * stride + column;
+            for (int c = 0; c < numColumns; ++c)
+                dest[c] = decay * dest[c] + gain * sums[r][c];
+        }
+    }
+};
@@ -22,12 +22,35 @@
 
 
 #pragma once
-#include "WalshHadamard/fwht.h"
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "SIMDHelpers.h"
 using namespace juce::dsp;
+
+/**
+ Feedback delay network with shelving filters in each delay line and a Walsh-Hadamard
+ feedback matrix.
+
+ The delay lines and filter states are stored as structure of arrays and the network is
+ processed in runs of up to the shortest delay length: within such a run every delay line
+ only reads samples which have been written before the run started, so the reads, the
+ filtering, the Hadamard mixing and the writes can each be done for the whole run at once.
+ During a run the samples are kept frame-wise (all delay lines of one sample next to each
+ other), so the filters and the butterflies process several delay lines in the lanes of a
+ juce::dsp::SIMDRegister.
+ */
 class FeedbackDelayNetwork : private ProcessorBase
 {
     static constexpr int maxDelayLength = 30;
+    static constexpr int maxNetworkSize = 64;
+    static constexpr int maxRunLength = 128;
+
+   #if JUCE_USE_SIMD
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int simdSize = static_cast<int> (SIMDFloat::size());
+   #else
+    static constexpr int simdSize = 1;
+   #endif
+
 public:
     enum FdnSize {
         uninitialized = 0,
@@ -48,6 +71,9 @@ public:
 
     FeedbackDelayNetwork (FdnSize size = big)
     {
+        frames.allocate (maxRunLength * maxNetworkSize, true);
+        inputFrames.allocate (maxRunLength * maxNetworkSize, true);
+        inputEnergies.allocate (3 * maxRunLength, true);
         updateFdnSize (size);
         setDelayLength (20);
         dryWet = 0.5f;
@@ -68,18 +94,23 @@ public:
         params.dryWetChanged = true;
     }
 
+    /**
+     Allocates the delay lines, call it from prepareToPlay only. They are allocated for the biggest
+     network and the longest delay lines, so the size and the delay length can be changed while
+     playing without allocating.
+     */
     void prepare (const juce::dsp::ProcessSpec& newSpec) override {
         spec = newSpec;
 
-        indices = indexGen (fdnSize, delayLength);
-        updateParameterSettings();
+        const int maxDelayLengthInSamples = getMaxDelayLengthInSamples();
+        delayLines.setSize (maxNetworkSize, maxDelayLengthInSamples);
 
-        for (int ch = 0; ch < fdnSize; ++ch)
-        {
-            delayBufferVector[ch]->clear();
-            lowShelfFilters[ch]->reset();
-            highShelfFilters[ch]->reset();
-        }
+        // the fade-in gains are looked up as far back as the longest possible delay line
+        fadeInGainHistoryLength = maxDelayLengthInSamples + maxRunLength;
+        fadeInGainHistory.allocate (fadeInGainHistoryLength, true);
+
+        updateParameterSettings();
+        reset();
     }
 
     void process (const juce::dsp::ProcessContextReplacing<float>& context) override {
@@ -102,16 +133,14 @@ public:
 
         if (params.networkSizeChanged)
         {
-            fdnSize = params.newNetworkSize;
+            updateFdnSize (params.newNetworkSize);
             params.needParameterUpdate = true;
             params.networkSizeChanged = false;
-            updateFdnSize (fdnSize);
         }
 
         if (params.delayLengthChanged)
         {
             delayLength = params.newDelayLength;
-            indices = indexGen (fdnSize, delayLength);
             params.needParameterUpdate = true;
             params.delayLengthChanged = false;
         }
@@ -123,6 +152,16 @@ public:
             params.needParameterUpdate = true;
         }
 
+        if (params.fadeInChanged)
+        {
+            if (fadeInGain == 0.0f)
+                resetFadeInEnergies();
+
+            fadeInGain = params.newFadeInGain;
+            params.fadeInChanged = false;
+            params.needParameterUpdate = true;
+        }
+
         if (params.needParameterUpdate)
             updateParameterSettings();
         params.needParameterUpdate = false;
@@ -133,29 +172,8 @@ public:
         const int nChannels = static_cast<int> (buffer.getNumChannels());
         const int numSamples = static_cast<int> (buffer.getNumSamples());
 
-        //TODO andere belegung?
-
-        // if more channels than network order, mix pairs of high order channels
-        // until order == number of channels
-//        if (nChannels > fdnSize)
-//        {
-//            int diff = nChannels - fdnSize;
-//            int start_index = nChannels - diff * 2;
-//
-//            for (int num = 0; num < diff; ++num)
-//            {
-//                int idx = start_index + num;
-//
-//                float* writeIn = buffer.getChannelPointer (idx);
-//                const float* writeOut1 = buffer.getChannelPointer (idx + num);
-//                const float* writeOut2 = buffer.getChannelPointer (idx + num + 1);
-//
-//                for (int i = 0; i < numSamples; ++i)
-//                {
-//                    writeIn[i] = (writeOut1[i] + writeOut2[i]) / sqrt(2.f);
-//                }
-//            }
-//        }
+        // channels exceeding the network size are left untouched
+        const int nIOChannels = juce::jmin (nChannels, static_cast<int> (fdnSize));
 
         float dryGain;
         if (freeze)
@@ -163,83 +181,95 @@ public:
         else
             dryGain = 1.0f - dryWet;
 
-        for (int i = 0; i < numSamples; ++i)
+        // the normalization of the Walsh-Hadamard transform is part of the transfer gains
+        const float* transferGains = freeze ? freezeGainVector : feedbackGainVector;
+
+        const bool applyFadeIn = ! freeze && fadeInGain > 0.0f;
+
+        const int runLength = juce::jmin (minDelayLength, maxRunLength);
+        for (int start = 0; start < numSamples; start += runLength)
         {
-            // apply delay to each channel for one time sample
-            for (int channel = 0; channel < fdnSize; ++channel)
+            const int numFrames = juce::jmin (runLength, numSamples - start);
+
+            readFromDelayLines (numFrames);
+
+            if (applyFadeIn)
             {
-                const int idx = std::min(channel, nChannels - 1);
-                float *const channelData = buffer.getChannelPointer (idx);
-                float *const delayData = delayBufferVector[channel]->getWritePointer (0);
+                updateFadeInGains (buffer, start, nIOChannels, numFrames);
 
-                int delayPos = delayPositionVector[channel];
+                // the input also runs through a copy of the shelving filters, so its direct path can be
+                // removed from the output, as it cancels out in the difference of the two reverbs
+                for (int channel = 0; channel < nIOChannels; ++channel)
+                {
+                    const float* channelData = buffer.getChannelPointer (channel) + start;
+                    float* dest = frames + channel;
+                    float* inputDest = inputFrames + channel;
+                    for (int i = 0; i < numFrames; ++i)
+                    {
+                        dest[i * fdnSize] += channelData[i];
+                        inputDest[i * fdnSize] = channelData[i];
+                    }
+                }
 
-                const float inSample = channelData[i];
-                if (!freeze) {
-                    // data exchange between IO buffer and delay buffer
+                processShelvingFilters (frames, highShelfFilters, lowShelfFilters, fdnSize, numFrames);
+                processShelvingFilters (inputFrames, inputHighShelfFilters, inputLowShelfFilters, nIOChannels, numFrames);
 
-                    if (channel < nChannels)
-                        delayData[delayPos] += inSample;
+                const float wetGain = fadeInSign * dryWet;
+                for (int channel = 0; channel < nIOChannels; ++channel)
+                {
+                    float* channelData = buffer.getChannelPointer (channel) + start;
+                    const float* src = frames + channel;
+                    const float* direct = inputFrames + channel;
+
+                    // the echoes leaving a delay line have entered it delayLength samples ago
+                    int historyIndex = fadeInGainHistoryPosition - delayLengths[channel];
+                    if (historyIndex < 0)
+                        historyIndex += fadeInGainHistoryLength;
+
+                    for (int i = 0; i < numFrames; ++i)
+                    {
+                        const float gain = fadeInGainHistory[historyIndex] * wetGain;
+                        channelData[i] = (src[i * fdnSize] - direct[i * fdnSize]) * gain + channelData[i] * dryGain;
+                        if (++historyIndex >= fadeInGainHistoryLength)
+                            historyIndex = 0;
+                    }
                 }
 
-                if (!freeze)
+                fadeInGainHistoryPosition = (fadeInGainHistoryPosition + numFrames) % fadeInGainHistoryLength;
+            }
+            else
+            {
+                if (! freeze)
                 {
-                    // apply shelving filters
-                    delayData[delayPos] = highShelfFilters[channel]->processSingleSampleRaw(delayData[delayPos]);
-                    delayData[delayPos] = lowShelfFilters[channel]->processSingleSampleRaw(delayData[delayPos]);
+                    for (int channel = 0; channel < nIOChannels; ++channel)
+                    {
+                        const float* channelData = buffer.getChannelPointer (channel) + start;
+                        float* dest = frames + channel;
+                        for (int i = 0; i < numFrames; ++i)
+                            dest[i * fdnSize] += channelData[i];
+                    }
+
+                    processShelvingFilters (frames, highShelfFilters, lowShelfFilters, fdnSize, numFrames);
                 }
 
-                if (channel < nChannels)
+                for (int channel = 0; channel < nIOChannels; ++channel)
                 {
-                    channelData[i] = delayData[delayPos] * dryWet;
-                    channelData[i] += inSample * dryGain;
+                    float* channelData = buffer.getChannelPointer (channel) + start;
+                    const float* src = frames + channel;
+                    for (int i = 0; i < numFrames; ++i)
+                        channelData[i] = src[i * fdnSize] * dryWet + channelData[i] * dryGain;
                 }
-                if (!freeze)
-                    transferVector.set(channel, delayData[delayPos] * feedbackGainVector [channel]);
-                else
-                    transferVector.set(channel, delayData[delayPos]);
             }
 
-            // perform fast walsh hadamard transform
-            fwht (transferVector.getRawDataPointer(), transferVector.size());
-
-            // write back into delay buffer
-            // increment the delay buffer pointer
-            for (int channel = 0; channel < fdnSize; ++channel)
+            for (int i = 0; i < numFrames; ++i)
             {
-                float *const delayData = delayBufferVector[channel]->getWritePointer (0); // the buffer is single channel
-
-                int delayPos = delayPositionVector[channel];
-
-                delayData[delayPos] = transferVector[channel];
-
-                if (++delayPos >= delayBufferVector[channel]->getNumSamples())
-                    delayPos = 0;
-
-                delayPositionVector.set(channel, delayPos);
+                float* frame = frames + i * fdnSize;
+                juce::FloatVectorOperations::multiply (frame, transferGains, fdnSize);
+                walshHadamardTransform (frame);
             }
+
+            writeToDelayLines (numFrames);
         }
-        // if more channels than network order, mix pairs of high order channels
-        // until order == number of channels
-//        if (nChannels > fdnSize)
-//        {
-//            int diff = nChannels - fdnSize;
-//            int start_index = nChannels - diff * 2;
-//
-//            for (int num = diff - 1; num < 0; --num)
-//            {
-//                int idx = start_index + num;
-//                float *const writeOut = buffer.getChannelPointer (idx);
-//                float *const writeIn1 = buffer.getChannelPointer (idx + num);
-//                float *const writeIn2 = buffer.getChannelPointer (idx + num + 1);
-//
-//                for (int i = 0; i < numSamples; ++i)
-//                {
-//                    writeIn1[i] = writeOut[i] / sqrt(2.f);
-//                    writeIn2[i] = writeIn1[i];
-//                }
-//            }
-//        }
     }
 
     void setDelayLength (int newDelayLength)
@@ -248,9 +278,15 @@ public:
         params.delayLengthChanged = true;
     }
 
-    void reset() override {
-
+    /** Clears the delay lines and the filters, without allocating. */
+    void reset() override
+    {
+        delayLines.clear();
+        highShelfFilters.reset();
+        lowShelfFilters.reset();
+        resetFadeInEnergies();
     }
+
     void setFilterParameter(FilterParameter lowShelf, FilterParameter highShelf) {
         params.newLowShelfParams = lowShelf;
         params.newHighShelfParams = highShelf;
@@ -272,6 +308,21 @@ public:
         params.overallGainChanged = true;
     }
 
+    /**
+     Sets the fade-in time of the reverb. The reverb then corresponds to the difference of the
+     reverb with the set reverberation time and one with the fade-in time as reverberation time.
+     A fade-in time of zero turns the fade-in off.
+     */
+    void setFadeInTime (float fadeInTime)
+    {
+        if (fadeInTime <= 0.0f)
+            params.newFadeInGain = 0.0f;
+        else
+            params.newFadeInGain = pow (10.0, -60.0 / (20.0 * fadeInTime));
+
+        params.fadeInChanged = true;
+    }
+
     void getT60ForFrequencyArray(double* frequencies, double* t60Data, size_t numSamples) {
         juce::dsp::IIR::Coefficients<float> coefficients;
         coefficients = *IIR::Coefficients<float>::makeLowShelf (spec.sampleRate, juce::jmin (0.5 * spec.sampleRate, static_cast<double> (lowShelfParameters.frequency)), lowShelfParameters.q, lowShelfParameters.linearGain);
@@ -314,22 +365,84 @@ public:
 
 private:
     //==============================================================================
+    /**
+     One biquad per delay line, stored as structure of arrays so the filters of neighbouring
+     delay lines can be loaded into the lanes of a SIMD register. The difference equations are
+     the same as juce::IIRFilter's (transposed direct form II).
+     */
+    struct BiquadBank
+    {
+        float b0[maxNetworkSize] {}, b1[maxNetworkSize] {}, b2[maxNetworkSize] {};
+        float a1[maxNetworkSize] {}, a2[maxNetworkSize] {};
+        float z1[maxNetworkSize] {}, z2[maxNetworkSize] {};
+
+        void setCoefficients (const int channel, const juce::IIRCoefficients& newCoefficients) noexcept
+        {
+            b0[channel] = newCoefficients.coefficients[0];
+            b1[channel] = newCoefficients.coefficients[1];
+            b2[channel] = newCoefficients.coefficients[2];
+            a1[channel] = newCoefficients.coefficients[3];
+            a2[channel] = newCoefficients.coefficients[4];
+        }
+
+        void copyCoefficients (const int channel, const BiquadBank& other) noexcept
+        {
+            b0[channel] = other.b0[channel];
+            b1[channel] = other.b1[channel];
+            b2[channel] = other.b2[channel];
+            a1[channel] = other.a1[channel];
+            a2[channel] = other.a2[channel];
+        }
+
+        void reset (const int channel) noexcept
+        {
+            z1[channel] = 0.0f;
+            z2[channel] = 0.0f;
+        }
+
+        void reset() noexcept
+        {
+            juce::FloatVectorOperations::clear (z1, maxNetworkSize);
+            juce::FloatVectorOperations::clear (z2, maxNetworkSize);
+        }
+    };
+
     juce::dsp::ProcessSpec spec = {-1, 0, 0};
 
-    juce::OwnedArray<juce::AudioBuffer<float>> delayBufferVector;
-    juce::OwnedArray<juce::IIRFilter> highShelfFilters;
-    juce::OwnedArray<juce::IIRFilter> lowShelfFilters;
-    juce::Array<int> delayPositionVector;
-    juce::Array<float> feedbackGainVector;
-    juce::Array<float> transferVector;
+    juce::AudioBuffer<float> delayLines; // one channel per delay line, each using the first delayLengths[channel] samples
+    int delayLengths[maxNetworkSize] {};
+    int delayPositions[maxNetworkSize] {};
+    int minDelayLength = 1;
+
+    BiquadBank highShelfFilters, lowShelfFilters;
+    BiquadBank inputHighShelfFilters, inputLowShelfFilters; // the direct path of the input, for the fade-in
+    float feedbackGainVector[maxNetworkSize] {};
+    float freezeGainVector[maxNetworkSize] {};
+
+    juce::HeapBlock<float> frames; // maxRunLength frames with fdnSize samples each
+    juce::HeapBlock<float> inputFrames; // like frames, the filtered input of the fade-in
+    juce::HeapBlock<float> inputEnergies; // three times maxRunLength, used for the fade-in
 
     std::vector<int> primeNumbers;
-    std::vector<int> indices;
+    int indices[maxNetworkSize] {};
 
     FilterParameter lowShelfParameters, highShelfParameters;
     float dryWet;
     float delayLength = 20;
     float overallGain;
+    float fadeInGain = 0.0f;
+
+    // energy envelopes of the network, the other (shorter) reverb and their cross term
+    double networkEnergy = 0.0, otherEnergy = 0.0, crossEnergy = 0.0;
+    double networkEnergyDecay = 0.0, otherEnergyDecay = 0.0, crossEnergyDecay = 0.0;
+    float networkInputWeights[maxNetworkSize] {};
+    float crossInputWeights[maxNetworkSize] {};
+    float otherInputWeights[maxNetworkSize] {};
+    double echoDensity = 0.0;
+    float fadeInSign = 1.0f;
+
+    juce::HeapBlock<float> fadeInGainHistory; // gains of the samples written into the delay lines
+    int fadeInGainHistoryLength = 1, fadeInGainHistoryPosition = 0;
 
 
     bool freeze = false;
@@ -353,6 +466,9 @@ private:
         bool overallGainChanged = false;
         float newOverallGain = 0.5;
 
+        bool fadeInChanged = false;
+        float newFadeInGain = 0.0f;
+
         bool needParameterUpdate = false;
     };
 
@@ -365,6 +481,14 @@ private:
         return int (delayLenMillisec / 1000.f * spec.sampleRate); //convert to samples
     }
 
+    /** Returns the length of the longest delay line, which is the last one with the largest network size and delay length. */
+    int getMaxDelayLengthInSamples()
+    {
+        int maxIndices[maxNetworkSize];
+        indexGen (big, maxDelayLength, maxIndices);
+        return int (primeNumbers[maxIndices[big - 1]] / 10.f / 1000.f * spec.sampleRate) + 1;
+    }
+
     inline float channelGainConversion (int channel, float gain)
     {
         int delayLenSamples = delayLengthConversion(channel);
@@ -373,17 +497,16 @@ private:
         return pow (gain, length);
     }
 
-    std::vector<int> indexGen (FdnSize nChannels, int delayLength)
+    /** Writes the indices of the delay lines' prime numbers into newIndices, which has to hold nChannels values. */
+    void indexGen (FdnSize nChannels, int delayLength, int* newIndices)
     {
         const int firstIncrement = delayLength / 10;
         const int finalIncrement = delayLength;
 
-        std::vector<int> indices;
-
         if (firstIncrement < 1)
-            indices.push_back (1.f);
+            newIndices[0] = 1;
         else
-            indices.push_back (firstIncrement);
+            newIndices[0] = firstIncrement;
 
         float increment;
         int index;
@@ -395,10 +518,9 @@ private:
             if (increment < 1)
                 increment = 1.f;
 
-            index = int (round (indices[i-1] + increment));
-            indices.push_back (index);
+            index = int (round (newIndices[i-1] + increment));
+            newIndices[i] = index;
         }
-        return indices;
     }
 
     std::vector<int> primeNumGen (int count)
@@ -426,39 +548,291 @@ private:
         return series;
     }
 
+    /** The network always decays with the longer one of the reverberation and the fade-in time. */
+    float getNetworkGain() const noexcept
+    {
+        return juce::jmax (overallGain, fadeInGain);
+    }
+
+    void resetFadeInEnergies() noexcept
+    {
+        networkEnergy = 0.0;
+        otherEnergy = 0.0;
+        crossEnergy = 0.0;
+
+        // the tail which is already in the network is left as it is
+        if (fadeInGainHistory != nullptr)
+            juce::FloatVectorOperations::fill (fadeInGainHistory, 1.0f, fadeInGainHistoryLength);
+        fadeInGainHistoryPosition = 0;
+
+        inputHighShelfFilters.reset();
+        inputLowShelfFilters.reset();
+    }
+
+    /**
+     The fade-in reverb is the difference of two reverbs with the same network and the gains g
+     and f per second. Instead of running a second network, the network decays with the larger
+     gain g and its output is scaled by the ratio of the difference's amplitude to its own.
+
+     An echo which enters the network through delay line i and is written into delay line o
+     tau seconds later is weighted with g^a, with a = tau + l_i and l the delay lengths in
+     seconds, as the feedback gain is applied to the line the signal has been read from. The
+     difference is g^a - f^a, so the squared gain is 1 - 2 * Ec / Eg + Ef / Eg, with Eg, Ec and
+     Ef the input energies weighted with g^2a, (gf)^a and f^2a. Besides the direct echo with
+     tau = 0, there are about echoDensity echoes per sample, so the energies take three
+     one-pole filters. The gain is calculated for each sample written into the delay lines and
+     applied when it's read again, which makes it exact for an impulse.
+     */
+    void updateFadeInGains (const juce::dsp::AudioBlock<float>& buffer, const int start,
+                            const int nIOChannels, const int numFrames) noexcept
+    {
+        float* energies = inputEnergies;
+        float* crossEnergies = inputEnergies + maxRunLength;
+        float* otherEnergies = inputEnergies + 2 * maxRunLength;
+        juce::FloatVectorOperations::clear (inputEnergies, 3 * maxRunLength);
+
+        for (int channel = 0; channel < nIOChannels; ++channel)
+        {
+            const float* channelData = buffer.getChannelPointer (channel) + start;
+            const float wg = networkInputWeights[channel];
+            const float wc = crossInputWeights[channel];
+            const float wf = otherInputWeights[channel];
+            for (int i = 0; i < numFrames; ++i)
+            {
+                const float e = channelData[i] * channelData[i];
+                energies[i] += e * wg;
+                crossEnergies[i] += e * wc;
+                otherEnergies[i] += e * wf;
+            }
+        }
+
+        int historyIndex = fadeInGainHistoryPosition;
+        for (int i = 0; i < numFrames; ++i)
+        {
+            networkEnergy = networkEnergy * networkEnergyDecay + energies[i];
+            crossEnergy = crossEnergy * crossEnergyDecay + crossEnergies[i];
+            otherEnergy = otherEnergy * otherEnergyDecay + otherEnergies[i];
+
+            const double eg = energies[i] + echoDensity * networkEnergy;
+            const double ec = crossEnergies[i] + echoDensity * crossEnergy;
+            const double ef = otherEnergies[i] + echoDensity * otherEnergy;
+
+            const double gainSquared = eg > 1.0e-20 ? 1.0 - (2.0 * ec - ef) / eg : 1.0;
+            fadeInGainHistory[historyIndex] = static_cast<float> (std::sqrt (juce::jmax (0.0, gainSquared)));
+            if (++historyIndex >= fadeInGainHistoryLength)
+                historyIndex = 0;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    void readFromDelayLines (const int numFrames) noexcept
+    {
+        for (int channel = 0; channel < fdnSize; ++channel)
+        {
+            const float* delayData = delayLines.getReadPointer (channel);
+            const int length = delayLengths[channel];
+            int delayPos = delayPositions[channel];
+            float* dest = frames + channel;
+
+            for (int i = 0; i < numFrames; ++i)
+            {
+                dest[i * fdnSize] = delayData[delayPos];
+                if (++delayPos >= length)
+                    delayPos = 0;
+            }
+        }
+    }
+
+    void writeToDelayLines (const int numFrames) noexcept
+    {
+        for (int channel = 0; channel < fdnSize; ++channel)
+        {
+            float* delayData = delayLines.getWritePointer (channel);
+            const int length = delayLengths[channel];
+            int delayPos = delayPositions[channel];
+            const float* src = frames + channel;
+
+            for (int i = 0; i < numFrames; ++i)
+            {
+                delayData[delayPos] = src[i * fdnSize];
+                if (++delayPos >= length)
+                    delayPos = 0;
+            }
+
+            delayPositions[channel] = delayPos;
+        }
+    }
+
+    /** Runs the shelving filters of the first numChannels delay lines over all frames of data. */
+    void processShelvingFilters (float* data, BiquadBank& highShelf, BiquadBank& lowShelf,
+                                 const int numChannels, const int numFrames) noexcept
+    {
+        int channel = 0;
+       #if JUCE_USE_SIMD
+        for (; channel + simdSize <= numChannels; channel += simdSize)
+            processShelvingFilters<SIMDFloat> (data, highShelf, lowShelf, channel, numFrames);
+       #endif
+        for (; channel < numChannels; ++channel)
+            processShelvingFilters<float> (data, highShelf, lowShelf, channel, numFrames);
+    }
+
+    /** Runs the high shelf and the low shelf of the delay lines [firstChannel, firstChannel + lanes) over all frames. */
+    template <typename Type>
+    void processShelvingFilters (float* data, BiquadBank& hs, BiquadBank& ls, const int firstChannel, const int numFrames) noexcept
+    {
+        const int ch = firstChannel;
+
+        const Type hsB0 = load<Type> (hs.b0 + ch), hsB1 = load<Type> (hs.b1 + ch), hsB2 = load<Type> (hs.b2 + ch);
+        const Type hsA1 = load<Type> (hs.a1 + ch), hsA2 = load<Type> (hs.a2 + ch);
+        const Type lsB0 = load<Type> (ls.b0 + ch), lsB1 = load<Type> (ls.b1 + ch), lsB2 = load<Type> (ls.b2 + ch);
+        const Type lsA1 = load<Type> (ls.a1 + ch), lsA2 = load<Type> (ls.a2 + ch);
+
+        Type hsZ1 = load<Type> (hs.z1 + ch), hsZ2 = load<Type> (hs.z2 + ch);
+        Type lsZ1 = load<Type> (ls.z1 + ch), lsZ2 = load<Type> (ls.z2 + ch);
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            float* frame = data + i * fdnSize + ch;
+            const Type in = load<Type> (frame);
+
+            const Type hsOut = hsB0 * in + hsZ1;
+            hsZ1 = hsB1 * in - hsA1 * hsOut + hsZ2;
+            hsZ2 = hsB2 * in - hsA2 * hsOut;
+
+            const Type lsOut = lsB0 * hsOut + lsZ1;
+            lsZ1 = lsB1 * hsOut - lsA1 * lsOut + lsZ2;
+            lsZ2 = lsB2 * hsOut - lsA2 * lsOut;
+
+            store (frame, lsOut);
+        }
+
+        store (hs.z1 + ch, hsZ1);
+        store (hs.z2 + ch, hsZ2);
+        store (ls.z1 + ch, lsZ1);
+        store (ls.z2 + ch, lsZ2);
+    }
+
+    /** Unnormalized, naturally ordered fast Walsh-Hadamard transform of one frame. */
+    void walshHadamardTransform (float* frame) const noexcept
+    {
+        for (int h = 1; h < fdnSize; h *= 2)
+        {
+            for (int j = 0; j < fdnSize; j += 2 * h)
+            {
+                int k = j;
+               #if JUCE_USE_SIMD
+                for (; k + simdSize <= j + h; k += simdSize)
+                {
+                    const auto a = load<SIMDFloat> (frame + k);
+                    const auto b = load<SIMDFloat> (frame + k + h);
+                    store (frame + k, a + b);
+                    store (frame + k + h, a - b);
+                }
+               #endif
+                for (; k < j + h; ++k)
+                {
+                    const float a = frame[k];
+                    const float b = frame[k + h];
+                    frame[k] = a + b;
+                    frame[k + h] = a - b;
+                }
+            }
+        }
+    }
+
+    template <typename Type>
+    static inline Type load (const float* src) noexcept
+    {
+        Type value;
+        load (src, value);
+        return value;
+    }
+
+    static inline void load (const float* src, float& dest) noexcept { dest = *src; }
+    static inline void store (float* dest, const float value) noexcept { *dest = value; }
+
+   #if JUCE_USE_SIMD
+    static inline void load (const float* src, SIMDFloat& dest) noexcept { dest = SIMDHelpers::loadUnaligned (src); }
+    static inline void store (float* dest, const SIMDFloat reg) noexcept { SIMDHelpers::storeUnaligned (dest, reg); }
+   #endif
+
     //------------------------------------------------------------------------------
     inline void updateParameterSettings()
     {
-        indices = indexGen (fdnSize, delayLength);
+        indexGen (fdnSize, delayLength, indices);
 
+        // not prepared yet
+        if (delayLines.getNumSamples() == 0)
+            return;
+
+        minDelayLength = delayLines.getNumSamples();
         for (int channel = 0; channel < fdnSize; ++channel)
         {
             // update multichannel delay parameters
-            int delayLenSamples = delayLengthConversion (channel);
-            delayBufferVector[channel]->setSize (1, delayLenSamples, true, true, true);
-            if (delayPositionVector[channel] >= delayBufferVector[channel]->getNumSamples())
-                delayPositionVector.set(channel, 0);
+            const int delayLenSamples = juce::jlimit (1, delayLines.getNumSamples(), delayLengthConversion (channel));
+
+            // samples which become part of the delay line again must not be played back
+            if (delayLenSamples > delayLengths[channel])
+                delayLines.clear (channel, delayLengths[channel], delayLenSamples - delayLengths[channel]);
+
+            delayLengths[channel] = delayLenSamples;
+            if (delayPositions[channel] >= delayLenSamples)
+                delayPositions[channel] = 0;
+
+            minDelayLength = juce::jmin (minDelayLength, delayLenSamples);
         }
         updateFeedBackGainVector();
         updateFilterCoefficients();
+        updateFadeInEnergyDecays();
 
     }
 
     void updateFeedBackGainVector()
     {
+        const float normalization = 1.0f / std::sqrt (static_cast<float> (fdnSize));
         for (int channel = 0; channel < fdnSize; ++channel)
         {
-            feedbackGainVector.set(channel, channelGainConversion(channel, overallGain));
+            feedbackGainVector[channel] = channelGainConversion (channel, getNetworkGain()) * normalization;
+            freezeGainVector[channel] = normalization;
         }
     }
 
+    void updateFadeInEnergyDecays()
+    {
+        const double g = getNetworkGain();
+        const double f = juce::jmin (overallGain, fadeInGain);
+
+        if (spec.sampleRate > 0 && g > 0.0)
+        {
+            networkEnergyDecay = pow (g, 2.0 / spec.sampleRate);
+            otherEnergyDecay = pow (f, 2.0 / spec.sampleRate);
+            crossEnergyDecay = pow (g * f, 1.0 / spec.sampleRate);
+
+            int sumOfLengths = 0;
+            for (int channel = 0; channel < fdnSize; ++channel)
+            {
+                const double length = delayLengths[channel] / spec.sampleRate;
+                networkInputWeights[channel] = static_cast<float> (pow (g, 2.0 * length));
+                crossInputWeights[channel] = static_cast<float> (pow (g * f, length));
+                otherInputWeights[channel] = static_cast<float> (pow (f, 2.0 * length));
+                sumOfLengths += delayLengths[channel];
+            }
+
+            // the energy spreads evenly over all delay lines, each passing it on once per length
+            echoDensity = static_cast<double> (fdnSize) / juce::jmax (1, sumOfLengths);
+        }
+
+        // if the fade-in time is the longer one, the network has to be subtracted from it
+        fadeInSign = overallGain >= fadeInGain ? 1.0f : -1.0f;
+    }
+
     void updateFilterCoefficients()
     {
         if (spec.sampleRate > 0) {
             // update shelving filter parameters
             for (int channel = 0; channel < fdnSize; ++channel)
             {
-                lowShelfFilters[channel]->setCoefficients (
+                lowShelfFilters.setCoefficients (channel,
                     juce::IIRCoefficients::makeLowShelf (
                         spec.sampleRate,
                         juce::jmin (0.5 * spec.sampleRate, static_cast<double> (lowShelfParameters.frequency)),
@@ -467,7 +841,7 @@ private:
                             channel,
                             lowShelfParameters.linearGain)));
 
-                highShelfFilters[channel]->setCoefficients (
+                highShelfFilters.setCoefficients (channel,
                     juce::IIRCoefficients::makeHighShelf (
                         spec.sampleRate,
                         juce::jmin (0.5 * spec.sampleRate, static_cast<double> (highShelfParameters.frequency)),
@@ -475,33 +849,27 @@ private:
                         channelGainConversion (
                             channel,
                             highShelfParameters.linearGain)));
+
+                inputLowShelfFilters.copyCoefficients (channel, lowShelfFilters);
+                inputHighShelfFilters.copyCoefficients (channel, highShelfFilters);
             }
         }
     }
 
     void updateFdnSize(FdnSize newSize) {
-        if (fdnSize != newSize) {
-            const int diff = newSize - delayBufferVector.size();
-            if (fdnSize < newSize)
-            {
-                for (int i = 0; i < diff; i++)
-                {
-                    delayBufferVector.add (new juce::AudioBuffer<float>());
-                    highShelfFilters.add (new juce::IIRFilter());
-                    lowShelfFilters.add (new juce::IIRFilter());
-                }
-            }
-            else
-            {
-                //TODO: what happens if newSize == 0?;
-                delayBufferVector.removeLast(diff);
-                highShelfFilters.removeLast(diff);
-                lowShelfFilters.removeLast(diff);
-            }
+        jassert (newSize <= maxNetworkSize);
+
+        // delay lines and filters which are added start from silence
+        for (int channel = fdnSize; channel < newSize; ++channel)
+        {
+            delayLengths[channel] = 0;
+            delayPositions[channel] = 0;
+            highShelfFilters.reset (channel);
+            lowShelfFilters.reset (channel);
+            inputHighShelfFilters.reset (channel);
+            inputLowShelfFilters.reset (channel);
         }
-        delayPositionVector.resize(newSize);
-        feedbackGainVector.resize(newSize);
-        transferVector.resize(newSize);
+
         fdnSize = newSize;
     }
 };
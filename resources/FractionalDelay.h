@@ -0,0 +1,255 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "SIMDHelpers.h"
+
+/**
+ Delays a block of audio by a fractional and time-varying delay using 3rd-order Lagrange
+ interpolation, and writes the result into a temporary buffer which can then be added to a
+ delay line.
+
+ Input sample i with the delay d (in samples) is spread over the four output positions
+ i + floor (d) + k, k = 0..3, with the Lagrange weights of the fraction of d. So a delay
+ of zero puts the sample at the second tap (kernelOffset). The output positions are relative to
+ the first input sample, and process() returns their range: the first written sample of
+ the destination belongs to range.getStart().
+
+ For delays which change linearly and slowly over the block (less than maxReadSlope samples
+ per sample), the output is computed in a "read" formulation: every output sample is a
+ 4-tap FIR of consecutive input samples. This needs no scatter-add and no gather, is
+ vectorised over the output samples with juce::dsp::SIMDRegister (so SSE or NEON,
+ depending on the build), and the weights are shared by all channels. For a constant
+ delay both formulations are identical. Faster changing or arbitrary per-sample delays are
+ scattered sample by sample.
+ */
+class FractionalDelay
+{
+public:
+    static constexpr int numTaps = 4;
+    static constexpr int kernelOffset = 1; // a delay of zero puts the input sample on this tap
+    static constexpr double maxReadSlope = 1.0 / 32.0;
+
+   #if JUCE_USE_SIMD
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int simdSize = static_cast<int> (SIMDFloat::size());
+   #endif
+
+    FractionalDelay() = delete;
+
+    /** Returns the range of output positions a block with a linearly changing delay is written to. */
+    static juce::Range<int> getOutputRange (const int numSamples, const double startDelay, const double delayIncrement)
+    {
+        const int first = floorToInt (startDelay);
+        const int last = numSamples - 1 + floorToInt (startDelay + (numSamples - 1) * delayIncrement);
+        return { juce::jmin (first, last), juce::jmax (first, last) + numTaps };
+    }
+
+    /**
+     Writes the delayed block into dest, overwriting its first range.getLength() samples.
+     The delay of input sample i is startDelay + i * delayIncrement (in samples).
+     */
+    static juce::Range<int> process (const float* const* src, float* const* dest, const int numChannels,
+                                     const int numSamples, const double startDelay, const double delayIncrement) noexcept
+    {
+        const auto range = getOutputRange (numSamples, startDelay, delayIncrement);
+
+        if (std::abs (delayIncrement) <= maxReadSlope)
+            readInterpolated (src, dest, numChannels, numSamples, startDelay, delayIncrement, range);
+        else
+            scatterInterpolated (src, dest, numChannels, numSamples, range,
+                                 [&] (const int i) { return startDelay + i * delayIncrement; });
+
+        return range;
+    }
+
+    /**
+     Writes the delayed block into dest, overwriting its first range.getLength() samples.
+     The delay of input sample i is delays[i] (in samples).
+     */
+    static juce::Range<int> process (const float* const* src, float* const* dest, const int numChannels,
+                                     const int numSamples, const float* delays) noexcept
+    {
+        int first = std::numeric_limits<int>::max();
+        int last = std::numeric_limits<int>::min();
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const int pos = i + floorToInt (delays[i]);
+            first = juce::jmin (first, pos);
+            last = juce::jmax (last, pos);
+        }
+
+        const juce::Range<int> range (first, last + numTaps);
+        scatterInterpolated (src, dest, numChannels, numSamples, range,
+                             [delays] (const int i) { return static_cast<double> (delays[i]); });
+
+        return range;
+    }
+
+    /** Calculates the four Lagrange weights for a fractional delay between zero and one. */
+    template <typename Type>
+    static inline void getWeights (const Type fraction, Type (&weights)[numTaps]) noexcept
+    {
+        const Type tp1 = fraction + 1.0f;
+        const Type tm1 = fraction - 1.0f;
+        const Type tm2 = fraction - 2.0f;
+
+        weights[0] = fraction * tm1 * tm2 * (-1.0f / 6.0f);
+        weights[1] = tp1 * tm1 * tm2 * 0.5f;
+        weights[2] = tp1 * fraction * tm2 * -0.5f;
+        weights[3] = tp1 * fraction * tm1 * (1.0f / 6.0f);
+    }
+
+private:
+    static inline int floorToInt (const double value) noexcept
+    {
+        const int truncated = static_cast<int> (value);
+        return truncated - (value < truncated ? 1 : 0);
+    }
+
+    //==============================================================================
+    template <typename DelayFunction>
+    static void scatterInterpolated (const float* const* src, float* const* dest, const int numChannels,
+                                     const int numSamples, const juce::Range<int> range, DelayFunction getDelay) noexcept
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::clear (dest[ch], range.getLength());
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double delay = getDelay (i);
+            const int delayInt = floorToInt (delay);
+
+            float weights[numTaps];
+            getWeights (static_cast<float> (delay - delayInt), weights);
+
+            const int pos = i + delayInt - range.getStart();
+
+           #if JUCE_USE_SSE_INTRINSICS
+            const __m128 interp = _mm_loadu_ps (weights);
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                float* d = dest[ch] + pos;
+                _mm_storeu_ps (d, _mm_add_ps (_mm_loadu_ps (d), _mm_mul_ps (interp, _mm_set1_ps (src[ch][i]))));
+            }
+           #elif JUCE_USE_ARM_NEON
+            const float32x4_t interp = vld1q_f32 (weights);
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                float* d = dest[ch] + pos;
+                vst1q_f32 (d, vmlaq_n_f32 (vld1q_f32 (d), interp, src[ch][i]));
+            }
+           #else
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                float* d = dest[ch] + pos;
+                const float sample = src[ch][i];
+                d[0] += weights[0] * sample;
+                d[1] += weights[1] * sample;
+                d[2] += weights[2] * sample;
+                d[3] += weights[3] * sample;
+            }
+           #endif
+        }
+    }
+
+    //==============================================================================
+    /*
+     The write delay d(i) = d0 + s * i maps input sample i to the output position
+     i + d(i) + kernelOffset, so output position j reads the input with the delay
+     r(j) = d0 + s / (1 + s) * (j - kernelOffset - d0).
+     The scattered signal is compressed or stretched in time, which scales its amplitude by
+     1 / (1 + s); the read output is scaled accordingly, so both formulations match.
+     */
+    static void readInterpolated (const float* const* src, float* const* dest, const int numChannels, const int numSamples,
+                                  const double startDelay, const double delayIncrement, const juce::Range<int> range) noexcept
+    {
+        const double slope = delayIncrement / (1.0 + delayIncrement);
+        const float gain = static_cast<float> (1.0 / (1.0 + delayIncrement));
+        const int length = range.getLength();
+
+        int j = 0;
+
+       #if JUCE_USE_SIMD
+        for (; j + simdSize <= length; j += simdSize)
+        {
+            const int pos = range.getStart() + j;
+            const double firstDelay = startDelay + slope * (pos - kernelOffset - startDelay);
+            const int delayInt = floorToInt (firstDelay);
+            const int firstInput = pos - delayInt - (numTaps - 1);
+
+            if (delayInt != floorToInt (firstDelay + slope * (simdSize - 1))
+                || firstInput < 0 || firstInput + simdSize + numTaps - 1 > numSamples)
+            {
+                for (int k = 0; k < simdSize; ++k)
+                    readSample (src, dest, numChannels, numSamples, j + k, range.getStart() + j + k, startDelay, slope, gain);
+                continue;
+            }
+
+            const auto fraction = SIMDHelpers::loadUnaligned (SIMDHelpers::laneIndices) * static_cast<float> (slope) + SIMDFloat::expand (static_cast<float> (firstDelay - delayInt));
+
+            SIMDFloat weights[numTaps];
+            getWeights (fraction, weights);
+            for (auto& w : weights)
+                w = w * gain;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const float* x = src[ch] + firstInput;
+                const auto a = SIMDHelpers::loadUnaligned (x + 3);
+                const auto b = SIMDHelpers::loadUnaligned (x + 2);
+                const auto c = SIMDHelpers::loadUnaligned (x + 1);
+                const auto d = SIMDHelpers::loadUnaligned (x);
+                SIMDHelpers::storeUnaligned (dest[ch] + j, weights[0] * a + weights[1] * b + weights[2] * c + weights[3] * d);
+            }
+        }
+       #endif
+
+        for (; j < length; ++j)
+            readSample (src, dest, numChannels, numSamples, j, range.getStart() + j, startDelay, slope, gain);
+    }
+
+    static inline void readSample (const float* const* src, float* const* dest, const int numChannels, const int numSamples,
+                                   const int destIndex, const int pos, const double startDelay, const double slope, const float gain) noexcept
+    {
+        const double delay = startDelay + slope * (pos - kernelOffset - startDelay);
+        const int delayInt = floorToInt (delay);
+
+        float weights[numTaps];
+        getWeights (static_cast<float> (delay - delayInt), weights);
+
+        const int firstInput = pos - delayInt;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < numTaps; ++k)
+            {
+                const int i = firstInput - k;
+                if (i >= 0 && i < numSamples)
+                    sum += weights[k] * src[ch][i];
+            }
+            dest[ch][destIndex] = gain * sum;
+        }
+    }
+};
@@ -22,6 +22,7 @@
 
 #pragma once
 #include "ambisonicTools.h"
+#include "ReleasePool.h"
 
 
 /* Helper class to check the available input and output channels e.g. for auto settings of Ambisonic order
@@ -37,8 +38,9 @@ namespace IOTypes {
     public:
         Nothing() {}
         bool check (juce::AudioProcessor* p, int setting, bool isInput) { ignoreUnused (p, setting, isInput); return false; }
-        int getSize() { return 0; }
-        int getMaxSize() {return 0; }
+        bool check (int numberOfAvailableChannels, int setting) { ignoreUnused (numberOfAvailableChannels, setting); return false; }
+        int getSize() const { return 0; }
+        int getMaxSize() const {return 0; }
     };
 
     template <int maxNumberOfInputChannels = 64>
@@ -54,18 +56,23 @@ namespace IOTypes {
         ~AudioChannels() {}
 
         bool check (juce::AudioProcessor* p, int setting, bool isInput)
+        {
+            return check (isInput ? p->getTotalNumInputChannels() : p->getTotalNumOutputChannels(), setting);
+        }
+
+        bool check (int numberOfAvailableChannels, int setting)
         {
             int previous = nChannels;
-            int maxNumInputs = juce::jmin (isInput ? p->getTotalNumInputChannels() : p->getTotalNumOutputChannels(), maxNumberOfInputChannels);
+            int maxNumInputs = juce::jmin (numberOfAvailableChannels, maxNumberOfInputChannels);
             if (setting == 0 || setting > maxNumberOfInputChannels) nChannels = maxNumInputs; // Auto setting or requested order exceeds highest possible order
             else nChannels = setting;
             maxSize = maxNumInputs;
             return previous != nChannels;
         }
 
-        int getMaxSize() { return maxSize; }
-        int getSize() { return nChannels; }
-        int getPreviousSize() { return _nChannels; }
+        int getMaxSize() const { return maxSize; }
+        int getSize() const { return nChannels; }
+        int getPreviousSize() const { return _nChannels; }
 
     private:
         int nChannels;
@@ -88,11 +95,16 @@ namespace IOTypes {
         ~Ambisonics() {}
 
         bool check (juce::AudioProcessor* p, int setting, bool isInput)
+        {
+            return check (isInput ? p->getTotalNumInputChannels() : p->getTotalNumOutputChannels(), setting);
+        }
+
+        bool check (int numberOfAvailableChannels, int setting)
         {
             int previousOrder = order;
             --setting;
 
-            int maxPossibleOrder = juce::jmin (isqrt(isInput ? p->getTotalNumInputChannels() : p->getTotalNumOutputChannels())-1, highestOrder);
+            int maxPossibleOrder = juce::jmin (isqrt(numberOfAvailableChannels)-1, highestOrder);
             if (setting == -1 || setting > maxPossibleOrder) order = maxPossibleOrder; // Auto setting or requested order exceeds highest possible order
             else order = setting;
             nChannels = juce::square (order+1);
@@ -100,16 +112,16 @@ namespace IOTypes {
             return previousOrder != order;
         }
 
-        int getSize() { return getOrder(); }
-        int getPreviousSize() { return getPreviousOrder(); }
+        int getSize() const { return getOrder(); }
+        int getPreviousSize() const { return getPreviousOrder(); }
 
-        int getOrder() { return order; }
-        int getPreviousOrder () { return _order; }
+        int getOrder() const { return order; }
+        int getPreviousOrder () const { return _order; }
 
-        int getNumberOfChannels() { return nChannels; }
-        int getPreviousNumberOfChannels() { return _nChannels; }
+        int getNumberOfChannels() const { return nChannels; }
+        int getPreviousNumberOfChannels() const { return _nChannels; }
 
-        int getMaxSize() { return maxSize; }
+        int getMaxSize() const { return maxSize; }
 
     private:
         int order, _order;
@@ -118,12 +130,33 @@ namespace IOTypes {
     };
 }
 
+/**
+ Base class for everything a processor prepares for a new I/O configuration in the background,
+ see IOHelper::startBackgroundReconfiguration(). Derive from it and add the buffers, delay lines,
+ convolution engines etc. which depend on the I/O sizes.
+ */
+class IOConfiguration
+{
+public:
+    IOConfiguration() {}
+    virtual ~IOConfiguration() {}
+};
+
+
 template <class Input, class Output, bool combined = false>
 class IOHelper
 {
 public:
     IOHelper() {}
-    virtual ~IOHelper() {}
+    virtual ~IOHelper()
+    {
+        // call stopBackgroundReconfiguration() in your processor's destructor, the thread calls its methods!
+        jassert (reconfigurationThread == nullptr || ! reconfigurationThread->isThreadRunning());
+        stopBackgroundReconfiguration();
+
+        if (auto* notConsumed = pendingConfiguration.exchange (nullptr))
+            notConsumed->decReferenceCountWithoutDeleting();
+    }
 
 
     Input input;
@@ -142,9 +175,27 @@ public:
      This function should be called in every call of prepareToPlay()
      and at the beginning of the processBlock() with a check if
      the user has changed the input/output settings.
+
+     With background reconfiguration, calls with force == false (processBlock) only request
+     the new configuration and swap it in as soon as it's ready, while input and output keep
+     their old sizes until then. Calls with force == true (prepareToPlay) prepare and apply the
+     new configuration right away.
      */
     void checkInputAndOutput (juce::AudioProcessor* p, int inputSetting, int outputSetting, bool force = false)
     {
+        if (reconfigurationThread != nullptr)
+        {
+            if (force)
+                reconfigureNow (p, inputSetting, outputSetting);
+            else
+                checkInBackground (p, inputSetting, outputSetting);
+
+            return;
+        }
+
+        if (reconfigurationRequested.exchange (false))
+            force = true;
+
         if (force || userChangedIOSettings)
         {
             inputSizeHasChanged = false;
@@ -163,6 +214,16 @@ public:
         }
     }
 
+    /**
+     Requests a reconfiguration with the current I/O sizes, e.g. after other settings
+     the buffers depend on have changed. It will be done with the next call of
+     checkInputAndOutput(). Can be called from any thread.
+     */
+    void requestReconfiguration()
+    {
+        reconfigurationRequested = true;
+    }
+
     std::pair<int, int> getMaxSize()
     {
         int maxInputSize = input.getMaxSize();
@@ -178,6 +239,51 @@ public:
 
     bool userChangedIOSettings = true;
 
+protected:
+    /**
+     Lets a background thread prepare the buffers and states of new I/O configurations, instead
+     of calling updateBuffers() on the audio thread. Override prepareConfiguration() and
+     applyConfiguration() instead of updateBuffers(). Call this in your processor's constructor,
+     and stopBackgroundReconfiguration() in its destructor.
+     */
+    void startBackgroundReconfiguration()
+    {
+        if (reconfigurationThread == nullptr)
+            reconfigurationThread = std::make_unique<ReconfigurationThread> (*this);
+
+        reconfigurationThread->start();
+    }
+
+    /** Stops the background thread, call this in your processor's destructor. */
+    void stopBackgroundReconfiguration()
+    {
+        if (reconfigurationThread != nullptr)
+            reconfigurationThread->stop();
+    }
+
+    /**
+     Called with the new input and output sizes on the background thread (or in prepareToPlay()
+     when checkInputAndOutput() is forced), while the audio thread keeps processing the old
+     configuration. Allocate and initialise everything depending on the sizes here, but don't
+     touch anything the audio thread uses. May return nullptr if there's nothing to prepare.
+     */
+    virtual std::unique_ptr<IOConfiguration> prepareConfiguration (const Input& newInput, const Output& newOutput)
+    {
+        juce::ignoreUnused (newInput, newOutput);
+        return nullptr;
+    }
+
+    /**
+     Called on the audio thread at the beginning of a block (or in prepareToPlay()) with the
+     configuration returned by prepareConfiguration(), input and output already hold the new
+     sizes. Take it over without allocating or deallocating, e.g. by swapping buffers or
+     pointers with it. Whatever remains in it is released later on the message thread.
+     */
+    virtual void applyConfiguration (IOConfiguration& newConfiguration)
+    {
+        juce::ignoreUnused (newConfiguration);
+    }
+
 private:
 
     /** Update buffers
@@ -195,4 +301,179 @@ private:
         DBG("IOHelper:  input size: " << input.getSize());
         DBG("IOHelper: output size: " << output.getSize());
     }
+
+    //==============================================================================
+    // a prepared configuration together with the sizes it has been prepared for
+    struct PreparedConfiguration : public juce::ReferenceCountedObject
+    {
+        using Ptr = juce::ReferenceCountedObjectPtr<PreparedConfiguration>;
+
+        Input input;
+        Output output;
+        std::unique_ptr<IOConfiguration> configuration;
+        int version = 0;
+    };
+
+    /**
+     Sleeps until there's a request. The audio thread only posts requests without signalling (and
+     locking) anything, the timer checks for them on the message thread and wakes the thread up.
+     */
+    class ReconfigurationThread : public juce::Thread, private juce::Timer
+    {
+    public:
+        ReconfigurationThread (IOHelper& helperToUse) : juce::Thread ("IOHelper reconfiguration"), helper (helperToUse) {}
+
+        void start()
+        {
+            startThread();
+            startTimer (20);
+        }
+
+        void stop()
+        {
+            stopTimer();
+            stopThread (5000);
+        }
+
+        void run() override
+        {
+            while (! threadShouldExit())
+                if (! helper.prepareRequestedConfiguration())
+                    wait (-1);
+        }
+
+    private:
+        void timerCallback() override
+        {
+            if (helper.isConfigurationRequested())
+                notify();
+        }
+
+        IOHelper& helper;
+    };
+
+    // audio thread: swaps in a prepared configuration and requests a new one if the sizes have changed
+    void checkInBackground (juce::AudioProcessor* p, const int inputSetting, const int outputSetting)
+    {
+        inputSizeHasChanged = false;
+        outputSizeHasChanged = false;
+
+        if (auto* prepared = pendingConfiguration.exchange (nullptr, std::memory_order_acq_rel))
+        {
+            // outdated configurations are dropped, the release pool deletes them
+            if (prepared->version == latestVersion)
+                apply (*prepared);
+
+            prepared->decReferenceCountWithoutDeleting();
+        }
+
+        if (userChangedIOSettings || reconfigurationRequested.load())
+        {
+            userChangedIOSettings = false;
+
+            // the requested sizes are compared to the latest request, not to the ones in use
+            const bool inputChanged = requestedInput.check (p, inputSetting, true);
+            const bool outputChanged = requestedOutput.check (p, outputSetting, false);
+
+            if (reconfigurationRequested.exchange (false) || inputChanged || outputChanged)
+                postRequest (p, inputSetting, outputSetting);
+        }
+    }
+
+    void postRequest (juce::AudioProcessor* p, const int inputSetting, const int outputSetting)
+    {
+        requestedSettings[0] = p->getTotalNumInputChannels();
+        requestedSettings[1] = inputSetting;
+        requestedSettings[2] = p->getTotalNumOutputChannels();
+        requestedSettings[3] = outputSetting;
+        requestedVersion.store (++latestVersion, std::memory_order_release);
+    }
+
+    // prepareToPlay: prepares and applies the configuration on the calling thread
+    void reconfigureNow (juce::AudioProcessor* p, const int inputSetting, const int outputSetting)
+    {
+        DBG("IOHelper: processors I/O channel counts: " << p->getTotalNumInputChannels() << "/" << p->getTotalNumOutputChannels());
+
+        userChangedIOSettings = false;
+        reconfigurationRequested = false;
+        requestedInput.check (p, inputSetting, true);
+        requestedOutput.check (p, outputSetting, false);
+
+        // invalidates the configurations currently prepared in the background
+        postRequest (p, inputSetting, outputSetting);
+        preparedVersion = latestVersion;
+
+        typename PreparedConfiguration::Ptr prepared = prepare (p->getTotalNumInputChannels(), inputSetting,
+                                                                p->getTotalNumOutputChannels(), outputSetting, latestVersion);
+        apply (*prepared);
+    }
+
+    bool isConfigurationRequested() const
+    {
+        return requestedVersion.load (std::memory_order_acquire) != preparedVersion.load();
+    }
+
+    // background thread: returns false if there was nothing to do
+    bool prepareRequestedConfiguration()
+    {
+        const int version = requestedVersion.load (std::memory_order_acquire);
+        if (version == preparedVersion.load())
+            return false;
+
+        typename PreparedConfiguration::Ptr prepared = prepare (requestedSettings[0].load(), requestedSettings[1].load(),
+                                                                requestedSettings[2].load(), requestedSettings[3].load(), version);
+        preparedVersion = version;
+
+        prepared->incReferenceCount();
+        if (auto* notConsumed = pendingConfiguration.exchange (prepared.get(), std::memory_order_acq_rel))
+            notConsumed->decReferenceCountWithoutDeleting();
+
+        return true;
+    }
+
+    typename PreparedConfiguration::Ptr prepare (const int numInputs, const int inputSetting,
+                                                 const int numOutputs, const int outputSetting, const int version)
+    {
+        typename PreparedConfiguration::Ptr prepared = new PreparedConfiguration();
+        prepared->input.check (numInputs, inputSetting);
+        prepared->output.check (numOutputs, outputSetting);
+        prepared->configuration = prepareConfiguration (prepared->input, prepared->output);
+        prepared->version = version;
+
+        releasePool->add (prepared.get());
+        return prepared;
+    }
+
+    void apply (PreparedConfiguration& prepared)
+    {
+        inputSizeHasChanged = prepared.input.getSize() != input.getSize();
+        outputSizeHasChanged = prepared.output.getSize() != output.getSize();
+
+        input = prepared.input;
+        output = prepared.output;
+
+        DBG("IOHelper:  input size: " << input.getSize());
+        DBG("IOHelper: output size: " << output.getSize());
+
+        if (prepared.configuration != nullptr)
+            applyConfiguration (*prepared.configuration);
+    }
+
+    std::unique_ptr<ReconfigurationThread> reconfigurationThread;
+    std::atomic<bool> reconfigurationRequested {false};
+
+    // owned by the audio thread (and prepareToPlay)
+    Input requestedInput;
+    Output requestedOutput;
+    int latestVersion = 0;
+
+    // request: available input channels, input setting, available output channels, output setting
+    std::atomic<int> requestedSettings[4] {{0}, {0}, {0}, {0}};
+    std::atomic<int> requestedVersion {0};
+    std::atomic<int> preparedVersion {0};
+
+    // hand-over to the audio thread, holds one reference of the configuration
+    std::atomic<PreparedConfiguration*> pendingConfiguration {nullptr};
+
+    juce::SharedResourcePointer<ReleasePool<PreparedConfiguration>> releasePool;
 };
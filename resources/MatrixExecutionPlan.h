@@ -0,0 +1,311 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+
+#pragma once
+#include "ReferenceCountedMatrix.h"
+#include "MatrixMultiplicationKernel.h"
+
+/**
+ Analyses the structure of a ReferenceCountedMatrix once and picks a specialised way of
+ executing the matrix multiplication:
+    - singleTap:      each row holds at most one non-zero coefficient (routings, permutations,
+                      diagonal gains), processed with copies or scaled copies
+    - blockDiagonal:  consecutive rows share the same span of non-zero columns (e.g. per-order
+                      rotations), each block is processed with the dense kernel on its sub-matrix
+    - sparse:         compressed sparse rows, one addWithMultiply per non-zero coefficient
+    - dense:          the dense MatrixMultiplicationKernel on the whole matrix
+
+ A plan without a matrix outputs silence. Constructing a plan allocates and iterates over the
+ whole matrix, so do it off the audio thread. The coefficients and the routing of the matrix
+ must not change after the plan has been created.
+ */
+class MatrixExecutionPlan : public juce::ReferenceCountedObject
+{
+public:
+    typedef juce::ReferenceCountedObjectPtr<MatrixExecutionPlan> Ptr;
+
+    enum class Type
+    {
+        singleTap,
+        blockDiagonal,
+        sparse,
+        dense
+    };
+
+    MatrixExecutionPlan (ReferenceCountedMatrix::Ptr matrixToUse) : matrix (matrixToUse)
+    {
+        if (matrix != nullptr)
+        {
+            analyse();
+            DBG ("MatrixExecutionPlan: '" << matrix->getName() << "' will be processed as " << getTypeString()
+                 << " (" << nonZeros << " of " << nRows * nCols << " coefficients non-zero).");
+        }
+    }
+
+    ~MatrixExecutionPlan() {}
+
+    ReferenceCountedMatrix::Ptr getMatrix() const { return matrix; }
+
+    Type getType() const { return type; }
+
+    const juce::String getTypeString() const
+    {
+        switch (type)
+        {
+            case Type::singleTap: return "singleTap";
+            case Type::blockDiagonal: return "blockDiagonal";
+            case Type::sparse: return "sparse";
+            default: return "dense";
+        }
+    }
+
+    /**
+     Multiplies the input with the matrix and writes the result to the output channels given by
+     the routing array of the matrix. Output channels which aren't part of the routing are cleared.
+     The output block must not overlap with the input block.
+     */
+    void process (const juce::dsp::AudioBlock<float> inputBlock, juce::dsp::AudioBlock<float> outputBlock) noexcept
+    {
+        if (matrix == nullptr)
+        {
+            outputBlock.clear();
+            return;
+        }
+
+        const int nInputs = juce::jmin (static_cast<int> (inputBlock.getNumChannels()), nCols);
+        const int nOutputs = static_cast<int> (outputBlock.getNumChannels());
+        const int nSamples = static_cast<int> (inputBlock.getNumSamples());
+
+        inputPointers.clearQuick();
+        for (int i = 0; i < nInputs; ++i)
+            inputPointers.add (inputBlock.getChannelPointer (i));
+
+        destPointers.clearQuick();
+        for (int row = 0; row < nRows; ++row)
+        {
+            const int destCh = routing.getUnchecked (row);
+            destPointers.add (destCh < nOutputs ? outputBlock.getChannelPointer (destCh) : nullptr);
+        }
+
+        const float* const* input = inputPointers.getRawDataPointer();
+        float* const* dest = destPointers.getRawDataPointer();
+
+        switch (type)
+        {
+            case Type::singleTap: processSingleTap (input, nInputs, dest, nSamples); break;
+            case Type::blockDiagonal: processBlockDiagonal (input, nInputs, dest, nSamples); break;
+            case Type::sparse: processSparse (input, nInputs, dest, nSamples); break;
+            default: processBlock (Block {0, nRows, 0, nCols}, input, nInputs, dest, nSamples); break;
+        }
+
+        // clear all output channels which are not part of the routing
+        int idx = 0;
+        for (int ch = 0; ch < nOutputs; ++ch)
+        {
+            while (idx < sortedRouting.size() && sortedRouting.getUnchecked (idx) < ch)
+                ++idx;
+
+            if (idx == sortedRouting.size() || sortedRouting.getUnchecked (idx) != ch)
+                juce::FloatVectorOperations::clear (outputBlock.getChannelPointer (ch), nSamples);
+        }
+    }
+
+private:
+    struct Block
+    {
+        int firstRow, numRows, firstColumn, numColumns;
+    };
+
+    void analyse()
+    {
+        auto& T = matrix->getMatrix();
+        nRows = static_cast<int> (T.getNumRows());
+        nCols = static_cast<int> (T.getNumColumns());
+
+        rowStart.ensureStorageAllocated (nRows + 1);
+        rowStart.add (0);
+
+        juce::Array<int> firstNonZero, lastNonZero;
+        int maxNonZerosPerRow = 0;
+
+        for (int row = 0; row < nRows; ++row)
+        {
+            int first = -1, last = -1;
+            for (int col = 0; col < nCols; ++col)
+            {
+                const float value = T (row, col);
+                if (value != 0.0f)
+                {
+                    if (first == -1)
+                        first = col;
+                    last = col;
+                    columns.add (col);
+                    values.add (value);
+                }
+            }
+            rowStart.add (columns.size());
+            firstNonZero.add (first);
+            lastNonZero.add (last);
+            maxNonZerosPerRow = juce::jmax (maxNonZerosPerRow, rowStart[row + 1] - rowStart[row]);
+        }
+
+        nonZeros = columns.size();
+
+        // group consecutive rows with the same span of non-zero columns, zero rows get their own blocks
+        int blockCost = 0;
+        for (int row = 0; row < nRows; ++row)
+        {
+            const int first = firstNonZero[row];
+            const int numColumns = first == -1 ? 0 : lastNonZero[row] - first + 1;
+
+            if (blocks.size() > 0 && blocks.getReference (blocks.size() - 1).firstColumn == first
+                && blocks.getReference (blocks.size() - 1).numColumns == numColumns)
+                ++blocks.getReference (blocks.size() - 1).numRows;
+            else
+                blocks.add (Block {row, 1, first, numColumns});
+
+            blockCost += numColumns;
+        }
+
+        // the dense kernel does considerably more multiply-adds per second than single addWithMultiply calls
+        constexpr int sparsePenalty = 3;
+        const int denseCost = nRows * nCols;
+
+        if (maxNonZerosPerRow <= 1)
+            type = Type::singleTap;
+        else if (nonZeros * sparsePenalty < juce::jmin (blockCost, denseCost))
+            type = Type::sparse;
+        else if (blockCost * 4 < denseCost * 3)
+            type = Type::blockDiagonal;
+        else
+            type = Type::dense;
+
+        routing = matrix->getRoutingArrayReference();
+        sortedRouting = routing;
+        sortedRouting.sort();
+
+        inputPointers.ensureStorageAllocated (nCols);
+        destPointers.ensureStorageAllocated (nRows);
+        rowPointers.ensureStorageAllocated (nRows);
+        blockDestPointers.ensureStorageAllocated (nRows);
+    }
+
+    void processSingleTap (const float* const* input, const int nInputs, float* const* dest, const int nSamples) noexcept
+    {
+        for (int row = 0; row < nRows; ++row)
+        {
+            float* destPtr = dest[row];
+            if (destPtr == nullptr)
+                continue;
+
+            const int idx = rowStart.getUnchecked (row);
+            if (idx == rowStart.getUnchecked (row + 1) || columns.getUnchecked (idx) >= nInputs)
+            {
+                juce::FloatVectorOperations::clear (destPtr, nSamples);
+                continue;
+            }
+
+            const float gain = values.getUnchecked (idx);
+            if (gain == 1.0f)
+                juce::FloatVectorOperations::copy (destPtr, input[columns.getUnchecked (idx)], nSamples);
+            else
+                juce::FloatVectorOperations::copyWithMultiply (destPtr, input[columns.getUnchecked (idx)], gain, nSamples);
+        }
+    }
+
+    void processSparse (const float* const* input, const int nInputs, float* const* dest, const int nSamples) noexcept
+    {
+        for (int row = 0; row < nRows; ++row)
+        {
+            float* destPtr = dest[row];
+            if (destPtr == nullptr)
+                continue;
+
+            bool first = true;
+            for (int idx = rowStart.getUnchecked (row); idx < rowStart.getUnchecked (row + 1); ++idx)
+            {
+                const int col = columns.getUnchecked (idx);
+                if (col >= nInputs)
+                    break;
+
+                if (first)
+                    juce::FloatVectorOperations::copyWithMultiply (destPtr, input[col], values.getUnchecked (idx), nSamples);
+                else
+                    juce::FloatVectorOperations::addWithMultiply (destPtr, input[col], values.getUnchecked (idx), nSamples);
+                first = false;
+            }
+
+            if (first)
+                juce::FloatVectorOperations::clear (destPtr, nSamples);
+        }
+    }
+
+    void processBlockDiagonal (const float* const* input, const int nInputs, float* const* dest, const int nSamples) noexcept
+    {
+        for (const auto& block : blocks)
+            processBlock (block, input, nInputs, dest, nSamples);
+    }
+
+    void processBlock (const Block& block, const float* const* input, const int nInputs, float* const* dest, const int nSamples) noexcept
+    {
+        const int numColumns = juce::jmin (block.firstColumn + block.numColumns, nInputs) - block.firstColumn;
+        const float* data = matrix->getMatrix().getRawDataPointer();
+
+        rowPointers.clearQuick();
+        blockDestPointers.clearQuick();
+        for (int row = block.firstRow; row < block.firstRow + block.numRows; ++row)
+            if (dest[row] != nullptr)
+            {
+                rowPointers.add (data + row * nCols + block.firstColumn);
+                blockDestPointers.add (dest[row]);
+            }
+
+        MatrixMultiplicationKernel::process (numColumns > 0 ? input + block.firstColumn : input, juce::jmax (0, numColumns),
+                                             rowPointers.getRawDataPointer(), blockDestPointers.getRawDataPointer(),
+                                             rowPointers.size(), nSamples);
+    }
+
+    //==============================================================================
+    ReferenceCountedMatrix::Ptr matrix;
+    Type type {Type::dense};
+
+    int nRows {0}, nCols {0}, nonZeros {0};
+
+    // compressed sparse rows
+    juce::Array<int> rowStart;
+    juce::Array<int> columns;
+    juce::Array<float> values;
+
+    juce::Array<Block> blocks;
+
+    juce::Array<int> routing;
+    juce::Array<int> sortedRouting;
+
+    // pre-allocated pointer arrays, only used by the audio thread
+    juce::Array<const float*> inputPointers;
+    juce::Array<float*> destPointers;
+    juce::Array<const float*> rowPointers;
+    juce::Array<float*> blockDestPointers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MatrixExecutionPlan)
+};
@@ -25,20 +25,42 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "ReferenceCountedMatrix.h"
 #include "ReferenceCountedDecoder.h"
+#include "MatrixExecutionPlan.h"
+#include "ReleasePool.h"
 
 
+/**
+ Multiplies multichannel audio with a ReferenceCountedMatrix. New matrices are handed over to
+ the audio thread lock-free, and the previous matrix is cross-faded with the new one, so
+ switching matrices doesn't click. The audio thread neither allocates nor deletes any
+ matrices, old ones are released on the message thread by a ReleasePool.
+ */
 class MatrixMultiplication
 {
 public:
     MatrixMultiplication() {}
 
+    ~MatrixMultiplication()
+    {
+        if (auto* plan = pendingPlan.exchange (nullptr))
+            plan->decReferenceCountWithoutDeleting();
+    }
+
+    /**
+     Prepares the internal buffers for the maximum block size and spec.numChannels channels.
+     Matrices with more input channels than that will only use the first spec.numChannels
+     inputs with processReplacing, and only spec.numChannels outputs will be cross-faded.
+     */
     void prepare (const juce::dsp::ProcessSpec& newSpec, bool prepareInputBuffering = true)
     {
         spec = newSpec;
 
+        const int nChannels = static_cast<int> (spec.numChannels);
+        const int blockSize = static_cast<int> (spec.maximumBlockSize);
+
         if (prepareInputBuffering)
         {
-            buffer.setSize (buffer.getNumChannels(), spec.maximumBlockSize);
+            buffer.setSize (nChannels, blockSize);
             bufferPrepared = true;
         }
         else
@@ -47,9 +69,22 @@ public:
             bufferPrepared = false;
         }
 
+        fadeBuffer.setSize (nChannels, blockSize);
+        setCrossfadeTime (crossfadeTime);
+
         checkIfNewMatrixAvailable();
+        previousPlan = nullptr;
+    }
+
+    /** Sets the duration of the cross-fade between the previous and a new matrix. Zero switches instantly. */
+    void setCrossfadeTime (const double newCrossfadeTimeInSeconds)
+    {
+        crossfadeTime = juce::jmax (0.0, newCrossfadeTimeInSeconds);
+        fadeLengthInSamples = spec.sampleRate > 0 ? juce::roundToInt (crossfadeTime * spec.sampleRate) : 0;
     }
 
+    double getCrossfadeTime() const { return crossfadeTime; }
+
     void processReplacing (juce::dsp::AudioBlock<float> data)
     {
         checkIfNewMatrixAvailable();
@@ -57,16 +92,13 @@ public:
         // you have to call the prepare method with prepareInputBuffering set to true in order tu use the processReplacing method
         jassert (bufferPrepared);
 
-        ReferenceCountedMatrix::Ptr retainedCurrentMatrix (currentMatrix);
-        if (retainedCurrentMatrix == nullptr || ! bufferPrepared)
+        if (! bufferPrepared || (currentMatrix == nullptr && previousPlan == nullptr))
         {
             data.clear();
             return;
         }
 
-        auto& T = retainedCurrentMatrix->getMatrix();
-
-        const int nInputChannels = juce::jmin (static_cast<int> (data.getNumChannels()), static_cast<int> (T.getNumColumns()));
+        const int nInputChannels = juce::jmin (static_cast<int> (data.getNumChannels()), buffer.getNumChannels());
         const int nSamples = static_cast<int> (data.getNumSamples());
 
         // copy input data to buffer
@@ -78,6 +110,16 @@ public:
     }
 
     void processNonReplacing (const juce::dsp::AudioBlock<float> inputBlock, juce::dsp::AudioBlock<float> outputBlock, const bool checkNewMatrix = true)
+    {
+        processNonReplacing (inputBlock, inputBlock, outputBlock, checkNewMatrix);
+    }
+
+    /**
+     Same as above, however, while cross-fading the previous matrix is fed with previousInputBlock.
+     Neither of the input blocks may overlap with the output block.
+     */
+    void processNonReplacing (const juce::dsp::AudioBlock<float> inputBlock, const juce::dsp::AudioBlock<float> previousInputBlock,
+                              juce::dsp::AudioBlock<float> outputBlock, const bool checkNewMatrix = true)
     {
         // you should call the processReplacing instead, it will buffer the input data
         // this is a weak check, as e.g. if number channels differ, it won't trigger
@@ -88,74 +130,60 @@ public:
         if (checkNewMatrix)
             checkIfNewMatrixAvailable();
 
-        ReferenceCountedMatrix::Ptr retainedCurrentMatrix (currentMatrix);
-        if (retainedCurrentMatrix == nullptr)
-        {
+        if (currentPlan == nullptr)
             outputBlock.clear();
-            return;
-        }
+        else
+            currentPlan->process (inputBlock, outputBlock);
 
-        auto& T = retainedCurrentMatrix->getMatrix();
+        if (previousPlan != nullptr)
+            crossfadeWithPreviousMatrix (previousInputBlock, outputBlock);
+    }
 
-        const int nInputChannels = juce::jmin (static_cast<int> (inputBlock.getNumChannels()), static_cast<int> (T.getNumColumns()));
-        const int nSamples = static_cast<int> (inputBlock.getNumSamples());
+    /**
+     Takes over a new matrix if one is available. Call this from the audio thread only.
+     */
+    const bool checkIfNewMatrixAvailable()
+    {
+        auto* newPlan = pendingPlan.exchange (nullptr, std::memory_order_acq_rel);
+        if (newPlan == nullptr)
+            return false;
 
-        for (int row = 0; row < T.getNumRows(); ++row)
+        if (currentPlan != nullptr && fadeLengthInSamples > 0)
         {
-            const int destCh = retainedCurrentMatrix->getRoutingArrayReference().getUnchecked(row);
-            if (destCh < outputBlock.getNumChannels())
-            {
-                float* dest = outputBlock.getChannelPointer (destCh);
-                juce::FloatVectorOperations::multiply (dest, inputBlock.getChannelPointer (0), T(row, 0), nSamples); // first channel
-                for (int i = 1; i < nInputChannels; ++i) // remaining channels
-                    juce::FloatVectorOperations::addWithMultiply (dest, inputBlock.getChannelPointer (i), T(row, i), nSamples);
-            }
+            previousPlan = currentPlan;
+            fadePosition = 0;
         }
+        else
+            previousPlan = nullptr;
 
-        juce::Array<int> routingCopy (retainedCurrentMatrix->getRoutingArrayReference());
-        routingCopy.sort();
-        int lastDest = -1;
-        const int nElements = routingCopy.size();
-        for (int i = 0; i < nElements; ++i)
-        {
-            const int destCh = routingCopy[i];
-            for (; ++lastDest < destCh;)
-                if (lastDest < outputBlock.getNumChannels())
-                    juce::FloatVectorOperations::clear(outputBlock.getChannelPointer(lastDest), (int) outputBlock.getNumSamples());
-            lastDest = destCh;
-        }
+        currentMatrix = newPlan->getMatrix();
+        currentPlan = newPlan;
 
-        for (int ch = routingCopy.getLast() + 1; ch < outputBlock.getNumChannels(); ++ch)
-            juce::FloatVectorOperations::clear(outputBlock.getChannelPointer(ch), (int) outputBlock.getNumSamples());
+        // release the reference of the hand-over, the release pool holds one as well
+        newPlan->decReferenceCountWithoutDeleting();
+
+        DBG ("MatrixTransformer: New matrix with name '" << (currentMatrix != nullptr ? currentMatrix->getName() : juce::String ("none")) << "' set.");
+        return true;
     }
 
-    const bool checkIfNewMatrixAvailable()
+    /** Sets a new matrix. This will analyse the matrix and create its execution plan, so don't call this method from the audio thread. */
+    void setMatrix (ReferenceCountedMatrix::Ptr newMatrixToUse)
     {
-        if (newMatrixAvailable)
-        {
-            newMatrixAvailable = false;
-            currentMatrix = newMatrix;
-            newMatrix = nullptr;
+        setExecutionPlan (new MatrixExecutionPlan (newMatrixToUse));
+    }
 
-            if (currentMatrix != nullptr)
-            {
-                DBG ("MatrixTransformer: New matrix with name '" << currentMatrix->getName() << "' set.");
-                const int cols = (int) currentMatrix->getMatrix().getNumColumns();
-                buffer.setSize (cols, buffer.getNumSamples());
-                DBG ("MatrixTransformer: buffer resized to " << buffer.getNumChannels() << "x" << buffer.getNumSamples());
-            }
+    /** Hands over a new execution plan to the audio thread. Don't call this method from the audio thread. */
+    void setExecutionPlan (MatrixExecutionPlan::Ptr newPlanToUse)
+    {
+        if (newPlanToUse == nullptr)
+            newPlanToUse = new MatrixExecutionPlan (nullptr);
 
-            return true;
-        }
-        return false;
-    };
+        matrixReleasePool->add (newPlanToUse->getMatrix().get());
+        planReleasePool->add (newPlanToUse.get());
 
-    void setMatrix (ReferenceCountedMatrix::Ptr newMatrixToUse, bool force = false)
-    {
-        newMatrix = newMatrixToUse;
-        newMatrixAvailable = true;
-        if (force)
-            checkIfNewMatrixAvailable();
+        newPlanToUse->incReferenceCount();
+        if (auto* notConsumedPlan = pendingPlan.exchange (newPlanToUse.get(), std::memory_order_acq_rel))
+            notConsumedPlan->decReferenceCountWithoutDeleting();
     }
 
     ReferenceCountedMatrix::Ptr getMatrix()
@@ -163,15 +191,74 @@ public:
         return currentMatrix;
     }
 
+    /** Returns the matrix which is currently faded out, or nullptr if there's no cross-fade. */
+    ReferenceCountedMatrix::Ptr getPreviousMatrix()
+    {
+        return previousPlan != nullptr ? previousPlan->getMatrix() : nullptr;
+    }
+
+    const bool isCrossfading() const { return previousPlan != nullptr; }
+
+    /** Checks if a new matrix is waiting to be used. */
+    const bool isNewMatrixWaiting() const { return pendingPlan.load() != nullptr; }
+
 private:
+    void crossfadeWithPreviousMatrix (const juce::dsp::AudioBlock<float> previousInputBlock, juce::dsp::AudioBlock<float> outputBlock)
+    {
+        const int nSamples = static_cast<int> (outputBlock.getNumSamples());
+        const int nChannels = juce::jmin (static_cast<int> (outputBlock.getNumChannels()), fadeBuffer.getNumChannels());
+        const int fadeLength = fadeLengthInSamples;
+
+        if (nSamples > fadeBuffer.getNumSamples() || fadePosition >= fadeLength)
+        {
+            previousPlan = nullptr;
+            return;
+        }
+
+        juce::dsp::AudioBlock<float> fadeBlock (fadeBuffer.getArrayOfWritePointers(), nChannels, 0, nSamples);
+        previousPlan->process (previousInputBlock, fadeBlock);
+
+        const int nFade = juce::jmin (nSamples, fadeLength - fadePosition);
+        const float increment = 1.0f / fadeLength;
+        const float startGain = (fadePosition + 1) * increment;
+
+        for (int ch = 0; ch < nChannels; ++ch)
+        {
+            float* dest = outputBlock.getChannelPointer (ch);
+            const float* previous = fadeBlock.getChannelPointer (ch);
+
+            float gain = startGain;
+            for (int i = 0; i < nFade; ++i)
+            {
+                dest[i] = previous[i] + gain * (dest[i] - previous[i]);
+                gain += increment;
+            }
+        }
+
+        fadePosition += nFade;
+        if (fadePosition >= fadeLength)
+            previousPlan = nullptr;
+    }
+
     //==============================================================================
     juce::dsp::ProcessSpec spec = {-1, 0, 0};
+
+    // only accessed by the audio thread
     ReferenceCountedMatrix::Ptr currentMatrix {nullptr};
-    ReferenceCountedMatrix::Ptr newMatrix {nullptr};
+    MatrixExecutionPlan::Ptr currentPlan {nullptr};
+    MatrixExecutionPlan::Ptr previousPlan {nullptr};
+    int fadePosition {0};
+
+    // hand-over from the message thread, holds one reference of the plan
+    std::atomic<MatrixExecutionPlan*> pendingPlan {nullptr};
+
+    juce::SharedResourcePointer<ReleasePool<MatrixExecutionPlan>> planReleasePool;
+    juce::SharedResourcePointer<ReleasePool<ReferenceCountedMatrix>> matrixReleasePool;
 
     juce::AudioBuffer<float> buffer;
+    juce::AudioBuffer<float> fadeBuffer;
     bool bufferPrepared {false};
 
-    bool newMatrixAvailable {false};
-
+    double crossfadeTime {0.05};
+    std::atomic<int> fadeLengthInSamples {0};
 };
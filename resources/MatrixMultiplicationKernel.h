@@ -0,0 +1,278 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+
+#pragma once
+
+#include "SIMDHelpers.h"
+
+/**
+ Register-blocked and sample-tiled kernel for dense matrix multiplications of multichannel
+ audio data. The output rows are processed in groups of rowsPerTile rows, and the samples in
+ tiles of samplesPerTile samples, so each input tile is loaded once per group of rows
+ instead of once per output row. The accumulators of one tile stay in registers.
+
+ The SIMD path uses juce::dsp::SIMDRegister, so it maps to SSE, AVX2 or NEON depending on
+ the build target. The inputs are accumulated in the same order as a multiply followed by
+ consecutive addWithMultiply calls would do it.
+ */
+class MatrixMultiplicationKernel
+{
+public:
+   #if JUCE_USE_SIMD
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int simdSize = static_cast<int> (SIMDFloat::size());
+    static constexpr int registersPerTile = 2;
+   #else
+    static constexpr int simdSize = 1;
+    static constexpr int registersPerTile = 8;
+   #endif
+
+    static constexpr int rowsPerTile = 4;
+    static constexpr int rampedRowsPerTile = 2; // a ramp doubles the accumulators
+    static constexpr int samplesPerTile = registersPerTile * simdSize;
+
+    /**
+     Calculates dest[r][n] = sum_i (coefficients[r][i] * input[i][n]) for all nRows rows.
+
+     @param input           array of nInputs pointers to the input channels
+     @param nInputs         number of input channels
+     @param coefficients    array of nRows pointers, each pointing to nInputs coefficients
+     @param dest            array of nRows pointers to the output channels, they must not overlap with the input
+     @param nRows           number of rows to calculate
+     @param nSamples        number of samples
+     */
+    static void process (const float* const* input, const int nInputs,
+                         const float* const* coefficients, float* const* dest, const int nRows,
+                         const int nSamples) noexcept
+    {
+        if (nInputs <= 0)
+        {
+            for (int r = 0; r < nRows; ++r)
+                juce::FloatVectorOperations::clear (dest[r], nSamples);
+            return;
+        }
+
+        const int tailStart = nSamples - nSamples % samplesPerTile;
+
+        for (int n = 0; n < tailStart; n += samplesPerTile)
+        {
+            int r = 0;
+            for (; r + rowsPerTile <= nRows; r += rowsPerTile)
+                processTile<rowsPerTile> (input, nInputs, coefficients + r, dest + r, n);
+
+            for (; r < nRows; ++r)
+                processTile<1> (input, nInputs, coefficients + r, dest + r, n);
+        }
+
+        if (tailStart < nSamples)
+            for (int r = 0; r < nRows; ++r)
+                processTail (input, nInputs, coefficients[r], dest[r], tailStart, nSamples);
+    }
+
+    /**
+     Like process(), but the coefficients of some of the inputs change linearly during the block.
+     Sample n of the ramped input k is weighted in row r with the coefficient of that input plus
+     n / nSamples * coefficientDeltas[r][k], just like juce::FloatVectorOperations would ramp it.
+     The other inputs are weighted with their constant coefficients without any ramping overhead.
+
+     @param coefficients        array of nRows pointers, each pointing to nInputs coefficients at the start of the block
+     @param rampedInputs        array of nRampedInputs pointers to the ramped input channels, a subset of input
+     @param coefficientDeltas   array of nRows pointers, each pointing to nRampedInputs coefficient changes
+     */
+    static void processWithRamp (const float* const* input, const int nInputs, const float* const* coefficients,
+                                 const float* const* rampedInputs, const int nRampedInputs, const float* const* coefficientDeltas,
+                                 float* const* dest, const int nRows, const int nSamples) noexcept
+    {
+        if (nRampedInputs <= 0)
+        {
+            process (input, nInputs, coefficients, dest, nRows, nSamples);
+            return;
+        }
+
+        const float rampIncrement = 1.0f / nSamples;
+        const int tailStart = nSamples - nSamples % samplesPerTile;
+
+        for (int n = 0; n < tailStart; n += samplesPerTile)
+        {
+            int r = 0;
+            for (; r + rampedRowsPerTile <= nRows; r += rampedRowsPerTile)
+                processRampedTile<rampedRowsPerTile> (input, nInputs, coefficients + r, rampedInputs, nRampedInputs,
+                                                      coefficientDeltas + r, dest + r, n, rampIncrement);
+
+            for (; r < nRows; ++r)
+                processRampedTile<1> (input, nInputs, coefficients + r, rampedInputs, nRampedInputs,
+                                      coefficientDeltas + r, dest + r, n, rampIncrement);
+        }
+
+        if (tailStart < nSamples)
+            for (int r = 0; r < nRows; ++r)
+            {
+                processTail (input, nInputs, coefficients[r], dest[r], tailStart, nSamples);
+
+                for (int k = 0; k < nRampedInputs; ++k)
+                    for (int n = tailStart; n < nSamples; ++n)
+                        dest[r][n] += n * rampIncrement * coefficientDeltas[r][k] * rampedInputs[k][n];
+            }
+    }
+
+private:
+    template <int numRows>
+    static inline void processTile (const float* const* input, const int nInputs,
+                                    const float* const* coefficients, float* const* dest,
+                                    const int offset) noexcept
+    {
+       #if JUCE_USE_SIMD
+        SIMDFloat acc[numRows][registersPerTile];
+        for (int r = 0; r < numRows; ++r)
+            for (int k = 0; k < registersPerTile; ++k)
+                acc[r][k] = SIMDFloat::expand (0.0f);
+
+        for (int i = 0; i < nInputs; ++i)
+        {
+            SIMDFloat x[registersPerTile];
+            for (int k = 0; k < registersPerTile; ++k)
+                x[k] = SIMDHelpers::loadUnaligned (input[i] + offset + k * simdSize);
+
+            for (int r = 0; r < numRows; ++r)
+            {
+                const auto c = SIMDFloat::expand (coefficients[r][i]);
+                for (int k = 0; k < registersPerTile; ++k)
+                    acc[r][k] += c * x[k];
+            }
+        }
+
+        for (int r = 0; r < numRows; ++r)
+            for (int k = 0; k < registersPerTile; ++k)
+                SIMDHelpers::storeUnaligned (dest[r] + offset + k * simdSize, acc[r][k]);
+       #else
+        float acc[numRows][samplesPerTile] = {};
+
+        for (int i = 0; i < nInputs; ++i)
+        {
+            const float* x = input[i] + offset;
+            for (int r = 0; r < numRows; ++r)
+            {
+                const float c = coefficients[r][i];
+                for (int k = 0; k < samplesPerTile; ++k)
+                    acc[r][k] += c * x[k];
+            }
+        }
+
+        for (int r = 0; r < numRows; ++r)
+            for (int k = 0; k < samplesPerTile; ++k)
+                dest[r][offset + k] = acc[r][k];
+       #endif
+    }
+
+    template <int numRows>
+    static inline void processRampedTile (const float* const* input, const int nInputs, const float* const* coefficients,
+                                          const float* const* rampedInputs, const int nRampedInputs, const float* const* coefficientDeltas,
+                                          float* const* dest, const int offset, const float rampIncrement) noexcept
+    {
+       #if JUCE_USE_SIMD
+        SIMDFloat acc[numRows][registersPerTile];
+        SIMDFloat delta[numRows][registersPerTile];
+        for (int r = 0; r < numRows; ++r)
+            for (int k = 0; k < registersPerTile; ++k)
+                acc[r][k] = delta[r][k] = SIMDFloat::expand (0.0f);
+
+        for (int i = 0; i < nInputs; ++i)
+        {
+            SIMDFloat x[registersPerTile];
+            for (int k = 0; k < registersPerTile; ++k)
+                x[k] = SIMDHelpers::loadUnaligned (input[i] + offset + k * simdSize);
+
+            for (int r = 0; r < numRows; ++r)
+            {
+                const auto c = SIMDFloat::expand (coefficients[r][i]);
+                for (int k = 0; k < registersPerTile; ++k)
+                    acc[r][k] += c * x[k];
+            }
+        }
+
+        for (int i = 0; i < nRampedInputs; ++i)
+        {
+            SIMDFloat x[registersPerTile];
+            for (int k = 0; k < registersPerTile; ++k)
+                x[k] = SIMDHelpers::loadUnaligned (rampedInputs[i] + offset + k * simdSize);
+
+            for (int r = 0; r < numRows; ++r)
+            {
+                const auto c = SIMDFloat::expand (coefficientDeltas[r][i]);
+                for (int k = 0; k < registersPerTile; ++k)
+                    delta[r][k] += c * x[k];
+            }
+        }
+
+        for (int k = 0; k < registersPerTile; ++k)
+        {
+            const auto ramp = (SIMDHelpers::loadUnaligned (SIMDHelpers::laneIndices) + static_cast<float> (offset + k * simdSize)) * rampIncrement;
+            for (int r = 0; r < numRows; ++r)
+                SIMDHelpers::storeUnaligned (dest[r] + offset + k * simdSize, acc[r][k] + ramp * delta[r][k]);
+        }
+       #else
+        float acc[numRows][samplesPerTile] = {};
+        float delta[numRows][samplesPerTile] = {};
+
+        for (int i = 0; i < nInputs; ++i)
+        {
+            const float* x = input[i] + offset;
+            for (int r = 0; r < numRows; ++r)
+            {
+                const float c = coefficients[r][i];
+                for (int k = 0; k < samplesPerTile; ++k)
+                    acc[r][k] += c * x[k];
+            }
+        }
+
+        for (int i = 0; i < nRampedInputs; ++i)
+        {
+            const float* x = rampedInputs[i] + offset;
+            for (int r = 0; r < numRows; ++r)
+            {
+                const float c = coefficientDeltas[r][i];
+                for (int k = 0; k < samplesPerTile; ++k)
+                    delta[r][k] += c * x[k];
+            }
+        }
+
+        for (int r = 0; r < numRows; ++r)
+            for (int k = 0; k < samplesPerTile; ++k)
+                dest[r][offset + k] = acc[r][k] + (offset + k) * rampIncrement * delta[r][k];
+       #endif
+    }
+
+    static inline void processTail (const float* const* input, const int nInputs,
+                                    const float* coefficients, float* dest,
+                                    const int start, const int end) noexcept
+    {
+        for (int n = start; n < end; ++n)
+        {
+            float sum = 0.0f;
+            for (int i = 0; i < nInputs; ++i)
+                sum += coefficients[i] * input[i][n];
+            dest[n] = sum;
+        }
+    }
+
+};
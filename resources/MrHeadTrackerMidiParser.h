@@ -0,0 +1,103 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+/**
+ Parses the 14-bit MIDI data of the MrHeadTracker and sets the "yaw", "pitch" and "roll" or the
+ "qw", "qx", "qy" and "qz" parameters of the given juce::AudioProcessorValueTreeState.
+ */
+class MrHeadTrackerMidiParser
+{
+public:
+    enum class MidiScheme
+    {
+        none = 0,
+        mrHeadTrackerYprDir,
+        mrHeadTrackerYprInv,
+        mrHeadTrackerQuaternions
+    };
+
+    MrHeadTrackerMidiParser (juce::AudioProcessorValueTreeState& valueTreeState) : parameters (valueTreeState) {}
+
+    void processMidiMessages (const juce::MidiBuffer& midiMessages, const MidiScheme scheme)
+    {
+        if (scheme == MidiScheme::none)
+            return;
+
+        for (const auto& msg : midiMessages)
+        {
+            const auto message = msg.getMessage();
+
+            if (! message.isController())
+                break;
+
+            switch (scheme)
+            {
+                case MidiScheme::mrHeadTrackerYprDir:
+                case MidiScheme::mrHeadTrackerYprInv:
+                    switch (message.getControllerNumber())
+                    {
+                        case 48: yawLsb = message.getControllerValue(); break;
+                        case 49: pitchLsb = message.getControllerValue(); break;
+                        case 50: rollLsb = message.getControllerValue(); break;
+
+                        case 16: setParameter ("yaw", message.getControllerValue(), yawLsb); break;
+                        case 17: setParameter ("pitch", message.getControllerValue(), pitchLsb); break;
+                        case 18: setParameter ("roll", message.getControllerValue(), rollLsb); break;
+                    } // switch (message.getControllerNumber())
+                    break;
+
+                case MidiScheme::mrHeadTrackerQuaternions:
+                    switch (message.getControllerNumber())
+                    {
+                        case 48: qwLsb = message.getControllerValue(); break;
+                        case 49: qxLsb = message.getControllerValue(); break;
+                        case 50: qyLsb = message.getControllerValue(); break;
+                        case 51: qzLsb = message.getControllerValue(); break;
+
+                        case 16: setParameter ("qw", message.getControllerValue(), qwLsb); break;
+                        case 17: setParameter ("qx", message.getControllerValue(), qxLsb); break;
+                        case 18: setParameter ("qy", message.getControllerValue(), qyLsb); break;
+                        case 19: setParameter ("qz", message.getControllerValue(), qzLsb); break;
+                    } // switch (message.getControllerNumber())
+                    break;
+
+                default:
+                    break;
+            } // switch (scheme)
+        }
+    }
+
+private:
+    void setParameter (juce::StringRef parameterID, const int msb, const int lsb)
+    {
+        const float value = (128 * msb + lsb) * (1.0f / 16384);
+        parameters.getParameter (parameterID)->setValueNotifyingHost (value);
+    }
+
+    juce::AudioProcessorValueTreeState& parameters;
+
+    // MrHeadTracker 14-bit MIDI Data
+    int yawLsb = 0, pitchLsb = 0, rollLsb = 0;
+    int qwLsb = 0, qxLsb = 0, qyLsb = 0, qzLsb = 0;
+};
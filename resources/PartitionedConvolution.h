@@ -0,0 +1,359 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+
+#pragma once
+
+/**
+ Uniformly-partitioned overlap-save convolution of several input channels, each with its own
+ impulse response, summed into a few output channels. The summation takes place in the
+ frequency domain, so each partition costs one forward FFT per input and one inverse FFT
+ per output, no matter how many inputs contribute to an output.
+
+ The partition size is independent of the host's block size and the impulse responses can
+ be of arbitrary length, they are split into partitions and the input spectra of previous
+ partitions are kept in a frequency-domain delay line.
+
+ In zero-latency mode, incomplete partitions are transformed as well, so the output is
+ available immediately. This costs one forward FFT per input and one inverse FFT per output
+ for each block (or part of a partition), so the costs per sample rise for blocks shorter than
+ a partition. Otherwise, the input is buffered until a partition is complete, which keeps the
+ costs per sample constant but introduces a latency of one partition.
+
+ In both modes, the contributions of the older partitions to the next one are accumulated
+ bit by bit, as the samples of the current partition come in, so they don't add up to a
+ spike once per partition.
+
+ prepare() and setImpulseResponse() allocate or do heavy work, don't call them from the audio thread.
+ */
+class PartitionedConvolution
+{
+    using Complex = std::complex<float>;
+
+public:
+    PartitionedConvolution() {}
+
+    /**
+     Allocates all buffers and resets the state.
+
+     @param newPartitionSize            partition size, has to be a power of two
+     @param newNumInputs                number of input channels
+     @param newNumOutputs               number of output channels
+     @param maxImpulseResponseLength    longest impulse response which will be set
+     @param useZeroLatency              process incomplete partitions immediately
+     */
+    void prepare (const int newPartitionSize, const int newNumInputs, const int newNumOutputs,
+                  const int maxImpulseResponseLength, const bool useZeroLatency)
+    {
+        jassert (juce::isPowerOfTwo (newPartitionSize));
+
+        partitionSize = newPartitionSize;
+        fftSize = 2 * partitionSize;
+        numBins = partitionSize + 1;
+        numInputs = juce::jmax (0, newNumInputs);
+        numOutputs = juce::jmax (0, newNumOutputs);
+        numPartitions = getNumPartitions (maxImpulseResponseLength, partitionSize);
+        zeroLatency = useZeroLatency;
+
+        fft = std::make_unique<juce::dsp::FFT> (static_cast<int> (std::log2 (fftSize)));
+        fftBuffer.resize (fftSize);
+
+        inputBuffers.setSize (numInputs, fftSize);
+        inputFifo.setSize (zeroLatency ? 0 : numInputs, partitionSize);
+        outputFifo.setSize (zeroLatency ? 0 : numOutputs, partitionSize);
+
+        filters.assign (static_cast<size_t> (numInputs * numPartitions * numBins), Complex());
+        delayLine.assign (static_cast<size_t> (numInputs * numPartitions * numBins), Complex());
+        outputIndices.assign (static_cast<size_t> (numInputs), -1);
+
+        accumulators.assign (static_cast<size_t> (numOutputs * fftSize), Complex());
+        tailAccumulators.assign (static_cast<size_t> (numOutputs * numBins), Complex());
+        nextTailAccumulators.assign (static_cast<size_t> (numOutputs * numBins), Complex());
+        numTailItems = numInputs * juce::jmax (0, numPartitions - 2);
+
+        inputFifoPointers.resize (static_cast<size_t> (numInputs));
+        outputFifoPointers.resize (static_cast<size_t> (numOutputs));
+        for (int i = 0; i < numInputs && ! zeroLatency; ++i)
+            inputFifoPointers[i] = inputFifo.getReadPointer (i);
+        for (int o = 0; o < numOutputs && ! zeroLatency; ++o)
+            outputFifoPointers[o] = outputFifo.getWritePointer (o);
+
+        reset();
+    }
+
+    /** Clears the delay line and all buffers, the filters are kept. */
+    void reset()
+    {
+        inputBuffers.clear();
+        inputFifo.clear();
+        outputFifo.clear();
+        std::fill (delayLine.begin(), delayLine.end(), Complex());
+        std::fill (tailAccumulators.begin(), tailAccumulators.end(), Complex());
+        std::fill (nextTailAccumulators.begin(), nextTailAccumulators.end(), Complex());
+        tailItemsDone = 0;
+
+        inputPosition = 0;
+        fifoPosition = 0;
+        currentSegment = 0;
+    }
+
+    /**
+     Sets the impulse response of an input channel. Its convolution result will be added to the
+     output channel outputIndex. Impulse responses longer than the one given to prepare() are truncated.
+     */
+    void setImpulseResponse (const int inputIndex, const int outputIndex, const float* impulseResponse, const int length)
+    {
+        jassert (juce::isPositiveAndBelow (inputIndex, numInputs));
+        jassert (juce::isPositiveAndBelow (outputIndex, numOutputs));
+        jassert (length <= numPartitions * partitionSize);
+
+        outputIndices[inputIndex] = outputIndex;
+        calculatePartitionSpectra (*fft, fftBuffer, partitionSize, impulseResponse, length, numPartitions, getFilter (inputIndex, 0));
+    }
+
+    /**
+     Sets the impulse response of an input channel with partition spectra which have been calculated
+     beforehand with calculatePartitionSpectra(), e.g. on a background thread. Surplus partitions are
+     ignored, missing ones are treated as zeros.
+     */
+    void setImpulseResponseSpectra (const int inputIndex, const int outputIndex, const std::complex<float>* spectra, const int numSpectraPartitions)
+    {
+        jassert (juce::isPositiveAndBelow (inputIndex, numInputs));
+        jassert (juce::isPositiveAndBelow (outputIndex, numOutputs));
+
+        outputIndices[inputIndex] = outputIndex;
+
+        const int numToCopy = juce::jmin (numSpectraPartitions, numPartitions) * numBins;
+        Complex* dest = getFilter (inputIndex, 0);
+        std::copy (spectra, spectra + numToCopy, dest);
+        std::fill (dest + numToCopy, dest + numPartitions * numBins, Complex());
+    }
+
+    static int getNumPartitions (const int impulseResponseLength, const int partitionSizeToUse)
+    {
+        return juce::jmax (1, (impulseResponseLength + partitionSizeToUse - 1) / partitionSizeToUse);
+    }
+
+    /**
+     Splits an impulse response into partitions and writes their spectra (partitionSize + 1 bins
+     each) to dest, which has to hold numPartitionsToUse * (partitionSize + 1) values. The FFT has
+     to be of size 2 * partitionSize, the scratch buffer will be resized to hold its data.
+     */
+    static void calculatePartitionSpectra (juce::dsp::FFT& fftToUse, std::vector<std::complex<float>>& scratch,
+                                           const int partitionSizeToUse, const float* impulseResponse, const int length,
+                                           const int numPartitionsToUse, std::complex<float>* dest)
+    {
+        jassert (fftToUse.getSize() == 2 * partitionSizeToUse);
+
+        const int size = 2 * partitionSizeToUse;
+        const int bins = partitionSizeToUse + 1;
+        scratch.resize (static_cast<size_t> (size));
+        float* fftData = reinterpret_cast<float*> (scratch.data());
+
+        for (int k = 0; k < numPartitionsToUse; ++k)
+        {
+            juce::FloatVectorOperations::clear (fftData, 2 * size);
+
+            const int numSamples = juce::jlimit (0, partitionSizeToUse, length - k * partitionSizeToUse);
+            if (numSamples > 0)
+                juce::FloatVectorOperations::copy (fftData, impulseResponse + k * partitionSizeToUse, numSamples);
+
+            fftToUse.performRealOnlyForwardTransform (fftData, true);
+            std::copy (scratch.begin(), scratch.begin() + bins, dest + k * bins);
+        }
+    }
+
+    int getLatencyInSamples() const { return zeroLatency ? 0 : partitionSize; }
+
+    int getPartitionSize() const { return partitionSize; }
+
+    /**
+     Convolves the inputs and writes the results to the outputs. The outputs may point to the
+     same memory as the inputs.
+
+     @param inputs      array of as many input pointers as given to prepare()
+     @param outputs     array of as many output pointers as given to prepare()
+     @param numSamples  number of samples
+     */
+    void process (const float* const* inputs, float* const* outputs, const int numSamples) noexcept
+    {
+        int done = 0;
+
+        if (zeroLatency)
+        {
+            while (done < numSamples)
+            {
+                const int n = juce::jmin (numSamples - done, partitionSize - inputPosition);
+                processChunk (inputs, outputs, done, n);
+                done += n;
+            }
+            return;
+        }
+
+        while (done < numSamples)
+        {
+            const int n = juce::jmin (numSamples - done, partitionSize - fifoPosition);
+
+            for (int i = 0; i < numInputs; ++i)
+                juce::FloatVectorOperations::copy (inputFifo.getWritePointer (i, fifoPosition), inputs[i] + done, n);
+
+            for (int o = 0; o < numOutputs; ++o)
+                juce::FloatVectorOperations::copy (outputs[o] + done, outputFifo.getReadPointer (o, fifoPosition), n);
+
+            fifoPosition += n;
+            done += n;
+            accumulateTail (fifoPosition);
+
+            if (fifoPosition == partitionSize)
+            {
+                processChunk (inputFifoPointers.data(), outputFifoPointers.data(), 0, partitionSize);
+                fifoPosition = 0;
+            }
+        }
+    }
+
+private:
+    Complex* getFilter (const int input, const int partition) noexcept
+    {
+        return filters.data() + (input * numPartitions + partition) * numBins;
+    }
+
+    Complex* getSegment (const int input, const int segment) noexcept
+    {
+        return delayLine.data() + (input * numPartitions + segment) * numBins;
+    }
+
+    static inline void multiplyAccumulate (Complex* dest, const Complex* a, const Complex* b, const int num) noexcept
+    {
+        for (int i = 0; i < num; ++i)
+            dest[i] += a[i] * b[i];
+    }
+
+    /** Processes n samples, which must not exceed the current partition. */
+    void processChunk (const float* const* inputs, float* const* outputs, const int offset, const int n) noexcept
+    {
+        float* fftData = reinterpret_cast<float*> (fftBuffer.data());
+
+        // transform the current input window (previous partition + current one) of each input
+        for (int i = 0; i < numInputs; ++i)
+        {
+            float* window = inputBuffers.getWritePointer (i);
+            juce::FloatVectorOperations::copy (window + partitionSize + inputPosition, inputs[i] + offset, n);
+
+            juce::FloatVectorOperations::copy (fftData, window, fftSize);
+            fft->performRealOnlyForwardTransform (fftData, true);
+            std::copy (fftBuffer.begin(), fftBuffer.begin() + numBins, getSegment (i, currentSegment));
+        }
+
+        // the contributions of previous partitions have already been accumulated
+        for (int o = 0; o < numOutputs; ++o)
+            std::copy (tailAccumulators.begin() + o * numBins, tailAccumulators.begin() + (o + 1) * numBins, accumulators.begin() + o * fftSize);
+
+        for (int i = 0; i < numInputs; ++i)
+            if (outputIndices[i] >= 0)
+                multiplyAccumulate (accumulators.data() + outputIndices[i] * fftSize, getSegment (i, currentSegment), getFilter (i, 0), numBins);
+
+        // overlap-save: the second half of the window holds the valid output samples
+        for (int o = 0; o < numOutputs; ++o)
+        {
+            float* result = reinterpret_cast<float*> (accumulators.data() + o * fftSize);
+            fft->performRealOnlyInverseTransform (result);
+            juce::FloatVectorOperations::copy (outputs[o] + offset, result + partitionSize + inputPosition, n);
+        }
+
+        inputPosition += n;
+        accumulateTail (inputPosition);
+
+        if (inputPosition == partitionSize)
+        {
+            inputPosition = 0;
+
+            for (int i = 0; i < numInputs; ++i)
+            {
+                float* window = inputBuffers.getWritePointer (i);
+                juce::FloatVectorOperations::copy (window, window + partitionSize, partitionSize);
+                juce::FloatVectorOperations::clear (window + partitionSize, partitionSize);
+            }
+
+            // only the partition which has just been completed is missing
+            if (numPartitions > 1)
+                for (int i = 0; i < numInputs; ++i)
+                    if (outputIndices[i] >= 0)
+                        multiplyAccumulate (nextTailAccumulators.data() + outputIndices[i] * numBins, getSegment (i, currentSegment), getFilter (i, 1), numBins);
+
+            std::swap (tailAccumulators, nextTailAccumulators);
+            std::fill (nextTailAccumulators.begin(), nextTailAccumulators.end(), Complex());
+            tailItemsDone = 0;
+
+            currentSegment = (currentSegment + 1) % numPartitions;
+        }
+    }
+
+    /**
+     Accumulates the contributions of the partitions before the current one to the next partition,
+     as far as the progress (in samples) within the current partition goes. They are complete and
+     don't change until the next partition starts.
+     */
+    void accumulateTail (const int progress) noexcept
+    {
+        const int target = static_cast<int> (static_cast<juce::int64> (numTailItems) * progress / partitionSize);
+        for (; tailItemsDone < target; ++tailItemsDone)
+        {
+            const int i = tailItemsDone / (numPartitions - 2);
+            if (outputIndices[i] < 0)
+                continue;
+
+            const int k = 2 + tailItemsDone % (numPartitions - 2);
+            const int segment = (currentSegment + 1 - k + numPartitions) % numPartitions;
+            multiplyAccumulate (nextTailAccumulators.data() + outputIndices[i] * numBins, getSegment (i, segment), getFilter (i, k), numBins);
+        }
+    }
+
+    //==============================================================================
+    int partitionSize = 0, fftSize = 0, numBins = 0;
+    int numInputs = 0, numOutputs = 0, numPartitions = 1;
+    bool zeroLatency = true;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<Complex> fftBuffer;
+
+    juce::AudioBuffer<float> inputBuffers; // window of the previous and the current partition
+    juce::AudioBuffer<float> inputFifo, outputFifo;
+    std::vector<const float*> inputFifoPointers;
+    std::vector<float*> outputFifoPointers;
+
+    std::vector<Complex> filters; // [input][partition][bin]
+    std::vector<Complex> delayLine; // [input][segment][bin]
+    std::vector<int> outputIndices;
+
+    std::vector<Complex> accumulators; // [output][fftSize], the inverse FFT needs the full size
+    std::vector<Complex> tailAccumulators; // [output][bin], the older partitions' contributions to the current one
+    std::vector<Complex> nextTailAccumulators; // [output][bin], the same for the next partition, accumulated bit by bit
+    int numTailItems = 0; // input and partition pairs accumulated bit by bit
+    int tailItemsDone = 0;
+
+    int inputPosition = 0;
+    int fifoPosition = 0;
+    int currentSegment = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PartitionedConvolution)
+};
@@ -0,0 +1,71 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+
+#pragma once
+
+/**
+ Holds a reference to each added object, and releases it on the message thread as soon as
+ no one else references it anymore. As long as every object handed over to the audio thread
+ has been added to a pool, the audio thread can drop its references without ever deleting
+ (and deallocating) an object itself.
+
+ Share one pool per object type with juce::SharedResourcePointer<ReleasePool<ObjectType>>.
+ Don't call add() from the audio thread.
+ */
+template <typename ObjectType>
+class ReleasePool : private juce::Timer
+{
+public:
+    ReleasePool()
+    {
+        startTimer (500);
+    }
+
+    ~ReleasePool() override
+    {
+        stopTimer();
+    }
+
+    void add (ObjectType* object)
+    {
+        if (object == nullptr)
+            return;
+
+        const juce::ScopedLock lock (poolLock);
+        pool.addIfNotAlreadyThere (object);
+    }
+
+private:
+    void timerCallback() override
+    {
+        const juce::ScopedLock lock (poolLock);
+        for (int i = pool.size(); --i >= 0;)
+            if (pool.getObjectPointerUnchecked (i)->getReferenceCount() == 1)
+                pool.remove (i);
+    }
+
+    juce::CriticalSection poolLock;
+    juce::ReferenceCountedArray<ObjectType> pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReleasePool)
+};
@@ -0,0 +1,54 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+
+#pragma once
+
+#if JUCE_USE_SIMD
+/**
+ Loads and stores of SIMD registers from and to memory which isn't SIMD aligned, e.g. audio
+ blocks, read positions within delay lines or the frames of a feedback delay network, so
+ juce::dsp::SIMDRegister's fromRawArray / copyToRawArray can't be used. The memcpy compiles
+ to a single unaligned load or store.
+ */
+class SIMDHelpers
+{
+public:
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+
+    static inline SIMDFloat loadUnaligned (const float* src) noexcept
+    {
+        SIMDFloat reg;
+        std::memcpy (&reg.value, src, sizeof (reg.value));
+        return reg;
+    }
+
+    static inline void storeUnaligned (float* dest, const SIMDFloat reg) noexcept
+    {
+        std::memcpy (dest, &reg.value, sizeof (reg.value));
+    }
+
+    /** 0, 1, 2, ... for ramps over the lanes of a register, e.g. loadUnaligned (laneIndices) * increment */
+    static constexpr float laneIndices[16] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+                                               8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f };
+};
+#endif
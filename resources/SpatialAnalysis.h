@@ -0,0 +1,193 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+
+#pragma once
+
+#include "CovarianceKernel.h"
+#include "MatrixMultiplicationKernel.h"
+
+/**
+ Spatial analysis of an Ambisonic signal, based on its SH covariance matrix C smoothed over
+ time. Only the covariance is accumulated per block, everything else is derived from it when
+ it's needed, so the work per sample doesn't depend on how many directions are analysed:
+ - the steered response power d^T C d of any set of beamformers d, e.g. for energy maps
+ - the direction of arrival, from the active intensity vector
+ - the diffuseness, comparing the intensity with the energy density
+
+ The methods don't allocate, but they aren't thread-safe, so call them from the audio thread
+ and hand the results over to other threads.
+ */
+class SpatialAnalysis
+{
+public:
+    static constexpr int maxNumChannels = 64;
+
+    /**
+     A set of beamformers, e.g. one for each direction of a map, with maxNumChannels SH
+     coefficients each. Create it off the audio thread, the coefficients can be changed anytime.
+     */
+    class Beamformers
+    {
+    public:
+        explicit Beamformers (const int numberOfBeamformers)
+            : coefficients (numberOfBeamformers * maxNumChannels), products (numberOfBeamformers * maxNumChannels)
+        {
+            for (int i = 0; i < numberOfBeamformers; ++i)
+            {
+                coefficientRows.push_back (coefficients.data() + i * maxNumChannels);
+                productRows.push_back (products.data() + i * maxNumChannels);
+            }
+        }
+
+        int size() const noexcept { return static_cast<int> (coefficientRows.size()); }
+
+        float* getCoefficients (const int index) noexcept { return coefficients.data() + index * maxNumChannels; }
+        const float* getCoefficients (const int index) const noexcept { return coefficientRows[index]; }
+
+    private:
+        friend class SpatialAnalysis;
+
+        std::vector<float> coefficients;
+        std::vector<float> products; // d^T C
+        std::vector<const float*> coefficientRows;
+        std::vector<float*> productRows;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Beamformers)
+    };
+
+    struct SoundFieldParameters
+    {
+        juce::Vector3D<float> direction; // unit vector towards the source, or zero if there's no energy
+        float diffuseness = 1.0f; // between 0 (a single plane wave) and 1 (a diffuse field, or silence)
+    };
+
+    SpatialAnalysis()
+    {
+        for (int ch = 0; ch < maxNumChannels; ++ch)
+            covarianceRows[ch] = covariance + ch * maxNumChannels;
+
+        reset();
+    }
+
+    void prepare (const double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        reset();
+    }
+
+    /** Sets the time constant of the exponential averaging in seconds. */
+    void setTimeConstant (const float newTimeConstantInSeconds) noexcept
+    {
+        timeConstant = juce::jmax (1e-4f, newTimeConstantInSeconds);
+    }
+
+    void reset() noexcept
+    {
+        std::fill (std::begin (covariance), std::end (covariance), 0.0f);
+        numChannels = 0;
+    }
+
+    /**
+     Adds a block of Ambisonic signals to the averaged covariance matrix. A change of the number
+     of channels resets the average.
+     */
+    void process (const float* const* input, const int nChannels, const int nSamples) noexcept
+    {
+        jassert (nChannels <= maxNumChannels);
+        if (nSamples <= 0)
+            return;
+
+        if (nChannels != numChannels)
+        {
+            reset();
+            numChannels = juce::jmin (nChannels, maxNumChannels);
+        }
+
+        const float decay = std::exp (static_cast<float> (-nSamples / (sampleRate * timeConstant)));
+        CovarianceKernel::process (input, numChannels, nSamples, covariance, maxNumChannels, (1.0f - decay) / nSamples, decay);
+    }
+
+    int getNumChannels() const noexcept { return numChannels; }
+
+    /** Returns the averaged covariance of two channels, which is the mean power for row == column. */
+    float getCovariance (const int row, const int column) const noexcept { return covariance[row * maxNumChannels + column]; }
+
+    /**
+     Calculates the mean power d^T C d of each beamformer d, using its first getNumChannels()
+     coefficients. All d^T C are calculated as one matrix product.
+     */
+    void getSteeredResponsePower (Beamformers& beamformers, float* powers) const noexcept
+    {
+        const int nBeamformers = beamformers.size();
+        MatrixMultiplicationKernel::process (covarianceRows, numChannels, beamformers.coefficientRows.data(),
+                                             beamformers.productRows.data(), nBeamformers, numChannels);
+
+        for (int i = 0; i < nBeamformers; ++i)
+        {
+            const float* d = beamformers.coefficientRows[i];
+            const float* dC = beamformers.productRows[i];
+
+            float power = 0.0f;
+            for (int ch = 0; ch < numChannels; ++ch)
+                power += d[ch] * dC[ch];
+
+            powers[i] = juce::jmax (0.0f, power);
+        }
+    }
+
+    /**
+     Calculates the direction of arrival and the diffuseness from the first order channels
+     (ACN ordering), which have to be available.
+     */
+    SoundFieldParameters getSoundFieldParameters (const bool isSN3D) const noexcept
+    {
+        SoundFieldParameters parameters;
+        if (numChannels < 4)
+            return parameters;
+
+        // with SN3D, a plane wave s from direction u results in W = s and (X, Y, Z) = s u
+        const float scale = isSN3D ? 1.0f : n3dToSn3dFirstOrder;
+        const juce::Vector3D<float> intensity (scale * getCovariance (0, 3), scale * getCovariance (0, 1), scale * getCovariance (0, 2));
+        const float energy = 0.5f * (getCovariance (0, 0) + scale * scale * (getCovariance (1, 1) + getCovariance (2, 2) + getCovariance (3, 3)));
+
+        const float intensityLength = intensity.length();
+        if (energy <= std::numeric_limits<float>::min() || intensityLength <= 0.0f)
+            return parameters;
+
+        parameters.direction = intensity / intensityLength;
+        parameters.diffuseness = juce::jlimit (0.0f, 1.0f, 1.0f - intensityLength / energy);
+        return parameters;
+    }
+
+private:
+    static constexpr float n3dToSn3dFirstOrder = 0.57735026918962576f; // 1 / sqrt (3)
+
+    double sampleRate = 48000.0;
+    float timeConstant = 0.1f;
+
+    int numChannels = 0;
+    float covariance[maxNumChannels * maxNumChannels];
+    const float* covarianceRows[maxNumChannels];
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpatialAnalysis)
+};
@@ -0,0 +1,257 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+/**
+ Finds the triangle of a loudspeaker triangulation (e.g. the convex hull of a layout, enclosing
+ the origin) which contains a given direction, together with its VBAP gains.
+
+ The sphere is divided into the cells of a cube map. Each cell lists the triangles which might
+ intersect it, found conservatively with bounding caps of cells and triangles. A lookup projects
+ the direction onto the cube, and only tests the few triangles of its cell, in O(1) expected
+ time. As the triangles of a cell are sorted by their index, a direction on an edge results in
+ the same triangle as a linear search over all triangles.
+
+ build() allocates, findTriangle() doesn't, so it can be used for panning on the audio thread.
+ */
+class SphericalTriangleIndex
+{
+public:
+    using Triangle = std::array<int, 3>;
+
+    SphericalTriangleIndex() {}
+
+    /**
+     Builds the index. The gains are calculated with the vertices as they are, their lengths only
+     scale the gains. Every direction has to be enclosed by at least one triangle.
+     */
+    void build (const std::vector<juce::Vector3D<float>>& vertices, const std::vector<Triangle>& trianglesToUse)
+    {
+        triangles = trianglesToUse;
+        const int nTriangles = static_cast<int> (triangles.size());
+
+        inverses.resize (nTriangles);
+        std::vector<Cap> triangleCaps (nTriangles);
+        for (int t = 0; t < nTriangles; ++t)
+        {
+            const auto& a = vertices[triangles[t][0]];
+            const auto& b = vertices[triangles[t][1]];
+            const auto& c = vertices[triangles[t][2]];
+            calculateInverse (a, b, c, inverses[t]);
+            triangleCaps[t] = getCap ({ a.normalised(), b.normalised(), c.normalised() });
+        }
+
+        resolution = juce::jlimit (1, maxResolution, 1 + static_cast<int> (2.0 * std::sqrt (nTriangles / 6.0)));
+        const int nCells = 6 * resolution * resolution;
+
+        cellStart.assign (nCells + 1, 0);
+        cellTriangles.clear();
+
+        for (int cell = 0; cell < nCells; ++cell)
+        {
+            cellStart[cell] = static_cast<int> (cellTriangles.size());
+            const Cap cellCap = getCellCap (cell);
+
+            for (int t = 0; t < nTriangles; ++t)
+                if (triangleCaps[t].intersects (cellCap))
+                    cellTriangles.push_back (t);
+        }
+        cellStart[nCells] = static_cast<int> (cellTriangles.size());
+    }
+
+    /**
+     Returns the index of the first triangle containing the direction and writes the gains of its
+     three vertices (not normalised), or returns -1 if there is none.
+     */
+    int findTriangle (const juce::Vector3D<float>& direction, float (&gains)[3]) const noexcept
+    {
+        if (triangles.empty())
+            return -1;
+
+        const int cell = getCell (direction);
+        for (int i = cellStart[cell]; i < cellStart[cell + 1]; ++i)
+            if (contains (cellTriangles[i], direction, gains))
+                return cellTriangles[i];
+
+        // only numerically critical directions end up here
+        for (int t = 0; t < static_cast<int> (triangles.size()); ++t)
+            if (contains (t, direction, gains))
+                return t;
+
+        return -1;
+    }
+
+    const Triangle& getTriangle (const int index) const noexcept { return triangles[index]; }
+    int getNumTriangles() const noexcept { return static_cast<int> (triangles.size()); }
+
+    /** Returns the average number of triangles tested per lookup, for the curious. */
+    float getAverageNumberOfCandidates() const noexcept
+    {
+        return cellStart.empty() ? 0.0f : static_cast<float> (cellTriangles.size()) / (cellStart.size() - 1);
+    }
+
+private:
+    static constexpr int maxResolution = 24;
+    static constexpr float capMargin = 1e-3f; // radians, covering the tolerance of contains()
+
+    // a spherical cap, stored as its centre and the cosine and sine of its opening angle
+    struct Cap
+    {
+        juce::Vector3D<float> centre;
+        float cosAngle, sinAngle;
+        bool coversEverything;
+
+        bool intersects (const Cap& other) const noexcept
+        {
+            if (coversEverything || other.coversEverything)
+                return true;
+
+            // angle between the centres <= sum of both angles
+            const float cosSum = cosAngle * other.cosAngle - sinAngle * other.sinAngle;
+            const bool sumExceedsPi = cosSum < 0.0f && sinAngle * other.cosAngle + cosAngle * other.sinAngle < 0.0f;
+            return sumExceedsPi || centre * other.centre >= cosSum;
+        }
+    };
+
+    // spherical triangles and cube cells lie within the cap around their corners, as long as it's smaller than a hemisphere
+    static Cap getCap (std::initializer_list<juce::Vector3D<float>> corners) noexcept
+    {
+        juce::Vector3D<float> sum;
+        for (const auto& corner : corners)
+            sum += corner;
+
+        Cap cap;
+        cap.coversEverything = sum.length() < 1e-3f;
+        cap.centre = cap.coversEverything ? sum : sum.normalised();
+
+        float minCos = 1.0f;
+        for (const auto& corner : corners)
+            minCos = juce::jmin (minCos, cap.centre * corner);
+
+        const float angle = std::acos (juce::jlimit (-1.0f, 1.0f, minCos)) + capMargin;
+        cap.coversEverything = cap.coversEverything || angle >= 0.5f * juce::MathConstants<float>::pi;
+        cap.cosAngle = std::cos (angle);
+        cap.sinAngle = std::sin (angle);
+        return cap;
+    }
+
+    //==============================================================================
+    // cube faces: +x, -x, +y, -y, +z, -z; u and v are the other two coordinates divided by the major one
+    int getCell (const juce::Vector3D<float>& d) const noexcept
+    {
+        const float ax = std::abs (d.x);
+        const float ay = std::abs (d.y);
+        const float az = std::abs (d.z);
+
+        int face;
+        float major, u, v;
+        if (ax >= ay && ax >= az)
+        {
+            face = d.x >= 0.0f ? 0 : 1;
+            major = ax; u = d.y; v = d.z;
+        }
+        else if (ay >= az)
+        {
+            face = d.y >= 0.0f ? 2 : 3;
+            major = ay; u = d.x; v = d.z;
+        }
+        else
+        {
+            face = d.z >= 0.0f ? 4 : 5;
+            major = az; u = d.x; v = d.y;
+        }
+
+        if (major <= 0.0f)
+            return 0;
+
+        const float scale = 0.5f * resolution / major;
+        const int iu = juce::jlimit (0, resolution - 1, static_cast<int> ((u + major) * scale));
+        const int iv = juce::jlimit (0, resolution - 1, static_cast<int> ((v + major) * scale));
+        return (face * resolution + iu) * resolution + iv;
+    }
+
+    juce::Vector3D<float> getCubePoint (const int face, const float u, const float v) const noexcept
+    {
+        const float sign = face % 2 == 0 ? 1.0f : -1.0f;
+        switch (face / 2)
+        {
+            case 0: return { sign, u, v };
+            case 1: return { u, sign, v };
+            default: return { u, v, sign };
+        }
+    }
+
+    Cap getCellCap (const int cell) const noexcept
+    {
+        const int face = cell / (resolution * resolution);
+        const int iu = (cell / resolution) % resolution;
+        const int iv = cell % resolution;
+
+        const float step = 2.0f / resolution;
+        const float u0 = -1.0f + iu * step;
+        const float v0 = -1.0f + iv * step;
+
+        return getCap ({ getCubePoint (face, u0, v0).normalised(), getCubePoint (face, u0 + step, v0).normalised(),
+                         getCubePoint (face, u0, v0 + step).normalised(), getCubePoint (face, u0 + step, v0 + step).normalised() });
+    }
+
+    //==============================================================================
+    bool contains (const int t, const juce::Vector3D<float>& d, float (&gains)[3]) const noexcept
+    {
+        const auto& inv = inverses[t];
+        gains[0] = inv[0] * d.x + inv[1] * d.y + inv[2] * d.z;
+        gains[1] = inv[3] * d.x + inv[4] * d.y + inv[5] * d.z;
+        gains[2] = inv[6] * d.x + inv[7] * d.y + inv[8] * d.z;
+        return gains[0] >= -FLT_EPSILON && gains[1] >= -FLT_EPSILON && gains[2] >= -FLT_EPSILON;
+    }
+
+    // inverse of the matrix with the vertices as its columns, row-major
+    static void calculateInverse (const juce::Vector3D<float>& a, const juce::Vector3D<float>& b, const juce::Vector3D<float>& c,
+                                  std::array<float, 9>& inverse) noexcept
+    {
+        const float det = a.x * (b.y * c.z - c.y * b.z)
+                        + b.x * (c.y * a.z - a.y * c.z)
+                        + c.x * (a.y * b.z - b.y * a.z);
+
+        const float factor = 1.0f / det;
+
+        inverse[0] = (b.y * c.z - c.y * b.z) * factor;
+        inverse[1] = (-b.x * c.z + c.x * b.z) * factor;
+        inverse[2] = (b.x * c.y - c.x * b.y) * factor;
+
+        inverse[3] = (-a.y * c.z + c.y * a.z) * factor;
+        inverse[4] = (a.x * c.z - c.x * a.z) * factor;
+        inverse[5] = (-a.x * c.y + c.x * a.y) * factor;
+
+        inverse[6] = (a.y * b.z - b.y * a.z) * factor;
+        inverse[7] = (-a.x * b.z + b.x * a.z) * factor;
+        inverse[8] = (a.x * b.y - b.x * a.y) * factor;
+    }
+
+    std::vector<Triangle> triangles;
+    std::vector<std::array<float, 9>> inverses;
+
+    int resolution = 1;
+    std::vector<int> cellStart; // the triangles of cell i are cellTriangles[cellStart[i] .. cellStart[i + 1])
+    std::vector<int> cellTriangles;
+};